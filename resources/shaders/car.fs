@@ -6,9 +6,6 @@ in vec4 fragColor;
 uniform vec2 resolution;
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
-uniform vec4 entityColor;
-uniform float speed;
-uniform float winnerRainbow; // 0.0 = off (normal car), 1.0 = on (winner)
 uniform float time;
 uniform vec2 uvMin;
 uniform vec2 uvMax;
@@ -42,6 +39,15 @@ vec3 rainbowColor(float t)
 
 void main()
 {
+    // Per-kart values arrive in the vertex color so every kart can be drawn
+    // in one batch: rgb is the kart color, alpha packs the winner flag in the
+    // high bit and speed (0..1) in the low 7 bits. See
+    // ShaderUtils::pack_sprite_tint().
+    vec4 entityColor = vec4(fragColor.rgb, 1.0);
+    float packed = floor(fragColor.a * 255.0 + 0.5);
+    float winnerRainbow = step(128.0, packed); // 0.0 = off, 1.0 = winner
+    float speed = (packed - winnerRainbow * 128.0) / 127.0;
+
     vec2 uv = fragTexCoord;
     vec4 texColor = texture(texture0, uv);
 
@@ -6,7 +6,6 @@ in vec4 fragColor;
 uniform float time;
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
-uniform vec4 entityColor;
 uniform vec2 uvMin;
 uniform vec2 uvMax;
 uniform vec2 contentUvMin;
@@ -93,9 +92,10 @@ void main()
         }
     }
 
-    // Fallback tint: if entityColor is not set (often 0), use white
-    float tintMag = entityColor.r + entityColor.g + entityColor.b;
-    vec3 tint = (tintMag > 0.001) ? entityColor.rgb : vec3(1.0);
+    // Kart color comes in as the vertex color (see car.fs); fall back to
+    // white if it is black
+    float tintMag = fragColor.r + fragColor.g + fragColor.b;
+    vec3 tint = (tintMag > 0.001) ? fragColor.rgb : vec3(1.0);
 
     // Base is the sprite tinted by tint
     vec3 base_color = tex.rgb * tint;
@@ -0,0 +1,120 @@
+#version 330
+// PostFx inserts one #define per active effect right after the version line:
+//   SPOTLIGHT  dim and desaturate the world outside the tagger spotlight
+//   BASE_FX    barrel, chromatic aberration, bloom, grain, vignette, pulse
+// With neither this is a plain composite of the UI over the world.
+
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform float time;
+uniform vec2 resolution;
+uniform sampler2D texture0;  // world (mainRT)
+uniform sampler2D uiTexture; // UI (screenRT), premultiplied alpha
+uniform vec4 colDiffuse;
+
+#ifdef SPOTLIGHT
+uniform vec2 spotlightPos;      // UV position [0,1]
+uniform float spotlightRadius;  // inner radius in UV units
+uniform float spotlightSoftness;// edge feather in UV units
+uniform float dimAmount;        // how much to dim outside [0,1]
+uniform float desaturateAmount; // how much to desaturate outside [0,1]
+#endif
+
+#ifdef BASE_FX
+const float bloomThreshold = 0.5;
+const float bloomIntensity = 1.2;
+const float bloomRadius = 4.0;
+const vec3 bloomTint = vec3(1.0);
+#endif
+
+out vec4 finalColor;
+
+bool inBounds(vec2 p) {
+    return all(greaterThanEqual(p, vec2(0.0))) && all(lessThanEqual(p, vec2(1.0)));
+}
+
+vec3 world(vec2 p) {
+    if (!inBounds(p)) return vec3(0.0);
+    return texture(texture0, p).rgb;
+}
+
+// The world with the spotlight applied and the UI on top
+vec3 scene(vec2 p) {
+    if (!inBounds(p)) return vec3(0.0);
+    vec3 col = texture(texture0, p).rgb;
+#ifdef SPOTLIGHT
+    // Account for aspect ratio so the circle appears round on screen
+    vec2 aspect = vec2(max(resolution.x / max(resolution.y, 1.0), 1.0), 1.0);
+    float d = length((p - spotlightPos) * aspect);
+    float edge0 = spotlightRadius;
+    float edge1 = spotlightRadius + max(spotlightSoftness, 1e-5);
+    float outsideMask = smoothstep(edge0, edge1, d);
+
+    float gray = dot(col, vec3(0.299, 0.587, 0.114));
+    vec3 desat = mix(col, vec3(gray), clamp(desaturateAmount, 0.0, 1.0));
+    vec3 dimmed = desat * (1.0 - clamp(dimAmount, 0.0, 1.0));
+    col = mix(col, dimmed, outsideMask);
+#endif
+    vec4 ui = texture(uiTexture, p);
+    return ui.rgb + col * (1.0 - ui.a);
+}
+
+#ifdef BASE_FX
+// Only the world glows; the UI stays crisp
+vec3 sampleBloom(vec2 uv, vec2 px, float radius) {
+    vec3 bloom = vec3(0.0);
+    float weight = 0.0;
+    float sigma = radius * 0.5;
+
+    for(float y = -radius; y <= radius; y += 1.0) {
+        for(float x = -radius; x <= radius; x += 1.0) {
+            vec2 offset = vec2(x, y) * px;
+            float dist = length(offset);
+            float gauss = exp(-(dist * dist) / (2.0 * sigma * sigma));
+            bloom += world(uv + offset) * gauss;
+            weight += gauss;
+        }
+    }
+
+    return bloom / max(weight, 0.00001);
+}
+#endif
+
+void main()
+{
+    vec2 uv = fragTexCoord;
+
+#ifdef BASE_FX
+    vec2 centered = uv - 0.5;
+    float r2 = dot(centered, centered);
+
+    float k = 0.08;
+    vec2 uvBarrel = 0.5 + centered * (1.0 + k * r2);
+
+    float aberrBase = 0.0018;
+    float dist = length(centered);
+    float edgeAtten = 1.0 - smoothstep(0.6, 0.95, dist);
+    vec2 ca = centered * (aberrBase + 0.004 * r2) * edgeAtten;
+
+    vec3 col = vec3(scene(uvBarrel + ca).r, scene(uvBarrel).g,
+                    scene(uvBarrel - ca).b);
+
+    vec2 px = 1.0 / max(resolution, vec2(1.0));
+    vec3 bloom = sampleBloom(uvBarrel, px, bloomRadius);
+    bloom = max(bloom - vec3(bloomThreshold), vec3(0.0)) * bloomTint;
+    col += bloom * bloomIntensity;
+
+    float grain = fract(sin(dot(uv * resolution + time * 57.0, vec2(12.9898, 78.233))) * 43758.5453);
+    col += (grain - 0.5) * 0.02;
+
+    float vig = smoothstep(0.55, 0.9, dist);
+    col *= mix(1.0, 0.85, vig);
+
+    float pulse = 0.95 + 0.06 * sin(time * 1.7);
+
+    finalColor = vec4(col * pulse, 1.0) * colDiffuse;
+#else
+    finalColor = vec4(scene(uv), 1.0) * colDiffuse;
+#endif
+}
@@ -0,0 +1,381 @@
+#pragma once
+
+#include "ai_snapshot.h"
+#include "kart_distance_matrix.h"
+#include "math_util.h"
+#include "nav_grid.h"
+#include <cmath>
+#include <limits>
+#include <optional>
+
+// The AI's decisions as plain functions of an AISnapshot. They run on the
+// JobPool threads, so they only read the snapshot, the KartDistanceMatrix
+// and the NavGrid (find_field, never field_to), and only write the one
+// AICommand they are given. No raylib, no entities, no rand().
+namespace ai {
+
+struct Inputs {
+  const AISnapshot &snapshot;
+  const KartDistanceMatrix &matrix;
+  const NavGrid &nav;
+};
+
+namespace detail {
+
+inline vec2 pos_of(const Inputs &in, const AIAgent &agent) {
+  return in.snapshot.karts[agent.kart].pos;
+}
+
+inline vec2 forward(float angle_deg) {
+  const float rad = static_cast<float>(angle_deg * (M_PI / 180.0f));
+  return vec2{std::sin(rad), -std::cos(rad)};
+}
+
+// Closest other kart (by matrix row) that passes `keep`
+template <typename Pred>
+std::optional<size_t> closest_kart(const Inputs &in, const AIAgent &agent,
+                                   Pred &&keep) {
+  std::optional<size_t> best;
+  float best_dist = std::numeric_limits<float>::max();
+  for (size_t j = 0; j < in.snapshot.karts.size(); j++) {
+    if (j == agent.kart || !keep(in.snapshot.karts[j]))
+      continue;
+    const float d = in.matrix.distance_sq(agent.kart, j);
+    if (d < best_dist) {
+      best_dist = d;
+      best = j;
+    }
+  }
+  return best;
+}
+
+inline void set_target(AICommand &out, vec2 target) {
+  out.retarget = AICommand::Retarget::Set;
+  out.target = target;
+}
+
+inline void pre_round_target(const Inputs &in, const AIAgent &agent,
+                             AICommand &out) {
+  const bool has_no_target = (agent.target.x == 0.0f && agent.target.y == 0.0f);
+  const float distance_to_target = distance_sq(pos_of(in, agent), agent.target);
+  if (has_no_target ||
+      distance_to_target < agent.retarget_radius * agent.retarget_radius) {
+    out.retarget = AICommand::Retarget::Random;
+  }
+}
+
+inline void default_target(const Inputs &in, const AIAgent &agent,
+                           AICommand &out) {
+  // Check if we're close enough to current target to pick a new one
+  const float distance_to_target = distance_sq(pos_of(in, agent), agent.target);
+  if (distance_to_target > agent.retarget_radius * agent.retarget_radius) {
+    return;
+  }
+  for (size_t j = 0; j < in.snapshot.karts.size(); j++) {
+    if (j != agent.kart && in.snapshot.karts[j].human) {
+      set_target(out, in.snapshot.karts[j].pos);
+      return;
+    }
+  }
+  out.retarget = AICommand::Retarget::Random;
+}
+
+inline void kills_target(const Inputs &in, const AIAgent &agent,
+                         AICommand &out) {
+  const std::optional<size_t> closest = closest_kart(
+      in, agent, [](const AIKart &kart) { return kart.human; });
+  if (!closest) {
+    default_target(in, agent, out);
+    return;
+  }
+  set_target(out, in.snapshot.karts[*closest].pos);
+}
+
+inline void lives_target(const Inputs &in, const AIAgent &agent,
+                         AICommand &out) {
+  const KartDistanceMatrix &m = in.matrix;
+  if (m.count < 2) {
+    default_target(in, agent, out);
+    return;
+  }
+
+  vec2 target_pos = vec2{0, 0};
+  float best_score = -std::numeric_limits<float>::max();
+  for (size_t j = 0; j < m.count; j++) {
+    if (j == agent.kart)
+      continue;
+    const float distance_to_player = m.distance_sq(agent.kart, j);
+    // The matrix sums avoidance over everyone but j; take us back out
+    const float avoidance_score =
+        m.avoidance[j] -
+        std::min(distance_to_player / KartDistanceMatrix::AVOIDANCE_RANGE_SQ,
+                 1.0f);
+    const float distance_score =
+        1.0f / (1.0f + distance_to_player / 10000.0f);
+    const float combined_score =
+        distance_score * 0.6f + avoidance_score * 0.4f;
+    if (combined_score > best_score) {
+      best_score = combined_score;
+      target_pos = m.position(j);
+    }
+  }
+  set_target(out, target_pos);
+}
+
+inline void hippo_target(const Inputs &in, const AIAgent &agent,
+                         AICommand &out) {
+  const vec2 pos = pos_of(in, agent);
+  std::optional<vec2> closest;
+  float best_dist = std::numeric_limits<float>::max();
+  for (const vec2 &hippo : in.snapshot.hippos) {
+    const float d = distance_sq(pos, hippo);
+    if (d < best_dist) {
+      best_dist = d;
+      closest = hippo;
+    }
+  }
+  if (!closest) {
+    default_target(in, agent, out);
+    return;
+  }
+  const vec2 closest_hippo_pos = *closest;
+
+  const float distance_to_hippo = std::sqrt(best_dist);
+  const float distance_factor = std::min(
+      1.0f, distance_to_hippo / agent.hippo_jitter_distance_scale);
+  const float actual_offset_range = agent.hippo_target_jitter * distance_factor;
+
+  vec2 target_pos = closest_hippo_pos;
+  if (actual_offset_range > 0.0f) {
+    // Seeded from the entity and the hippo so it's stable between decisions
+    unsigned int seed =
+        static_cast<unsigned int>(agent.id) +
+        static_cast<unsigned int>(closest_hippo_pos.x * 1000) +
+        static_cast<unsigned int>(closest_hippo_pos.y * 1000);
+
+    seed = seed * 1103515245 + 12345;
+    const float rand_x =
+        (static_cast<float>(seed & 0x7FFF) / 32767.0f - 0.5f) *
+        actual_offset_range;
+
+    seed = seed * 1103515245 + 12345;
+    const float rand_y =
+        (static_cast<float>(seed & 0x7FFF) / 32767.0f - 0.5f) *
+        actual_offset_range;
+
+    target_pos += vec2{rand_x, rand_y};
+  }
+  set_target(out, target_pos);
+}
+
+inline void tagger_target(const Inputs &in, const AIAgent &agent,
+                          AICommand &out) {
+  const std::optional<size_t> closest_runner =
+      closest_kart(in, agent, [](const AIKart &kart) {
+        return kart.tag_tracked && !kart.is_tagger;
+      });
+  if (!closest_runner) {
+    out.missing = AICommand::Missing::Runner;
+    return;
+  }
+  set_target(out, in.snapshot.karts[*closest_runner].pos);
+}
+
+inline void runner_target(const Inputs &in, const AIAgent &agent,
+                          AICommand &out) {
+  const std::optional<size_t> closest_tagger =
+      closest_kart(in, agent, [](const AIKart &kart) {
+        return kart.tag_tracked && kart.is_tagger;
+      });
+  if (!closest_tagger) {
+    out.missing = AICommand::Missing::Tagger;
+    return;
+  }
+  const vec2 pos = pos_of(in, agent);
+  const vec2 closest_tagger_pos = in.snapshot.karts[*closest_tagger].pos;
+
+  vec2 away_from_tagger = pos - closest_tagger_pos;
+  if (vec_mag(away_from_tagger) < 0.1f) {
+    away_from_tagger = vec2(1.0f, 0.0f);
+  }
+  away_from_tagger = vec_norm(away_from_tagger);
+
+  // Straight away from the tagger can be straight into a wall; go by path
+  // distance from the tagger instead when the map has walls to go around
+  if (!in.nav.empty()) {
+    out.threat = closest_tagger_pos;
+  }
+  if (const NavGrid::FlowField *threat =
+          in.nav.find_field(closest_tagger_pos)) {
+    if (auto flee = in.nav.flee_direction(*threat, pos)) {
+      away_from_tagger = *flee;
+    }
+  }
+
+  vec2 move_direction = away_from_tagger;
+  if (vec_mag(agent.velocity) > 1.0f) {
+    move_direction = vec_norm(agent.velocity);
+  }
+  set_target(out,
+             pos + move_direction * agent.runner_evade_lookahead_distance);
+}
+
+inline void tag_and_go_target(const Inputs &in, const AIAgent &agent,
+                              AICommand &out) {
+  const AIKart &self = in.snapshot.karts[agent.kart];
+  if (!self.tag_tracked) {
+    default_target(in, agent, out);
+    return;
+  }
+  if (self.is_tagger) {
+    tagger_target(in, agent, out);
+  } else {
+    runner_target(in, agent, out);
+  }
+}
+
+} // namespace detail
+
+// Picks what the AI is going for, by its mode (AIMode or the round's)
+inline void decide_target(const Inputs &in, const AIAgent &agent,
+                          AICommand &out) {
+  out.decided = true;
+  if (!in.snapshot.in_game) {
+    detail::pre_round_target(in, agent, out);
+    return;
+  }
+  switch (agent.mode) {
+  case RoundType::Lives:
+    detail::lives_target(in, agent, out);
+    break;
+  case RoundType::Kills:
+    detail::kills_target(in, agent, out);
+    break;
+  case RoundType::Hippo:
+    detail::hippo_target(in, agent, out);
+    break;
+  case RoundType::TagAndGo:
+    detail::tag_and_go_target(in, agent, out);
+    break;
+  }
+}
+
+// Steering toward `target` for one tick. Runs for every agent every frame,
+// deciding or not, once the targets are settled.
+inline void steer(const Inputs &in, const AIAgent &agent, vec2 target,
+                  AICommand &out) {
+  const AISnapshot &s = in.snapshot;
+  const vec2 pos = detail::pos_of(in, agent);
+  out.angle = agent.angle;
+  out.velocity = agent.velocity;
+  out.accel_mult = s.in_game ? agent.accel_mult : 1.0f;
+
+  if (target.x == 0 && target.y == 0) {
+    return;
+  }
+
+  // Head along the flow field toward the target rather than straight at it,
+  // when there is one (EvaluateAI builds them before steering)
+  vec2 steer_to = target;
+  if (const NavGrid::FlowField *field = in.nav.find_field(target)) {
+    steer_to = in.nav.steer_point(*field, pos, target);
+  }
+
+  const vec2 dir = vec_norm(pos - steer_to);
+  const float target_ang = to_degrees(std::atan2(dir.y, dir.x)) - 90;
+
+  float steer_dir = 0.f;
+  const float accel = 5.f;
+
+  // Normalize angle difference to [-180, 180]
+  float angle_diff = target_ang - out.angle;
+  while (angle_diff > 180.0f)
+    angle_diff -= 360.0f;
+  while (angle_diff < -180.0f)
+    angle_diff += 360.0f;
+
+  if (angle_diff < -1.0f) {
+    steer_dir = -1.f;
+  } else if (angle_diff > 1.0f) {
+    steer_dir = 1.f;
+  }
+
+  const float speed = vec_mag(out.velocity);
+  if (speed > 0.01) {
+    const float speed_percentage = speed / s.max_speed;
+    const float rad = std::lerp(s.min_steering_radius, s.max_steering_radius,
+                                speed_percentage);
+    out.angle += steer_dir * s.steering_sensitivity * s.dt * rad *
+                 agent.steering_multiplier;
+    out.angle = std::fmod(out.angle + 360.f, 360.f);
+  }
+
+  const vec2 forward_dir = detail::forward(out.angle);
+  const vec2 to_target_dir = vec_norm(steer_to - pos);
+  const float ahead_dot =
+      (forward_dir.x * to_target_dir.x) + (forward_dir.y * to_target_dir.y);
+  const float ahead_threshold =
+      std::cos(agent.boost_ahead_alignment_deg * (M_PI / 180.0f));
+  if (ahead_dot > ahead_threshold &&
+      distance_sq(pos, target) > agent.boost_min_distance_sq &&
+      !agent.reversing && out.accel_mult <= 1.f) {
+    out.touch_boost_cooldown = true;
+    out.boost_cooldown = agent.boost_cooldown_seconds > 0.0f
+                             ? agent.boost_cooldown_seconds
+                             : agent.boost_cooldown;
+    out.boost_next_allowed = agent.boost_next_allowed;
+    if (s.now >= agent.boost_next_allowed) {
+      out.boost = true;
+      out.boost_next_allowed = s.now + out.boost_cooldown;
+    }
+  }
+
+  const float max_movement_limit =
+      (out.accel_mult > 1.f) ? (s.max_speed * 2.f) : s.max_speed;
+  float mvt = std::max(
+      -max_movement_limit,
+      std::min(max_movement_limit,
+               speed + (accel * out.accel_mult *
+                        agent.acceleration_multiplier)));
+  mvt *= agent.difficulty_speed;
+  if (s.round_type == RoundType::TagAndGo) {
+    mvt *= s.tag_speed_multiplier;
+  }
+
+  const float rad = static_cast<float>(out.angle * (M_PI / 180.0f));
+  out.velocity += vec2{
+      std::sin(rad) * mvt * s.dt,
+      -std::cos(rad) * mvt * s.dt,
+  };
+  out.velocity = out.velocity * agent.speed_multiplier;
+}
+
+// Fire when some kart is within shooting_alignment_angle_deg of where the
+// kart points after this tick's steering (steer() has to run first)
+inline void decide_fire(const Inputs &in, const AIAgent &agent,
+                        AICommand &out) {
+  const AISnapshot &s = in.snapshot;
+  if (!out.decided || !agent.can_shoot || !s.in_game)
+    return;
+  if (s.round_type != RoundType::Kills && s.round_type != RoundType::Lives)
+    return;
+
+  // In Lives mode, target all players (human and AI), in Kills mode only
+  // target human players
+  // TODO better filter for targetable
+  const vec2 forward_dir = detail::forward(out.angle);
+  float best_alignment = -2.0f;
+  for (size_t j = 0; j < in.matrix.count; j++) {
+    if (j == agent.kart ||
+        in.matrix.distance_sq(agent.kart, j) < KartDistanceMatrix::SAME_SPOT_SQ)
+      continue;
+    const vec2 dir_to_p = in.matrix.direction(agent.kart, j);
+    const float dot = forward_dir.x * dir_to_p.x + forward_dir.y * dir_to_p.y;
+    best_alignment = std::max(best_alignment, dot);
+  }
+  const float fire_threshold =
+      std::cos(agent.shooting_alignment_angle_deg * (M_PI / 180.0f));
+  out.fire = best_alignment >= fire_threshold;
+}
+
+} // namespace ai
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "components.h"
+#include <afterhours/src/singleton.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Decides which AI karts get to think this frame.
+//
+// Target selection, shot evaluation and building new flow fields are the
+// expensive part of the AI, and none of it needs to happen every frame: a
+// kart keeps driving at its last target in between. Each AI decides at its
+// AIParams::decision_hz (set per difficulty), starting at a different
+// offset so the decisions spread out over the period instead of all landing
+// on the same frame. Steering still runs for every AI every tick.
+//
+// On top of that, the decisions in one fixed step are capped. The cap is a
+// count, not a time budget, so which AIs think on a tick depends only on the
+// simulation and a replay or headless match comes out the same on any
+// machine. It follows the demand: every AI's decision_hz added up and spread
+// over the tick rate, plus HEADROOM, so every difficulty keeps its own rate
+// whatever the kart count or --tick-rate, and the cap only flattens the
+// ticks where several AIs' phases line up. schedule() admits the most
+// overdue first and the rest stay due for the next tick. Wall time per
+// decision is still measured, for the profiler only.
+SINGLETON_FWD(AIScheduler)
+struct AIScheduler {
+  SINGLETON(AIScheduler)
+
+  using Clock = std::chrono::steady_clock;
+
+  // over the average decisions per tick, so a clump clears in a tick or two
+  static constexpr float HEADROOM = 1.5f;
+  // how many distinct start offsets to spread AIs over
+  static constexpr int PHASES = 8;
+  static constexpr float COST_SMOOTHING = 0.1f;
+
+  // wall time per decision, the whole EvaluateAI decision pass included;
+  // shown by the profiler, never used to pick who decides
+  float avg_decision_ms = 0.05f;
+  float spent_ms = 0.f;
+  size_t decided = 0;
+
+  // last tick, for the profiler overlay
+  size_t cap = 0;
+  size_t due = 0;
+  size_t admitted = 0;
+  size_t deferred = 0;
+
+  struct Due {
+    float next_decision;
+    AIDecisionClock *clock;
+  };
+  std::vector<Due> queue;
+
+  // Decisions a tick may admit when the AIs' decision_hz add up to
+  // `demand_hz` and a tick is `fixed_dt` long; at least one
+  [[nodiscard]] static size_t cap_for(float demand_hz, float fixed_dt) {
+    return std::max<size_t>(
+        1, static_cast<size_t>(std::ceil(demand_hz * fixed_dt * HEADROOM)));
+  }
+
+  // Called once a tick with every AI before the AI systems run
+  void schedule(float now, const std::vector<Due> &candidates,
+                size_t max_admitted) {
+    if (decided > 0) {
+      const float per_decision = spent_ms / static_cast<float>(decided);
+      avg_decision_ms += (per_decision - avg_decision_ms) * COST_SMOOTHING;
+    }
+    spent_ms = 0.f;
+    decided = 0;
+
+    queue.clear();
+    for (const Due &d : candidates) {
+      d.clock->decide = false;
+      if (d.next_decision <= now)
+        queue.push_back(d);
+    }
+    // stable so ties keep query order and come out the same every run
+    std::ranges::stable_sort(queue, {}, &Due::next_decision);
+
+    cap = max_admitted;
+    due = queue.size();
+    admitted = std::min(cap, queue.size());
+    deferred = due - admitted;
+    for (size_t i = 0; i < admitted; i++) {
+      queue[i].clock->decide = true;
+    }
+  }
+
+  // First decision for a new AI, offset by its id so a batch of AIs spawned
+  // together doesn't decide in lockstep
+  static float first_decision(afterhours::EntityID id, float now,
+                              float period) {
+    const int phase = static_cast<int>(id % PHASES);
+    return now + (period * static_cast<float>(phase) /
+                  static_cast<float>(PHASES));
+  }
+
+  // Milliseconds since `start`
+  static float elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(Clock::now() - start)
+        .count();
+  }
+
+  // Records an AI whose decision went through (ApplyAICommands) and pushes
+  // its next one out by a period
+  void decided_one(AIDecisionClock &clock, float now, float period) {
+    decided++;
+    // deferred ones don't try to catch up on what they missed
+    clock.next_decision = std::max(clock.next_decision + period, now);
+  }
+
+  // Adds the lifetime of this to the frame's decision time
+  struct Timed {
+    Clock::time_point start = Clock::now();
+    Timed() = default;
+    Timed(const Timed &) = delete;
+    Timed &operator=(const Timed &) = delete;
+    ~Timed() { AIScheduler::get().spent_ms += elapsed_ms(start); }
+  };
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "rl.h"
+#include "round_settings.h"
+#include <afterhours/ah.h>
+#include <afterhours/src/singleton.h>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// What the AI decisions get to read: plain copies of the kart, hippo and
+// round state, taken on the main thread at the start of the AI pass
+// (CaptureAISnapshot). The decisions in ai_decisions.h only see this, the
+// KartDistanceMatrix and the NavGrid, none of which change until the pass
+// is over, so they can run on any thread. Each writes one AICommand, and
+// ApplyAICommands puts those back into the ECS on the main thread, in
+// agent order, so the result doesn't depend on which thread ran what.
+
+struct AIKart {
+  afterhours::EntityID id = -1;
+  vec2 pos{};
+  bool human = false;       // has PlayerID
+  bool tag_tracked = false; // has HasTagAndGoTracking
+  bool is_tagger = false;
+};
+
+// One AI kart
+struct AIAgent {
+  afterhours::EntityID id = -1;
+  // index into AISnapshot::karts, and the row in KartDistanceMatrix
+  size_t kart = 0;
+  RoundType mode{};
+  bool decide = false; // AIDecisionClock::decide
+  float next_decision = 0.f;
+  bool can_shoot = false;
+  vec2 target{};
+
+  // from AIParams
+  float retarget_radius = 0.f;
+  float runner_evade_lookahead_distance = 0.f;
+  float hippo_target_jitter = 0.f;
+  float hippo_jitter_distance_scale = 1.f;
+  float shooting_alignment_angle_deg = 0.f;
+  float boost_min_distance_sq = 0.f;
+  float boost_ahead_alignment_deg = 0.f;
+  float boost_cooldown_seconds = 0.f;
+
+  // from Transform
+  vec2 velocity{};
+  float angle = 0.f;
+  float accel_mult = 1.f;
+  bool reversing = false;
+
+  // from CarAffectorCache
+  float steering_multiplier = 1.f;
+  float acceleration_multiplier = 1.f;
+  float speed_multiplier = 1.f;
+
+  // from AIDifficulty
+  float difficulty_speed = 1.f;
+
+  // from AIBoostCooldown, defaults if it has none yet
+  float boost_next_allowed = 0.f;
+  float boost_cooldown = 3.f;
+};
+
+struct AISnapshot {
+  RoundType round_type{};
+  bool in_game = false;
+  float tag_speed_multiplier = 1.f;
+  raylib::Rectangle arena{};
+  float now = 0.f;
+  float dt = 0.f;
+
+  // from Config
+  float min_steering_radius = 0.f;
+  float max_steering_radius = 0.f;
+  float steering_sensitivity = 0.f;
+  float max_speed = 1.f;
+
+  std::vector<AIKart> karts;
+  // hippos not collected yet
+  std::vector<vec2> hippos;
+  std::vector<AIAgent> agents;
+};
+
+// What one agent decided this frame
+struct AICommand {
+  enum struct Retarget : uint8_t {
+    Keep,
+    Set,
+    // the main thread picks a random spot; rand() isn't for worker threads
+    Random,
+  };
+  enum struct Missing : uint8_t { None, Runner, Tagger };
+
+  bool decided = false;
+  Retarget retarget = Retarget::Keep;
+  vec2 target{};
+  bool fire = false;
+  Missing missing = Missing::None;
+  // the tagger a runner is fleeing; the main thread builds the flow field
+  // toward it (or keeps it from going stale) for the next decision
+  std::optional<vec2> threat;
+
+  // steering, always filled in
+  float angle = 0.f;
+  vec2 velocity{};
+  float accel_mult = 1.f;
+  bool touch_boost_cooldown = false;
+  float boost_next_allowed = 0.f;
+  float boost_cooldown = 0.f;
+  bool boost = false;
+};
+
+// The AI pass in flight: the snapshot, one command per agent, and the
+// entities to write them back to (main thread only)
+SINGLETON_FWD(AIFrame)
+struct AIFrame {
+  SINGLETON(AIFrame)
+
+  AISnapshot snapshot;
+  std::vector<AICommand> commands;
+  std::vector<afterhours::RefEntity> entities;
+};
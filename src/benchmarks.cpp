@@ -0,0 +1,864 @@
+#include "benchmarks.h"
+
+#include "ai_decisions.h"
+#include "components.h"
+#include "job_pool.h"
+#include "kart_distance_matrix.h"
+#include "library/shader_library.h"
+#include "map_system.h"
+#include "nav_grid.h"
+#include "post_fx.h"
+#include "projectile_pool.h"
+#include "round_settings.h"
+#include "query.h"
+#include "shader_types.h"
+#include "sim_clock.h"
+#include "spatial_index.h"
+#include "systems/systems.h"
+#include "systems/systems_ai.h"
+#include <chrono>
+#include <magic_enum/magic_enum.hpp>
+#include <utility>
+
+using namespace afterhours;
+
+#ifndef _WIN32
+// raylib loads GL through glad, whose function pointers are plain globals in
+// a static raylib; rlgl issues every draw through these two. Not exported
+// from raylib.dll, so Windows builds don't count draw calls.
+#define BENCHMARKS_COUNT_DRAW_CALLS
+extern "C" {
+using GladDrawArrays = void (*)(unsigned int mode, int first, int count);
+using GladDrawElements = void (*)(unsigned int mode, int count,
+                                  unsigned int type, const void *indices);
+extern GladDrawArrays glad_glDrawArrays;
+extern GladDrawElements glad_glDrawElements;
+}
+#endif
+
+namespace benchmarks {
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+float elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<float, std::milli>(Clock::now() - start)
+      .count();
+}
+
+void reset_world() {
+  for (const auto &entity : EntityHelper::get_entities()) {
+    entity->cleanup = true;
+  }
+  cleanup_entities();
+}
+
+// Counts the GL draw calls rlgl makes while one of these is alive; -1 where
+// they can't be counted
+struct CountDrawCalls {
+  inline static int calls = 0;
+
+#ifdef BENCHMARKS_COUNT_DRAW_CALLS
+  inline static GladDrawArrays real_arrays = nullptr;
+  inline static GladDrawElements real_elements = nullptr;
+
+  static void arrays(unsigned int mode, int first, int count) {
+    calls++;
+    real_arrays(mode, first, count);
+  }
+  static void elements(unsigned int mode, int count, unsigned int type,
+                       const void *indices) {
+    calls++;
+    real_elements(mode, count, type, indices);
+  }
+
+  CountDrawCalls() {
+    calls = 0;
+    real_arrays = std::exchange(glad_glDrawArrays, &arrays);
+    real_elements = std::exchange(glad_glDrawElements, &elements);
+  }
+  ~CountDrawCalls() {
+    glad_glDrawArrays = real_arrays;
+    glad_glDrawElements = real_elements;
+  }
+#else
+  CountDrawCalls() { calls = -1; }
+#endif
+  CountDrawCalls(const CountDrawCalls &) = delete;
+  CountDrawCalls &operator=(const CountDrawCalls &) = delete;
+};
+
+} // namespace
+
+// The bullet overlap work ProcessProjectileDamage and
+// ProcessProjectileAbsorption do each tick: every pooled bullet against the
+// karts it can hurt and the obstacles that absorb it, once by scanning the
+// entities and once through the spatial index.
+int spatial_index(int width, int height) {
+  constexpr int NUM_KARTS = 8;
+  constexpr int NUM_OBSTACLES = 40;
+  constexpr int NUM_TICKS = 120;
+  const std::array<int, 7> projectile_counts = {10,   50,   100, 500,
+                                                1000, 2500, 5000};
+  const vec2 world{(float)width, (float)height};
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> ux(0.f, world.x);
+  std::uniform_real_distribution<float> uy(0.f, world.y);
+  std::uniform_real_distribution<float> uv(-4.f, 4.f);
+
+  std::cout << fmt::format("{:>12} {:>14} {:>14} {:>10}\n", "projectiles",
+                           "linear ms/tick", "grid ms/tick", "speedup");
+
+  auto &pool = ProjectilePool::get();
+  for (int num_projectiles : projectile_counts) {
+    reset_world();
+    pool.clear();
+
+    for (int i = 0; i < NUM_KARTS; i++) {
+      auto &kart = EntityHelper::createEntity();
+      kart.addComponent<Transform>(vec2{ux(rng), uy(rng)}, vec2{15.f, 25.f});
+      kart.addComponent<HasHealth>(MAX_HEALTH);
+    }
+    for (int i = 0; i < NUM_OBSTACLES; i++) {
+      auto &obstacle = EntityHelper::createEntity();
+      obstacle.addComponent<Transform>(vec2{ux(rng), uy(rng)},
+                                       vec2{60.f, 60.f});
+      obstacle.addComponent<CollisionAbsorber>(
+          CollisionAbsorber::AbsorberType::Absorber);
+    }
+    auto &shooter = EntityHelper::createEntity();
+    EntityHelper::get_default_collection().merge_entity_arrays();
+    for (int i = 0; i < num_projectiles; i++) {
+      pool.spawn(ProjectilePool::Spawn{
+          .position = vec2{ux(rng), uy(rng)},
+          .size = vec2{10.f, 10.f},
+          .velocity = vec2{uv(rng), uv(rng)},
+          .angle = 0.f,
+          .accel = 0.f,
+          .lifetime = 1000.f,
+          .damage = 1,
+          .source = shooter,
+          .color = raylib::WHITE,
+          .can_wrap = true,
+          .render_out_of_bounds = true,
+      });
+    }
+
+    // bullets fly, nothing gets killed, so both passes see the same ticks
+    const auto step = [&]() {
+      pool.for_each_live([&](size_t i) {
+        pool.x[i] = std::fmod(pool.x[i] + pool.vx[i] + world.x, world.x);
+        pool.y[i] = std::fmod(pool.y[i] + pool.vy[i] + world.y, world.y);
+      });
+    };
+
+    size_t linear_hits = 0;
+    auto start = Clock::now();
+    for (int tick = 0; tick < NUM_TICKS; tick++) {
+      step();
+      pool.for_each_live([&](size_t i) {
+        linear_hits += EQ().whereHasComponent<HasHealth>()
+                           .whereOverlaps(pool.rect(i))
+                           .gen_count();
+        linear_hits += EQ().whereHasComponent<CollisionAbsorber>()
+                           .whereOverlaps(pool.rect(i))
+                           .gen_count();
+      });
+    }
+    const float linear_ms = elapsed_ms(start) / NUM_TICKS;
+
+    size_t grid_hits = 0;
+    start = Clock::now();
+    for (int tick = 0; tick < NUM_TICKS; tick++) {
+      step();
+      SpatialIndex::get().rebuild(world);
+      pool.for_each_live([&](size_t i) {
+        EQ::for_each_overlapping<HasHealth>(
+            pool.rect(i), [&](const Entity &) { grid_hits++; });
+        EQ::for_each_overlapping<CollisionAbsorber>(
+            pool.rect(i), [&](const Entity &) { grid_hits++; });
+      });
+    }
+    const float grid_ms = elapsed_ms(start) / NUM_TICKS;
+    SpatialIndex::get().invalidate();
+
+    if (linear_hits != grid_hits) {
+      log_warn("spatial index mismatch: linear found {} overlaps, grid {}",
+               linear_hits, grid_hits);
+    }
+
+    std::cout << fmt::format("{:>12} {:>14.3f} {:>14.3f} {:>9.1f}x\n",
+                             num_projectiles, linear_ms, grid_ms,
+                             grid_ms > 0.f ? linear_ms / grid_ms : 0.f);
+  }
+
+  pool.clear();
+  reset_world();
+  return 0;
+}
+
+// Karts drawn with a shader mode and uniform upload per kart against the
+// batched path (one shader mode per shader, per-kart values in the vertex
+// color). The per-kart loop is a stand-in for how RenderSpritesWithShaders
+// used to draw, not that code itself. Draw calls are counted at the GL entry
+// points (CountDrawCalls) over every frame of each variant.
+int sprite_batching(int width, int height) {
+  constexpr int NUM_FRAMES = 200;
+  const std::array<int, 3> kart_counts = {8, 64, 512};
+
+  raylib::SetConfigFlags(raylib::FLAG_WINDOW_HIDDEN);
+  raylib::InitWindow(width, height, "kart sprite benchmark");
+  raylib::SetTargetFPS(0);
+  ShaderLibrary::get().load_all_shaders();
+  if (!ShaderLibrary::get().contains(ShaderType::car)) {
+    log_error("car shader failed to load, run from the repo root");
+    raylib::CloseWindow();
+    return 1;
+  }
+
+  const raylib::Image image =
+      raylib::GenImageChecked(64, 64, 8, 8, raylib::WHITE, raylib::GRAY);
+  const raylib::Texture2D sheet = raylib::LoadTextureFromImage(image);
+  raylib::UnloadImage(image);
+  const Rectangle source{0.f, 0.f, 64.f, 64.f};
+
+  const raylib::Shader &shader = ShaderLibrary::get().get(ShaderType::car);
+  const float uv_min[2] = {0.f, 0.f};
+  const float uv_max[2] = {1.f, 1.f};
+  const vec2 resolution{(float)width, (float)height};
+
+  struct Kart {
+    Rectangle dest;
+    float angle;
+    raylib::Color color;
+    float speed;
+  };
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> ux(0.f, (float)width);
+  std::uniform_real_distribution<float> uy(0.f, (float)height);
+  std::uniform_real_distribution<float> u01(0.f, 1.f);
+
+  const auto set_common = [&](float time) {
+    raylib::SetShaderValue(shader, raylib::GetShaderLocation(shader, "time"),
+                           &time, raylib::SHADER_UNIFORM_FLOAT);
+    raylib::SetShaderValue(shader,
+                           raylib::GetShaderLocation(shader, "resolution"),
+                           &resolution, raylib::SHADER_UNIFORM_VEC2);
+    raylib::SetShaderValue(shader, raylib::GetShaderLocation(shader, "uvMin"),
+                           uv_min, raylib::SHADER_UNIFORM_VEC2);
+    raylib::SetShaderValue(shader, raylib::GetShaderLocation(shader, "uvMax"),
+                           uv_max, raylib::SHADER_UNIFORM_VEC2);
+  };
+
+  const auto draw = [&](const Kart &kart, raylib::Color tint) {
+    raylib::DrawTexturePro(sheet, source, kart.dest,
+                           vec2{kart.dest.width / 2.f, kart.dest.height / 2.f},
+                           kart.angle, tint);
+  };
+
+  struct Result {
+    // per frame, averaged over NUM_FRAMES
+    float ms;
+    float draw_calls;
+  };
+  const auto time_frames = [&](const auto &render) {
+    const CountDrawCalls counter;
+    auto start = Clock::now();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      raylib::BeginDrawing();
+      raylib::ClearBackground(raylib::DARKGRAY);
+      render(static_cast<float>(frame) / 60.f);
+      raylib::EndDrawing();
+    }
+    const float ms = elapsed_ms(start) / NUM_FRAMES;
+    return Result{ms, CountDrawCalls::calls < 0
+                          ? -1.f
+                          : static_cast<float>(CountDrawCalls::calls) /
+                                NUM_FRAMES};
+  };
+
+  std::cout << fmt::format("{:>6} {:>13} {:>12} {:>17} {:>16} {:>9}\n",
+                           "karts", "draws per-kart", "draws batched",
+                           "ms/frame per-kart", "ms/frame batched",
+                           "speedup");
+
+  for (int num_karts : kart_counts) {
+    std::vector<Kart> karts;
+    karts.reserve(num_karts);
+    for (int i = 0; i < num_karts; i++) {
+      karts.push_back(Kart{
+          Rectangle{ux(rng), uy(rng), 30.f, 30.f},
+          u01(rng) * 360.f,
+          raylib::ColorFromHSV(u01(rng) * 360.f, 0.8f, 0.9f),
+          u01(rng),
+      });
+    }
+
+    const Result before = time_frames([&](float time) {
+      for (const Kart &kart : karts) {
+        raylib::BeginShaderMode(shader);
+        set_common(time);
+        draw(kart, ShaderUtils::pack_sprite_tint(kart.color, kart.speed,
+                                                 false));
+        raylib::EndShaderMode();
+      }
+    });
+
+    const Result after = time_frames([&](float time) {
+      raylib::BeginShaderMode(shader);
+      set_common(time);
+      for (const Kart &kart : karts) {
+        draw(kart, ShaderUtils::pack_sprite_tint(kart.color, kart.speed,
+                                                 false));
+      }
+      raylib::EndShaderMode();
+    });
+
+    std::cout << fmt::format(
+        "{:>6} {:>13.0f} {:>12.0f} {:>17.3f} {:>16.3f} {:>8.1f}x\n",
+        num_karts, before.draw_calls, after.draw_calls, before.ms, after.ms,
+        after.ms > 0.f ? before.ms / after.ms : 0.f);
+  }
+
+  raylib::UnloadTexture(sheet);
+  ShaderLibrary::get().unload_all();
+  raylib::CloseWindow();
+  return 0;
+}
+
+// The old frame ending (mainRT copied into screenRT through the spotlight,
+// the UI drawn on top, screenRT copied to the window through the base
+// effects) against PostFx compositing both targets in one pass, for the
+// effects each game mode asks for. The old shaders are gone;
+// their code lives on in post_fx.fs, so the two-pass path is rebuilt from
+// PostFx variants that each do one half of the work.
+int post_fx_passes(int width, int height) {
+  constexpr int NUM_FRAMES = 200;
+
+  raylib::SetConfigFlags(raylib::FLAG_WINDOW_HIDDEN);
+  raylib::InitWindow(width, height, "post fx benchmark");
+  raylib::SetTargetFPS(0);
+  auto &post_fx = PostFx::get();
+  if (!post_fx.variant(0)) {
+    log_error("post fx shader failed to load, run from the repo root");
+    raylib::CloseWindow();
+    return 1;
+  }
+
+  raylib::RenderTexture2D world = raylib::LoadRenderTexture(width, height);
+  raylib::RenderTexture2D ui = raylib::LoadRenderTexture(width, height);
+  // the old passes had no second input; this stands in for it
+  raylib::RenderTexture2D blank = raylib::LoadRenderTexture(width, height);
+  const raylib::Rectangle full{0.f, 0.f, (float)width, (float)height};
+  const vec2 resolution{(float)width, (float)height};
+
+  raylib::BeginTextureMode(world);
+  raylib::ClearBackground(raylib::DARKGREEN);
+  for (int i = 0; i < 64; i++) {
+    raylib::DrawRectangle((i * 97) % width, (i * 53) % height, 40, 40,
+                          raylib::ColorFromHSV(i * 37.f, 0.8f, 0.9f));
+  }
+  raylib::EndTextureMode();
+  raylib::BeginTextureMode(blank);
+  raylib::ClearBackground(raylib::BLANK);
+  raylib::EndTextureMode();
+
+  const auto draw_ui = [&]() {
+    raylib::DrawRectangle(20, 20, width / 4, 60,
+                          raylib::Fade(raylib::BLACK, 0.6f));
+    raylib::DrawText("3", width / 2, height / 2, 80, raylib::WHITE);
+  };
+
+  // frame time in ms, averaged over NUM_FRAMES
+  const auto time_frames = [&](const auto &render) {
+    auto start = Clock::now();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      render();
+    }
+    return elapsed_ms(start) / NUM_FRAMES;
+  };
+
+  post_fx.spotlight = PostFx::SpotlightParams{
+      true, vec2{0.5f, 0.5f}, 0.22f, 0.18f, 0.82f, 0.85f};
+
+  // What each mode asks PostFx for with the default settings: base fx on
+  // everywhere, and ConfigureTaggerSpotlight lights the tagger only during
+  // Tag and Go's countdown. The last row is any mode with post-processing
+  // turned off in the settings.
+  struct Mode {
+    std::string name;
+    uint8_t effects;
+  };
+  std::vector<Mode> modes;
+  for (const RoundType mode : magic_enum::enum_values<RoundType>()) {
+    const std::string name(magic_enum::enum_name(mode));
+    modes.push_back(Mode{name, PostFx::BaseFx});
+    if (mode == RoundType::TagAndGo) {
+      modes.push_back(
+          Mode{name + " countdown", PostFx::Spotlight | PostFx::BaseFx});
+    }
+  }
+  modes.push_back(Mode{"post processing off", 0});
+
+  std::cout << fmt::format("{:<20} {:<22} {:>13} {:>15} {:>12} {:>14} {:>9}\n",
+                           "mode", "effects", "passes before",
+                           "ms/frame before", "passes after",
+                           "ms/frame after", "speedup");
+
+  for (const Mode &mode : modes) {
+    const uint8_t effects = mode.effects;
+    const bool spotlight = effects & PostFx::Spotlight;
+    const bool base_fx = effects & PostFx::BaseFx;
+
+    // counted from what compose() reports, not assumed
+    int passes_before = 0;
+    const float before_ms = time_frames([&]() {
+      raylib::BeginTextureMode(ui);
+      raylib::ClearBackground(raylib::BLANK);
+      post_fx.compose(world.texture, blank.texture, full,
+                      spotlight ? PostFx::Spotlight : 0, resolution);
+      passes_before = post_fx.full_screen_passes;
+      draw_ui();
+      raylib::EndTextureMode();
+
+      raylib::BeginDrawing();
+      post_fx.compose(ui.texture, blank.texture, full,
+                      base_fx ? PostFx::BaseFx : 0, resolution);
+      passes_before += post_fx.full_screen_passes;
+      raylib::EndDrawing();
+    });
+
+    const float after_ms = time_frames([&]() {
+      raylib::BeginTextureMode(ui);
+      raylib::ClearBackground(raylib::BLANK);
+      draw_ui();
+      raylib::EndTextureMode();
+
+      raylib::BeginDrawing();
+      post_fx.compose(world.texture, ui.texture, full, effects, resolution);
+      raylib::EndDrawing();
+    });
+
+    std::cout << fmt::format("{:<20} {:<22} {:>13} {:>15.3f} {:>12} "
+                             "{:>14.3f} {:>8.1f}x\n",
+                             mode.name, PostFx::describe(effects),
+                             passes_before,
+                             before_ms,
+                             post_fx.full_screen_passes, after_ms,
+                             after_ms > 0.f ? before_ms / after_ms : 0.f);
+  }
+
+  raylib::UnloadRenderTexture(world);
+  raylib::UnloadRenderTexture(ui);
+  raylib::UnloadRenderTexture(blank);
+  post_fx.unload_all();
+  raylib::CloseWindow();
+  return 0;
+}
+
+// 64 AI karts on the maze map, steering the way AIVelocity did (straight at
+// the target) and along NavGrid flow fields. A third of them go for fixed
+// pickups, a third chase another kart, and the rest flee kart 0. Karts are
+// points moving at a fixed speed; a step that would end inside a wall is
+// dropped and counted as a wall hit, which is what the flow fields are
+// meant to bring down. Flow ms/tick includes building the fields.
+int nav_flow_field(int width, int height) {
+  constexpr int NUM_AIS = 64;
+  constexpr int NUM_TICKS = 600;
+  constexpr float SPEED = 3.f;
+  constexpr float LOOKAHEAD = 200.f;
+
+  const afterhours::window_manager::Resolution resolution{.width = width,
+                                                          .height = height};
+  const auto maze = std::ranges::find_if(
+      MapManager::available_maps,
+      [](const MapConfig &map) { return map.display_name == "Maze"; });
+  if (maze == MapManager::available_maps.end()) {
+    log_error("no maze map to benchmark on");
+    return 1;
+  }
+  const MapDescription map = maze->describe();
+  std::vector<raylib::Rectangle> walls;
+  for (const MapPiece &piece : map) {
+    if (piece.kind == MapPiece::Kind::Obstacle)
+      walls.push_back(piece.rect(resolution));
+  }
+  const auto in_wall = [&](vec2 p) {
+    return std::ranges::any_of(walls, [&](const raylib::Rectangle &r) {
+      return raylib::CheckCollisionPointRec(p, r);
+    });
+  };
+
+  auto &nav = NavGrid::get();
+  auto start = Clock::now();
+  MapManager::build_nav_grid(map, resolution);
+  const float grid_ms = elapsed_ms(start);
+  const size_t blocked = static_cast<size_t>(
+      std::ranges::count(nav.blocked, static_cast<uint8_t>(1)));
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> ux(0.f, (float)width);
+  std::uniform_real_distribution<float> uy(0.f, (float)height);
+  const auto random_open = [&]() {
+    vec2 p{ux(rng), uy(rng)};
+    while (in_wall(p))
+      p = vec2{ux(rng), uy(rng)};
+    return p;
+  };
+  std::vector<vec2> starts(NUM_AIS);
+  std::ranges::generate(starts, random_open);
+  const std::array<vec2, 4> pickups = {random_open(), random_open(),
+                                       random_open(), random_open()};
+
+  // where kart i wants to go this tick; fleeing karts look ahead from
+  // themselves, away from kart 0
+  const auto goal_for = [&](const std::vector<vec2> &pos, int i,
+                            bool flow) -> vec2 {
+    switch (i % 3) {
+    case 0:
+      return *std::ranges::min_element(pickups, {}, [&](vec2 p) {
+        return distance_sq(pos[(size_t)i], p);
+      });
+    case 1:
+      return pos[(size_t)((i + 1) % NUM_AIS)];
+    default:
+      break;
+    }
+    vec2 away = vec_norm(pos[(size_t)i] - pos[0]);
+    if (flow) {
+      if (const NavGrid::FlowField *threat = nav.field_to(pos[0])) {
+        away = nav.flee_direction(*threat, pos[(size_t)i]).value_or(away);
+      }
+    }
+    return pos[(size_t)i] + (away * LOOKAHEAD);
+  };
+
+  struct Result {
+    float ms_per_tick;
+    size_t wall_hits;
+  };
+  const auto run = [&](bool flow) {
+    std::vector<vec2> pos = starts;
+    size_t wall_hits = 0;
+    auto begin = Clock::now();
+    for (int tick = 0; tick < NUM_TICKS; tick++) {
+      nav.begin_tick();
+      for (int i = 0; i < NUM_AIS; i++) {
+        vec2 &p = pos[(size_t)i];
+        const vec2 goal = goal_for(pos, i, flow);
+        vec2 steer_to = goal;
+        if (flow) {
+          if (const NavGrid::FlowField *field = nav.field_to(goal)) {
+            steer_to = nav.steer_point(*field, p, goal);
+          }
+        }
+        if (distance_sq(p, steer_to) < SPEED * SPEED)
+          continue;
+        const vec2 next = p + (vec_norm(steer_to - p) * SPEED);
+        if (in_wall(next)) {
+          wall_hits++;
+          continue;
+        }
+        p = vec2{std::clamp(next.x, 0.f, (float)width),
+                 std::clamp(next.y, 0.f, (float)height)};
+      }
+    }
+    return Result{elapsed_ms(begin) / NUM_TICKS, wall_hits};
+  };
+
+  const Result straight = run(false);
+  const size_t builds_before = nav.builds_total;
+  const Result flow = run(true);
+
+  std::cout << fmt::format("maze {}x{}: {}x{} cells, {} blocked, grid built "
+                           "in {:.3f}ms\n",
+                           width, height, nav.cols, nav.rows, blocked,
+                           grid_ms);
+  std::cout << fmt::format("{:>10} {:>10} {:>10} {:>13}\n", "steering",
+                           "ms/tick", "wall hits", "fields built");
+  std::cout << fmt::format("{:>10} {:>10.4f} {:>10} {:>13}\n", "straight",
+                           straight.ms_per_tick, straight.wall_hits, 0);
+  std::cout << fmt::format("{:>10} {:>10.4f} {:>10} {:>13}\n", "flow",
+                           flow.ms_per_tick, flow.wall_hits,
+                           nav.builds_total - builds_before);
+
+  nav.clear();
+  return 0;
+}
+
+// lives_ai_target's scoring for every AI, the way it used to walk the karts
+// (every candidate against every other kart, per AI) against reading the
+// KartDistanceMatrix built once per frame. Both pick the same targets.
+int kart_targeting(int width, int height) {
+  constexpr int NUM_FRAMES = 120;
+  const std::array<int, 5> kart_counts = {8, 16, 32, 64, 128};
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> ux(0.f, (float)width);
+  std::uniform_real_distribution<float> uy(0.f, (float)height);
+
+  std::cout << fmt::format("{:>6} {:>16} {:>16} {:>9}\n", "karts",
+                           "nested ms/frame", "matrix ms/frame", "speedup");
+
+  for (int num_karts : kart_counts) {
+    reset_world();
+    for (int i = 0; i < num_karts; i++) {
+      auto &kart = EntityHelper::createEntity();
+      kart.addComponent<Transform>(vec2{ux(rng), uy(rng)}, vec2{15.f, 25.f});
+      if (i < 4) {
+        kart.addComponent<PlayerID>(i);
+      } else {
+        kart.addComponent<AIControlled>();
+      }
+    }
+    EntityHelper::get_default_collection().merge_entity_arrays();
+    const auto &karts =
+        QueryCache::get().with_any<Transform, PlayerID, AIControlled>();
+
+    const auto score = [](float d2, float avoidance) {
+      return (1.0f / (1.0f + d2 / 10000.0f)) * 0.6f + avoidance * 0.4f;
+    };
+
+    std::vector<EntityID> nested_picks;
+    auto start = Clock::now();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      nested_picks.clear();
+      for (const auto &me_ref : karts) {
+        const Entity &me = me_ref.get();
+        const vec2 my_pos = me.get<Transform>().pos();
+        float best = -std::numeric_limits<float>::max();
+        EntityID pick = -1;
+        for (const auto &ref : karts) {
+          const Entity &player = ref.get();
+          if (player.id == me.id)
+            continue;
+          const vec2 player_pos = player.get<Transform>().pos();
+          float avoidance = 0.f;
+          for (const auto &other_ref : karts) {
+            const Entity &other = other_ref.get();
+            if (other.id == player.id || other.id == me.id)
+              continue;
+            avoidance += std::min(
+                distance_sq(player_pos, other.get<Transform>().pos()) /
+                    10000.0f,
+                1.0f);
+          }
+          const float s = score(distance_sq(my_pos, player_pos), avoidance);
+          if (s > best) {
+            best = s;
+            pick = player.id;
+          }
+        }
+        nested_picks.push_back(pick);
+      }
+    }
+    const float nested_ms = elapsed_ms(start) / NUM_FRAMES;
+
+    auto &matrix = KartDistanceMatrix::get();
+    std::vector<EntityID> matrix_picks;
+    start = Clock::now();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      matrix_picks.clear();
+      matrix.build(karts);
+      for (const auto &me_ref : karts) {
+        const size_t me = matrix.slot_of(me_ref.get()).value();
+        float best = -std::numeric_limits<float>::max();
+        EntityID pick = -1;
+        for (size_t j = 0; j < matrix.count; j++) {
+          if (j == me)
+            continue;
+          const float d2 = matrix.distance_sq(me, j);
+          const float avoidance =
+              matrix.avoidance[j] -
+              std::min(d2 / KartDistanceMatrix::AVOIDANCE_RANGE_SQ, 1.f);
+          const float s = score(d2, avoidance);
+          if (s > best) {
+            best = s;
+            pick = matrix.ids[j];
+          }
+        }
+        matrix_picks.push_back(pick);
+      }
+    }
+    const float matrix_ms = elapsed_ms(start) / NUM_FRAMES;
+
+    if (nested_picks != matrix_picks) {
+      log_warn("kart targeting mismatch at {} karts (float rounding can "
+               "flip near-ties)",
+               num_karts);
+    }
+    std::cout << fmt::format("{:>6} {:>16.4f} {:>16.4f} {:>8.1f}x\n",
+                             num_karts, nested_ms, matrix_ms,
+                             matrix_ms > 0.f ? nested_ms / matrix_ms : 0.f);
+  }
+
+  reset_world();
+  return 0;
+}
+
+// The AI as the fixed step registers it (ScheduleAIDecisions,
+// CaptureAISnapshot, EvaluateAI, ApplyAICommands) over a match of mixed
+// difficulties, for bot counts past what a real match has. Each count runs
+// twice from the same start, once with EvaluateAI on the main thread alone
+// and once split over the JobPool; both have to come out with the same
+// commands.
+int ai_evaluation(int width, int height) {
+  constexpr int NUM_TICKS = 240;
+  constexpr int NUM_HIPPOS = 8;
+  const std::array<int, 4> kart_counts = {8, 32, 128, 256};
+  constexpr std::array<RoundType, 4> modes = {
+      RoundType::Lives, RoundType::Kills, RoundType::Hippo,
+      RoundType::TagAndGo};
+  constexpr std::array<AIDifficulty::Difficulty, 4> difficulties = {
+      AIDifficulty::Difficulty::Easy, AIDifficulty::Difficulty::Medium,
+      AIDifficulty::Difficulty::Hard, AIDifficulty::Difficulty::Expert};
+
+  reset_world();
+  // CaptureAISnapshot reads the arena off this, as it does in a match
+  auto &sophie = EntityHelper::createEntity();
+  sophie.addComponent<window_manager::ProvidesCurrentResolution>()
+      .current_resolution = window_manager::Resolution{.width = width,
+                                                       .height = height};
+  EntityHelper::registerSingleton<window_manager::ProvidesCurrentResolution>(
+      sophie);
+
+  auto &round = RoundManager::get();
+  round.active_round_type = RoundType::Kills;
+  round.get_active_settings().state = RoundSettings::GameState::InGame;
+
+  auto &sim = SimulationClock::get();
+  auto &scheduler = AIScheduler::get();
+  auto &frame = AIFrame::get();
+
+  struct Result {
+    float ms_per_tick;
+    float decisions_per_tick;
+    size_t cap;
+    std::vector<AICommand> commands;
+  };
+  const auto run = [&](int num_karts, bool pooled) {
+    for (const auto &entity : EntityHelper::get_entities()) {
+      if (entity->id != sophie.id)
+        entity->cleanup = true;
+    }
+    cleanup_entities();
+    NavGrid::get().clear();
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> ux(0.f, (float)width);
+    std::uniform_real_distribution<float> uy(0.f, (float)height);
+    std::uniform_real_distribution<float> uangle(0.f, 360.f);
+    for (int i = 0; i < num_karts; i++) {
+      auto &kart = EntityHelper::createEntity();
+      auto &transform = kart.addComponent<Transform>(vec2{ux(rng), uy(rng)},
+                                                     vec2{15.f, 25.f});
+      transform.angle = uangle(rng);
+      auto &tracking = kart.addComponent<HasTagAndGoTracking>();
+      tracking.is_tagger = i % 8 == 0;
+      if (i < 4) {
+        kart.addComponent<PlayerID>(i);
+        continue;
+      }
+      const RoundType mode = modes[i % modes.size()];
+      const auto difficulty = difficulties[(i / 4) % difficulties.size()];
+      kart.addComponent<AIControlled>().target = vec2{ux(rng), uy(rng)};
+      kart.addComponent<AIMode>(mode, false);
+      kart.addComponent<AIDifficulty>(difficulty);
+      AIUpdateAIParamsSystem::apply(kart.addComponent<AIParams>(), mode,
+                                    difficulty);
+      kart.addComponent<CanShoot>();
+    }
+    for (int i = 0; i < NUM_HIPPOS; i++) {
+      auto &hippo = EntityHelper::createEntity();
+      hippo.addComponent<Transform>(vec2{ux(rng), uy(rng)}, vec2{10.f, 10.f});
+      hippo.addComponent<HippoItem>();
+    }
+    EntityHelper::get_default_collection().merge_entity_arrays();
+    QueryCache::get().invalidate();
+
+    sim.elapsed = 0.0;
+    // EvaluateAI's random retargets
+    std::srand(1234);
+    ScheduleAIDecisions schedule;
+    CaptureAISnapshot capture;
+    EvaluateAI evaluate;
+    evaluate.pooled = pooled;
+    ApplyAICommands apply;
+
+    size_t decisions = 0;
+    const auto start = Clock::now();
+    for (int tick = 0; tick < NUM_TICKS; tick++) {
+      sim.advance(sim.fixed_dt);
+      schedule.once(sim.fixed_dt);
+      capture.once(sim.fixed_dt);
+      evaluate.once(sim.fixed_dt);
+      apply.once(sim.fixed_dt);
+      decisions += scheduler.admitted;
+    }
+    return Result{elapsed_ms(start) / NUM_TICKS,
+                  (float)decisions / NUM_TICKS, scheduler.cap,
+                  frame.commands};
+  };
+
+  std::cout << fmt::format("{} thread(s), {:.0f}hz\n", JobPool::get().threads(),
+                           1.f / sim.fixed_dt);
+  std::cout << fmt::format("{:>6} {:>15} {:>10} {:>14} {:>14} {:>9}\n",
+                           "karts", "decisions/tick", "cap/tick",
+                           "serial ms/tick", "pooled ms/tick", "speedup");
+  for (int num_karts : kart_counts) {
+    const Result serial = run(num_karts, false);
+    const Result pooled = run(num_karts, true);
+
+    for (size_t i = 0; i < serial.commands.size(); i++) {
+      const AICommand &a = serial.commands[i];
+      const AICommand &b = pooled.commands[i];
+      if (a.target.x != b.target.x || a.target.y != b.target.y ||
+          a.angle != b.angle || a.fire != b.fire || a.boost != b.boost) {
+        log_error("ai evaluation differs between serial and pooled at {} "
+                  "karts",
+                  num_karts);
+        reset_world();
+        return 1;
+      }
+    }
+    std::cout << fmt::format(
+        "{:>6} {:>15.2f} {:>10} {:>14.4f} {:>14.4f} {:>8.1f}x\n", num_karts,
+        pooled.decisions_per_tick, pooled.cap, serial.ms_per_tick,
+        pooled.ms_per_tick,
+        pooled.ms_per_tick > 0.f ? serial.ms_per_tick / pooled.ms_per_tick
+                                 : 0.f);
+  }
+
+  reset_world();
+  return 0;
+}
+
+int run(const std::string &name, int width, int height) {
+  if (name == "spatial") {
+    return spatial_index(width, height);
+  }
+  if (name == "sprites") {
+    return sprite_batching(width, height);
+  }
+  if (name == "postfx") {
+    return post_fx_passes(width, height);
+  }
+  if (name == "nav") {
+    return nav_flow_field(width, height);
+  }
+  if (name == "targeting") {
+    return kart_targeting(width, height);
+  }
+  if (name == "ai") {
+    return ai_evaluation(width, height);
+  }
+  log_error("Unknown benchmark '{}', options are: spatial, sprites, postfx, "
+            "nav, targeting, ai",
+            name);
+  return 1;
+}
+
+} // namespace benchmarks
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+// Developer benchmarks, run with `--bench <name>` instead of starting the
+// game. Each prints a small table to stdout and returns a process exit code.
+namespace benchmarks {
+
+int run(const std::string &name, int width, int height);
+
+int spatial_index(int width, int height);
+int sprite_batching(int width, int height);
+int post_fx_passes(int width, int height);
+int nav_flow_field(int width, int height);
+int kart_targeting(int width, int height);
+int ai_evaluation(int width, int height);
+
+} // namespace benchmarks
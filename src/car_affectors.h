@@ -2,44 +2,81 @@
 
 #include "components.h"
 #include "query.h"
+#include "tags.h"
 
 inline float affector_steering_multiplier(const Transform &transform) {
   float multiplier = 1.f;
-  auto affectors = EQ().whereHasComponent<SteeringAffector>()
-                       .whereOverlaps(transform.rect())
-                       .gen_as<SteeringAffector>();
-  for (SteeringAffector &affector : affectors)
-    multiplier *= affector.multiplier;
+  EQ::for_each_overlapping<SteeringAffector>(
+      transform.rect(), [&](const afterhours::Entity &entity) {
+        multiplier *= entity.get<SteeringAffector>().multiplier;
+      });
   return multiplier;
 }
 
 inline float affector_acceleration_multiplier(const Transform &transform) {
   float multiplier = 1.f;
-  auto affectors = EQ().whereHasComponent<AccelerationAffector>()
-                       .whereOverlaps(transform.rect())
-                       .gen_as<AccelerationAffector>();
-  for (AccelerationAffector &affector : affectors)
-    multiplier *= affector.multiplier;
+  EQ::for_each_overlapping<AccelerationAffector>(
+      transform.rect(), [&](const afterhours::Entity &entity) {
+        multiplier *= entity.get<AccelerationAffector>().multiplier;
+      });
   return multiplier;
 }
 
 inline float
 affector_steering_sensitivity_additive(const Transform &transform) {
   float sensitivity = 0.f;
-  auto affectors = EQ().whereHasComponent<SteeringIncrementor>()
-                       .whereOverlaps(transform.rect())
-                       .gen_as<SteeringIncrementor>();
-  for (SteeringIncrementor &affector : affectors)
-    sensitivity += affector.target_sensitivity;
+  EQ::for_each_overlapping<SteeringIncrementor>(
+      transform.rect(), [&](const afterhours::Entity &entity) {
+        sensitivity += entity.get<SteeringIncrementor>().target_sensitivity;
+      });
   return sensitivity;
 }
 
-inline float affector_speed_multiplier(const Transform &transform) {
+inline float affector_speed_multiplier(const raylib::Rectangle &rect) {
   float multiplier = 1.f;
-  auto affectors = EQ().whereHasComponent<SpeedAffector>()
-                       .whereOverlaps(transform.rect())
-                       .gen_as<SpeedAffector>();
-  for (SpeedAffector &affector : affectors)
-    multiplier *= affector.multiplier;
+  EQ::for_each_overlapping<SpeedAffector>(
+      rect, [&](const afterhours::Entity &entity) {
+        multiplier *= entity.get<SpeedAffector>().multiplier;
+      });
   return multiplier;
 }
+
+inline float affector_speed_multiplier(const Transform &transform) {
+  return affector_speed_multiplier(transform.rect());
+}
+
+// Resets every CarAffectorCache, then walks the floor overlays once and folds
+// each overlay's affectors into the caches of the cars it overlaps.
+struct ResolveCarAffectors : afterhours::System<> {
+  virtual void once(float) override {
+    for (CarAffectorCache &cache :
+         EQ().whereHasComponent<CarAffectorCache>().gen_as<CarAffectorCache>())
+      cache.reset();
+
+    auto overlays = EQ().whereHasTag(GameTag::FloorOverlay)
+                        .whereHasComponent<Transform>()
+                        .gen();
+    for (const afterhours::Entity &overlay : overlays) {
+      EQ::for_each_overlapping<CarAffectorCache>(
+          overlay.get<Transform>().rect(), [&](afterhours::Entity &car) {
+            if (car.id == overlay.id)
+              return;
+            apply(overlay, car.get<CarAffectorCache>());
+          });
+    }
+  }
+
+  static void apply(const afterhours::Entity &overlay,
+                    CarAffectorCache &cache) {
+    if (overlay.has<SteeringAffector>())
+      cache.steering_multiplier *= overlay.get<SteeringAffector>().multiplier;
+    if (overlay.has<AccelerationAffector>())
+      cache.acceleration_multiplier *=
+          overlay.get<AccelerationAffector>().multiplier;
+    if (overlay.has<SteeringIncrementor>())
+      cache.steering_sensitivity_additive +=
+          overlay.get<SteeringIncrementor>().target_sensitivity;
+    if (overlay.has<SpeedAffector>())
+      cache.speed_multiplier *= overlay.get<SpeedAffector>().multiplier;
+  }
+};
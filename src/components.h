@@ -2,11 +2,14 @@
 #pragma once
 
 #include "shader_types.h"
+#include <array>
 #include <optional>
 #include <string>
 
 #include <afterhours/src/core/opt_entity_handle.h>
+#include "entity_index.h"
 #include "input_mapping.h"
+#include "label_cache.h"
 #include "math_util.h"
 #include "max_health.h"
 #include "rl.h"
@@ -171,6 +174,9 @@ struct AIParams : ::afterhours::BaseComponent {
   // Cooldown override for AI boost requests (seconds); <= 0 to keep current
   // component/default
   float boost_cooldown_seconds{3.0f};
+
+  // How often target selection and shot evaluation run (see AIScheduler)
+  float decision_hz{20.0f};
 };
 
 struct AIBoostCooldown : ::afterhours::BaseComponent {
@@ -178,17 +184,19 @@ struct AIBoostCooldown : ::afterhours::BaseComponent {
   float cooldown_seconds = 3.0f;
 };
 
-struct HasEntityIDBasedColor : ::afterhours::HasColor {
-  ::afterhours::EntityID id{-1};
-  ::raylib::Color default_{::raylib::RAYWHITE};
-  HasEntityIDBasedColor(::afterhours::EntityID id_in, ::raylib::Color col, ::raylib::Color backup)
-      : ::afterhours::HasColor(col), id(id_in), default_(backup) {}
+// Set up by ScheduleAIDecisions; decide is only true for the frames this AI
+// gets to think in
+struct AIDecisionClock : ::afterhours::BaseComponent {
+  float next_decision = -1.0f;
+  bool decide = false;
 };
 
 struct TracksEntity : ::afterhours::BaseComponent {
-  ::afterhours::EntityID id{-1};
+  // stops resolving once the target is gone
+  EntityIndex::Handle target{};
   vec2 offset = vec2{0, 0};
-  TracksEntity(::afterhours::EntityID id_, vec2 off) : id(id_), offset(off) {}
+  TracksEntity(::afterhours::Entity &target_, vec2 off)
+      : target(EntityIndex::get().handle_for(target_)), offset(off) {}
 };
 
 using CollisionConfig = ::afterhours::collision::CollisionConfig;
@@ -203,15 +211,18 @@ struct Transform : ::afterhours::BaseComponent {
 
   float angle{0.f};
   float angle_prev{0.f};
+  // State at the start of the last fixed step, see render_position()
+  vec2 prev_position{0.f, 0.f};
   float speed_dot_angle{0.f};
   bool render_out_of_bounds{true};
   bool cleanup_out_of_bounds{false};
 
   vec2 pos() const { return position; }
   void update(const vec2 &v) { position = v; }
-  Transform(vec2 pos, vec2 sz) : position(pos), size(sz) {}
+  Transform(vec2 pos, vec2 sz) : position(pos), size(sz), prev_position(pos) {}
   Transform(Rectangle rect)
-      : position({rect.x, rect.y}), size({rect.width, rect.height}) {}
+      : position({rect.x, rect.y}), size({rect.width, rect.height}),
+        prev_position({rect.x, rect.y}) {}
   raylib::Rectangle rect() const {
     return raylib::Rectangle{position.x, position.y, size.x, size.y};
   }
@@ -239,52 +250,77 @@ struct Transform : ::afterhours::BaseComponent {
   }
 
   float as_rad() const { return static_cast<float>(angle * (M_PI / 180.0f)); }
+
+  /// Jumps further than this in a single step are wraps, respawns or
+  /// teleports and are drawn at the new spot instead of sliding across.
+  static constexpr float MAX_INTERPOLATED_DISTANCE = 100.f;
+
+  void snapshot() {
+    prev_position = position;
+    angle_prev = angle;
+  }
+
+  /// Where to draw this entity, `alpha` of the way from the previous fixed
+  /// step to the current one (SimulationClock::alpha).
+  vec2 render_position(float alpha) const {
+    const vec2 delta = position - prev_position;
+    if (vec_mag(delta) > MAX_INTERPOLATED_DISTANCE)
+      return position;
+    return prev_position + (delta * alpha);
+  }
+
+  float render_angle(float alpha) const {
+    // shortest way around, angle lives in [0, 360)
+    const float delta = std::remainder(angle - angle_prev, 360.f);
+    return angle_prev + (delta * alpha);
+  }
+
+  vec2 render_center(float alpha) const {
+    const vec2 p = render_position(alpha);
+    return {p.x + (size.x / 2.f), p.y + (size.y / 2.f)};
+  }
+
+  raylib::Rectangle render_rect(float alpha) const {
+    const vec2 p = render_position(alpha);
+    return raylib::Rectangle{p.x, p.y, size.x, size.y};
+  }
 };
 
+// The last few skid points of a kart. SkidMarks adds one per frame while the
+// kart slides and StampSkidMarks draws each new segment into the decal
+// texture once (see skid_decals.h), so only the points that have not been
+// drawn yet need to stick around. Older ones are overwritten in place.
 struct TireMarkComponent : ::afterhours::BaseComponent {
+  static constexpr size_t CAPACITY = 64;
+  // how long a mark takes to fade out completely
+  static constexpr float LIFETIME = 10.f;
+
   struct MarkPoint {
     vec2 position;
-    float time;
-    float lifetime;
     bool gap;
     float hue;
   };
 
   bool added_last_frame = false;
-  std::vector<MarkPoint> points;
+  std::array<MarkPoint, CAPACITY> points{};
+  // marks ever added; the ring holds the last min(added, CAPACITY)
+  size_t added = 0;
   float rolling_hue = 0.0f;
 
   void add_mark(vec2 pos, bool gap = false, float hue = 0.f) {
-    points.push_back(MarkPoint{.position = pos,
-                               .time = 10.f,
-                               .lifetime = 10.f,
-                               .gap = gap,
-                               .hue = hue});
+    points[added % CAPACITY] =
+        MarkPoint{.position = pos, .gap = gap, .hue = hue};
+    added++;
   }
 
-  void pass_time(float dt) {
-    for (auto it = points.begin(); it != points.end();) {
-      it->time -= dt;
-      if (it->time <= 0.0f) {
-        it = points.erase(it);
-      } else {
-        ++it;
-      }
-    }
+  [[nodiscard]] size_t oldest() const {
+    return added > CAPACITY ? added - CAPACITY : 0;
   }
-};
-
-struct CanDamage : ::afterhours::BaseComponent {
-  afterhours::OptEntityHandle source;
-  int amount;
-
-  CanDamage(::afterhours::Entity& source_entity, int amount_in)
-      : source{afterhours::OptEntityHandle::from_entity(source_entity)}, amount{amount_in} {}
-};
 
-struct HasLifetime : ::afterhours::BaseComponent {
-  float lifetime;
-  HasLifetime(float life) : lifetime(life) {}
+  // `seq` counts from the first mark ever added, oldest() <= seq < added
+  [[nodiscard]] const MarkPoint &at(size_t seq) const {
+    return points[seq % CAPACITY];
+  }
 };
 
 struct HasHealth : ::afterhours::BaseComponent {
@@ -294,7 +330,7 @@ struct HasHealth : ::afterhours::BaseComponent {
   float iframes = 0.5f;
   float iframesReset = 0.5f;
 
-  afterhours::OptEntityHandle last_damaged_by{};
+  EntityIndex::Handle last_damaged_by{};
 
   void pass_time(float dt) {
     if (iframes > 0)
@@ -372,6 +408,9 @@ struct LabelInfo {
   std::string label_text;
   vec2 label_pos_offset;
   LabelType label_type;
+
+  // Laid-out text from the last frame (mutable, RenderLabels is const)
+  mutable LabelCache cache;
 };
 
 struct HasLabels : public ::afterhours::BaseComponent {
@@ -422,6 +461,23 @@ struct SpeedAffector : CarAffector {
   SpeedAffector(float mult) : multiplier(mult) {}
 };
 
+/// Combined contribution of every floor affector a car is currently touching.
+/// Filled in once per fixed tick by ResolveCarAffectors so the movement
+/// systems don't each query the world for overlapping affectors.
+struct CarAffectorCache : ::afterhours::BaseComponent {
+  float steering_multiplier{1.f};
+  float acceleration_multiplier{1.f};
+  float steering_sensitivity_additive{0.f};
+  float speed_multiplier{1.f};
+
+  void reset() {
+    steering_multiplier = 1.f;
+    acceleration_multiplier = 1.f;
+    steering_sensitivity_additive = 0.f;
+    speed_multiplier = 1.f;
+  }
+};
+
 struct HasShader : ::afterhours::BaseComponent {
   std::vector<ShaderType> shaders; // Multiple shaders per entity using enums
   RenderPriority render_priority = RenderPriority::Entities; // When to render
@@ -109,3 +109,9 @@ struct WeaponFired : ::afterhours::BaseComponent {
         projectile(std::move(proj)), recoil(std::move(rec)),
         sound(std::move(snd)), action(act) {}
 };
+
+// Left by the fixed steps for the windowed per-frame pass, which plays it and
+// removes it; when a frame runs several steps the last shot's sound wins
+struct WeaponFiredThisFrame : ::afterhours::BaseComponent {
+  WeaponSoundInfo sound;
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "components.h"
+#include "projectile_pool.h"
+#include "spatial_index.h"
+#include "tags.h"
+#include <afterhours/src/singleton.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+enum struct ContactPhase { Begin, Stay, End };
+
+// Every overlapping pair of Transforms, found once per tick and shared by the
+// gameplay systems that react to touching (damage, absorption, hippo pickup,
+// tag transfer) instead of each of them asking the SpatialIndex again.
+//
+// Pairs are compared with last tick's to tell a new contact (Begin) from an
+// ongoing one (Stay); pairs that stopped touching are reported once as End.
+// Both ticks' pairs are kept as sorted keys and compared in one merge.
+// Overlap tests run once per pair, from the entity with the lower id. Two
+// StaticMapLayer pieces never move and nothing reacts to them touching, so
+// those pairs are skipped.
+//
+// Pooled bullets (ProjectilePool) are in here too, as one list of
+// bullet/entity overlaps found once per bullet. Bullets die on their first
+// hit, so they only ever Begin and have no phase. The damage and absorption
+// passes both read that list.
+//
+// Like the SpatialIndex, the entity pointers are only good until the next
+// EntityHelper::cleanup(), see ClearContacts. Entities flagged for cleanup
+// earlier in the tick are still reported: a hippo that touched a kart is
+// flagged by ProcessCollisionAbsorption before ProcessHippoCollection gets to
+// count it. Consumers that care check the flag (or their own state, like
+// HippoItem::collected) themselves.
+SINGLETON_FWD(ContactStream)
+struct ContactStream {
+  SINGLETON(ContactStream)
+
+  struct Contact {
+    // a->id < b->id; for End either side may already be gone (nullptr)
+    afterhours::Entity *a;
+    afterhours::Entity *b;
+    afterhours::EntityID a_id;
+    afterhours::EntityID b_id;
+    ContactPhase phase;
+  };
+
+  // Everything below is flat and keeps its capacity from tick to tick, so a
+  // rebuild allocates nothing once the match has warmed up.
+
+  // Begin and Stay sorted by pair key, then the Ends
+  std::vector<Contact> contacts;
+  // (entity id, index into contacts) for both sides of every contact, sorted
+  // by id; an entity's contacts are one equal_range
+  std::vector<std::pair<afterhours::EntityID, uint32_t>> by_entity;
+
+  // pair keys overlapping this tick and last tick, both sorted
+  std::vector<uint64_t> touching;
+  std::vector<uint64_t> touching_prev;
+  // what the index holds this tick, sorted by id, for End lookups
+  std::vector<std::pair<afterhours::EntityID, afterhours::Entity *>> present;
+
+  struct ProjectileContact {
+    // ProjectilePool slot; only good until the next spawn, which could
+    // reuse it
+    size_t slot;
+    afterhours::Entity *entity;
+  };
+  // in slot order, so each bullet's contacts are next to each other
+  std::vector<ProjectileContact> projectile_contacts;
+
+  static uint64_t key(afterhours::EntityID a, afterhours::EntityID b) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) |
+           static_cast<uint32_t>(b);
+  }
+  static uint64_t key(const Contact &c) { return key(c.a_id, c.b_id); }
+
+  // Needs a freshly rebuilt SpatialIndex
+  void rebuild() {
+    clear();
+    std::swap(touching, touching_prev);
+    touching.clear();
+
+    auto &index = SpatialIndex::get();
+    if (!index.valid)
+      return;
+
+    // Pairs overlapping now, phase decided below
+    for (const SpatialIndex::Entry &e : index.entries) {
+      afterhours::Entity &self = *e.entity;
+      present.emplace_back(self.id, &self);
+      const bool self_static = self.hasTag(GameTag::StaticMapLayer);
+      index.for_each_overlapping(e.rect, [&](afterhours::Entity &other) {
+        if (other.id <= self.id)
+          return;
+        if (self_static && other.hasTag(GameTag::StaticMapLayer))
+          return;
+        contacts.push_back(
+            Contact{&self, &other, self.id, other.id, ContactPhase::Begin});
+      });
+    }
+    std::ranges::sort(contacts, {}, [](const Contact &c) { return key(c); });
+    std::ranges::sort(present, {}, &decltype(present)::value_type::first);
+
+    // Merge with last tick's keys: in both is Stay, only now is Begin (as
+    // pushed), only last tick is End
+    const size_t now_count = contacts.size();
+    size_t prev = 0;
+    for (size_t i = 0; i < now_count; i++) {
+      const uint64_t k = key(contacts[i]);
+      touching.push_back(k);
+      while (prev < touching_prev.size() && touching_prev[prev] < k)
+        push_end(touching_prev[prev++]);
+      if (prev < touching_prev.size() && touching_prev[prev] == k) {
+        contacts[i].phase = ContactPhase::Stay;
+        prev++;
+      }
+    }
+    while (prev < touching_prev.size())
+      push_end(touching_prev[prev++]);
+
+    for (uint32_t i = 0; i < contacts.size(); i++) {
+      by_entity.emplace_back(contacts[i].a_id, i);
+      by_entity.emplace_back(contacts[i].b_id, i);
+    }
+    // stable so each entity sees its contacts in pair order
+    std::ranges::stable_sort(by_entity, {},
+                             &decltype(by_entity)::value_type::first);
+
+    const auto &pool = ProjectilePool::get();
+    pool.for_each_live([&](size_t i) {
+      index.for_each_overlapping(pool.rect(i), [&](afterhours::Entity &other) {
+        // a bullet never touches whoever fired it
+        if (other.id != pool.source_id[i])
+          projectile_contacts.push_back(ProjectileContact{i, &other});
+      });
+    });
+  }
+
+  void clear() {
+    contacts.clear();
+    by_entity.clear();
+    present.clear();
+    projectile_contacts.clear();
+  }
+
+  // fn(slot, Entity &other) for every bullet overlap this tick whose other
+  // side has all of Components, skipping bullets that died since (an earlier
+  // contact killed them)
+  template <typename... Components, typename Fn>
+  void for_each_projectile_contact(Fn &&fn) const {
+    const auto &pool = ProjectilePool::get();
+    for (const ProjectileContact &c : projectile_contacts) {
+      if (!pool.alive[c.slot])
+        continue;
+      if ((c.entity->has<Components>() && ...))
+        fn(c.slot, *c.entity);
+    }
+  }
+
+  // fn(Entity &other, ContactPhase) for every contact of `entity` this tick
+  // whose other side has all of Components. End contacts with an entity
+  // that is already gone are skipped.
+  template <typename... Components, typename Fn>
+  void for_each_contact(const afterhours::Entity &entity, Fn &&fn) const {
+    const auto [first, last] = std::ranges::equal_range(
+        by_entity, entity.id, {}, &decltype(by_entity)::value_type::first);
+    for (auto it = first; it != last; ++it) {
+      const Contact &c = contacts[it->second];
+      afterhours::Entity *other = c.a_id == entity.id ? c.b : c.a;
+      if (!other)
+        continue;
+      if ((other->has<Components>() && ...))
+        fn(*other, c.phase);
+    }
+  }
+
+  // Same, but only pairs that overlap right now (Begin and Stay)
+  template <typename... Components, typename Fn>
+  void for_each_touching(const afterhours::Entity &entity, Fn &&fn) const {
+    for_each_contact<Components...>(
+        entity, [&](afterhours::Entity &other, ContactPhase phase) {
+          if (phase != ContactPhase::End)
+            fn(other);
+        });
+  }
+
+private:
+  // A pair that stopped touching; a side that is no longer in the index has
+  // been freed and is reported as nullptr
+  void push_end(uint64_t k) {
+    const auto a_id = static_cast<afterhours::EntityID>(k >> 32);
+    const auto b_id = static_cast<afterhours::EntityID>(k & 0xffffffffu);
+    contacts.push_back(
+        Contact{lookup(a_id), lookup(b_id), a_id, b_id, ContactPhase::End});
+  }
+
+  [[nodiscard]] afterhours::Entity *lookup(afterhours::EntityID id) const {
+    auto it = std::ranges::lower_bound(
+        present, id, {}, &decltype(present)::value_type::first);
+    return it != present.end() && it->first == id ? it->second : nullptr;
+  }
+};
+
+// Registered right after the post-movement RebuildSpatialIndex in the fixed
+// pass.
+struct DetectContacts : afterhours::System<> {
+  virtual void once(float) override { ContactStream::get().rebuild(); }
+};
+
+// Registered next to InvalidateSpatialIndex. Only the per-tick list goes, the
+// set of touching pairs is kept so next tick can tell Begin from Stay.
+struct ClearContacts : afterhours::System<> {
+  virtual void once(float) override { ContactStream::get().clear(); }
+};
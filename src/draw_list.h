@@ -0,0 +1,267 @@
+#pragma once
+
+#include "library/shader_library.h"
+#include "rl.h"
+#include <afterhours/src/singleton.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// World draws for one frame, sorted by render state before they go out.
+//
+// The world renderers used to draw as they walked the ECS, each binding its
+// own shader per entity, so the GPU state flipped in whatever order the
+// entities happened to be stored. Now they only push Items here; the
+// SubmitDrawList system sorts everything once and draws it with a shader or
+// texture switch only where the sorted order changes state.
+//
+// Sort key, most significant first:
+//   layer   8 bits  which renderer, keeps the old back-to-front order
+//   shader 12 bits  0 for none, ShaderType + 1 otherwise
+//   texture 20 bits GL texture id, 0 for plain shapes
+//   depth  24 bits  push order, so ties draw in the order they came in
+SINGLETON_FWD(DrawList)
+struct DrawList {
+  SINGLETON(DrawList)
+
+  enum struct Layer : uint8_t {
+    Entities,
+    Projectiles,
+    Sprites,
+    Animations,
+    WeaponCooldown,
+  };
+
+  struct Item {
+    enum struct Kind : uint8_t { Rect, Sprite, Custom };
+
+    uint64_t key = 0;
+    Kind kind = Kind::Rect;
+    std::optional<ShaderType> shader;
+
+    // Rect and Sprite: DrawRectanglePro / DrawTexturePro arguments
+    raylib::Rectangle dest{};
+    vec2 origin{};
+    float angle = 0.f;
+    raylib::Color tint{};
+    raylib::Texture2D texture{};
+    raylib::Rectangle source{};
+
+    // Shaders that don't read the packed vertex color (see
+    // ShaderUtils::reads_sprite_tint) still want these as uniforms
+    bool entity_uniforms = false;
+    raylib::Color entity_color{};
+    float speed = 0.f;
+    bool winner = false;
+
+    // Custom: draws itself, for renderers that batch on their own
+    void (*draw)() = nullptr;
+  };
+
+  // Shader plus texture switches last frame, in the order the items were
+  // pushed and in the order they were drawn
+  struct Stats {
+    size_t items = 0;
+    size_t changes_unsorted = 0;
+    size_t changes_sorted = 0;
+  } stats;
+
+  std::vector<Item> items;
+
+  static uint64_t make_key(Layer layer, std::optional<ShaderType> shader,
+                           unsigned int texture_id, size_t depth) {
+    const uint64_t shader_bits =
+        shader.has_value() ? static_cast<uint64_t>(*shader) + 1 : 0;
+    return (static_cast<uint64_t>(layer) << 56) |
+           ((shader_bits & 0xfffull) << 44) |
+           ((static_cast<uint64_t>(texture_id) & 0xfffffull) << 24) |
+           (static_cast<uint64_t>(depth) & 0xffffffull);
+  }
+
+  void push_rect(Layer layer, std::optional<ShaderType> shader,
+                 raylib::Rectangle dest, vec2 origin, float angle,
+                 raylib::Color color) {
+    Item item;
+    item.key = make_key(layer, shader, 0, items.size());
+    item.kind = Item::Kind::Rect;
+    item.shader = shader;
+    item.dest = dest;
+    item.origin = origin;
+    item.angle = angle;
+    item.tint = color;
+    items.push_back(item);
+  }
+
+  // Returned so the caller can fill in entity_uniforms
+  Item &push_sprite(Layer layer, std::optional<ShaderType> shader,
+                    const raylib::Texture2D &texture, raylib::Rectangle source,
+                    raylib::Rectangle dest, vec2 origin, float angle,
+                    raylib::Color tint) {
+    Item item;
+    item.key = make_key(layer, shader, texture.id, items.size());
+    item.kind = Item::Kind::Sprite;
+    item.shader = shader;
+    item.texture = texture;
+    item.source = source;
+    item.dest = dest;
+    item.origin = origin;
+    item.angle = angle;
+    item.tint = tint;
+    items.push_back(item);
+    return items.back();
+  }
+
+  void push_custom(Layer layer, unsigned int texture_id, void (*draw)()) {
+    Item item;
+    item.key = make_key(layer, std::nullopt, texture_id, items.size());
+    item.kind = Item::Kind::Custom;
+    item.texture.id = texture_id;
+    item.draw = draw;
+    items.push_back(item);
+  }
+
+  void submit() {
+    sort();
+    stats.items = items.size();
+    stats.changes_unsorted = count_changes(false);
+    stats.changes_sorted = count_changes(true);
+
+    auto &library = ShaderLibrary::get();
+    std::optional<ShaderType> bound;
+    std::optional<raylib::Rectangle> uv_source;
+
+    for (const Sorted &s : sorted) {
+      const Item &item = items[s.index];
+      if (item.shader != bound) {
+        if (bound.has_value()) {
+          raylib::EndShaderMode();
+        }
+        bound = item.shader;
+        uv_source.reset();
+        if (bound.has_value()) {
+          raylib::BeginShaderMode(library.get(*bound));
+          library.set_common_uniforms(*bound);
+        }
+      }
+
+      if (bound.has_value() && item.kind == Item::Kind::Sprite &&
+          !same_rect(uv_source, item.source)) {
+        // uniforms apply to everything still queued, so draw that first
+        raylib::rlDrawRenderBatchActive();
+        set_uv_uniforms(*bound, item);
+        uv_source = item.source;
+      }
+      if (bound.has_value() && item.entity_uniforms) {
+        raylib::rlDrawRenderBatchActive();
+        library.set_uniform(*bound, UniformLocation::EntityColor,
+                            item.entity_color);
+        library.set_uniform(*bound, UniformLocation::WinnerRainbow,
+                            item.winner ? 1.0f : 0.0f);
+        library.set_uniform(*bound, UniformLocation::Speed, item.speed);
+      }
+
+      draw(item);
+    }
+    if (bound.has_value()) {
+      raylib::EndShaderMode();
+    }
+
+    items.clear();
+  }
+
+private:
+  struct Sorted {
+    uint64_t key;
+    uint32_t index;
+  };
+
+  std::vector<Sorted> sorted;
+  std::vector<Sorted> scratch;
+
+  // LSD radix sort on the key, one byte per pass. Passes where every key
+  // has the same byte (the high layer bits, mostly) are skipped.
+  void sort() {
+    const size_t n = items.size();
+    sorted.resize(n);
+    scratch.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      sorted[i] = Sorted{items[i].key, static_cast<uint32_t>(i)};
+    }
+    if (n < 2)
+      return;
+
+    for (int shift = 0; shift < 64; shift += 8) {
+      std::array<size_t, 257> offsets{};
+      for (const Sorted &s : sorted) {
+        offsets[((s.key >> shift) & 0xff) + 1]++;
+      }
+      if (offsets[((sorted[0].key >> shift) & 0xff) + 1] == n)
+        continue;
+      for (size_t b = 0; b < 256; b++) {
+        offsets[b + 1] += offsets[b];
+      }
+      for (const Sorted &s : sorted) {
+        scratch[offsets[(s.key >> shift) & 0xff]++] = s;
+      }
+      std::swap(sorted, scratch);
+    }
+  }
+
+  [[nodiscard]] size_t count_changes(bool in_sorted_order) const {
+    size_t changes = 0;
+    std::optional<ShaderType> shader;
+    unsigned int texture = 0;
+    for (size_t i = 0; i < items.size(); i++) {
+      const Item &item = items[in_sorted_order ? sorted[i].index : i];
+      if (item.shader != shader) {
+        shader = item.shader;
+        changes++;
+      }
+      if (item.texture.id != texture) {
+        texture = item.texture.id;
+        changes++;
+      }
+    }
+    return changes;
+  }
+
+  static bool same_rect(const std::optional<raylib::Rectangle> &a,
+                        const raylib::Rectangle &b) {
+    return a.has_value() && a->x == b.x && a->y == b.y &&
+           a->width == b.width && a->height == b.height;
+  }
+
+  static void set_uv_uniforms(ShaderType shader, const Item &item) {
+    auto &library = ShaderLibrary::get();
+    const float w = static_cast<float>(item.texture.width);
+    const float h = static_cast<float>(item.texture.height);
+    library.set_uniform(shader, UniformLocation::UvMin,
+                        vec2{item.source.x / w, item.source.y / h});
+    library.set_uniform(shader, UniformLocation::UvMax,
+                        vec2{(item.source.x + item.source.width) / w,
+                             (item.source.y + item.source.height) / h});
+  }
+
+  static void draw(const Item &item) {
+    switch (item.kind) {
+    case Item::Kind::Rect:
+      raylib::DrawRectanglePro(item.dest, item.origin, item.angle, item.tint);
+      break;
+    case Item::Kind::Sprite:
+      raylib::DrawTexturePro(item.texture, item.source, item.dest, item.origin,
+                             item.angle, item.tint);
+      break;
+    case Item::Kind::Custom:
+      item.draw();
+      break;
+    }
+  }
+};
+
+// Registered after the last world renderer that pushes into the DrawList and
+// before the ones that still draw directly (HUD, labels), so those stay on
+// top.
+struct SubmitDrawList : afterhours::System<> {
+  virtual void once(float) const override { DrawList::get().submit(); }
+};
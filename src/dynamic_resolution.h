@@ -0,0 +1,89 @@
+#pragma once
+
+#include "rl.h"
+#include <afterhours/src/singleton.h>
+#include <algorithm>
+#include <cmath>
+
+// Shrinks the world render target (mainRT) when frames run long, so slow
+// machines trade sharpness for frame rate. Only the world is affected: the
+// final PostFx pass stretches mainRT over the window, and the UI has its own
+// target (screenRT) at the full game resolution.
+//
+// The frame period (GetFrameTime) is all we can see; it covers the CPU work
+// and, through the buffer swap, the GPU. With vsync on it sits right at the
+// refresh interval whenever there is headroom, so there is no way to tell
+// how much headroom. Instead the scale drops one step as soon as the
+// smoothed period misses the target, and tries one step back up after it
+// has held the target for a while. Each drop doubles that wait, so a machine
+// that can't hold the higher step stops trying every couple of seconds; a
+// step up that holds the target through SETTLE_SECONDS resets it, so a few
+// early hitches don't slow recovery for the rest of the session.
+SINGLETON_FWD(DynamicResolution)
+struct DynamicResolution {
+  SINGLETON(DynamicResolution)
+
+  static constexpr float MIN_SCALE = 0.5f;
+  static constexpr float MAX_SCALE = 1.f;
+  // coarse, so mainRT is reallocated a handful of times at most
+  static constexpr float STEP = 0.1f;
+  static constexpr float SMOOTHING = 0.1f;
+  // missing the target by less than this doesn't count
+  static constexpr float SLACK = 1.1f;
+  // wait this long after a change before judging the new scale
+  static constexpr float SETTLE_SECONDS = 0.5f;
+  static constexpr float FIRST_PROBE_SECONDS = 2.f;
+  static constexpr float MAX_PROBE_SECONDS = 16.f;
+
+  bool enabled = false;
+  float target_ms = 1000.f / 60.f;
+  float scale = MAX_SCALE;
+
+  float avg_ms = 0.f;
+  float since_change = 0.f;
+  float probe_wait = FIRST_PROBE_SECONDS;
+  // the last change was a step up that hasn't been judged yet
+  bool probing = false;
+
+  void update(float dt) {
+    if (!enabled) {
+      scale = MAX_SCALE;
+      return;
+    }
+
+    const float frame_ms = dt * 1000.f;
+    avg_ms = avg_ms == 0.f ? frame_ms
+                           : avg_ms + ((frame_ms - avg_ms) * SMOOTHING);
+    since_change += dt;
+    if (since_change < SETTLE_SECONDS)
+      return;
+
+    const bool holding = avg_ms <= target_ms * SLACK;
+    if (!holding && scale > MIN_SCALE) {
+      set_scale(scale - STEP);
+      probe_wait = std::min(probe_wait * 2.f, MAX_PROBE_SECONDS);
+      return;
+    }
+    if (holding && probing) {
+      probing = false;
+      probe_wait = FIRST_PROBE_SECONDS;
+    }
+    if (holding && scale < MAX_SCALE && since_change >= probe_wait) {
+      set_scale(scale + STEP);
+      probing = true;
+    }
+  }
+
+  // Size of mainRT for a game resolution of width x height
+  [[nodiscard]] int scaled(int size) const {
+    return std::max(1, static_cast<int>(std::lround(size * scale)));
+  }
+
+private:
+  void set_scale(float next) {
+    // round to the step so repeated +/- doesn't drift
+    scale = std::clamp(std::round(next / STEP) * STEP, MIN_SCALE, MAX_SCALE);
+    since_change = 0.f;
+    probing = false;
+  }
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <afterhours/ah.h>
+#include <afterhours/src/singleton.h>
+#include <unordered_map>
+#include <vector>
+
+// id -> Entity* without walking EntityHelper::get_entities().
+//
+// The makers register what they create and PruneEntityIndex drops anything
+// flagged for cleanup right before EntityHelper::cleanup() frees it, so the
+// index is kept up to date incrementally rather than rebuilt. Outside a
+// system pass, free entities through cleanup_entities() instead of calling
+// EntityHelper::cleanup() directly; a slot that outlives its entity would be
+// read after free. Slots are
+// recycled; a Handle remembers the generation of the slot it was issued for
+// and stops resolving once the slot is reused.
+//
+// Entities that never went through a maker (plugin and UI entities) are
+// found with one scan on first lookup and indexed from then on. An id that
+// is gone scans every time it is looked up, so anything that can outlive
+// what it points at (trackers, projectile sources, the baked static layer)
+// keeps a Handle instead of an id.
+SINGLETON_FWD(EntityIndex)
+struct EntityIndex {
+  SINGLETON(EntityIndex)
+
+  struct Handle {
+    afterhours::EntityID id{-1};
+    uint32_t slot{0};
+    uint32_t generation{0};
+  };
+
+  struct Slot {
+    afterhours::Entity *entity = nullptr;
+    afterhours::EntityID id{-1};
+    uint32_t generation = 0;
+  };
+
+  std::vector<Slot> slots;
+  std::vector<uint32_t> free_slots;
+  std::unordered_map<afterhours::EntityID, uint32_t> slot_of;
+
+  Handle add(afterhours::Entity &entity) {
+    if (auto it = slot_of.find(entity.id); it != slot_of.end()) {
+      return handle_at(it->second);
+    }
+    uint32_t slot;
+    if (!free_slots.empty()) {
+      slot = free_slots.back();
+      free_slots.pop_back();
+    } else {
+      slot = static_cast<uint32_t>(slots.size());
+      slots.emplace_back();
+    }
+    Slot &s = slots[slot];
+    s.entity = &entity;
+    s.id = entity.id;
+    slot_of[entity.id] = slot;
+    return handle_at(slot);
+  }
+
+  void remove(afterhours::EntityID id) {
+    auto it = slot_of.find(id);
+    if (it == slot_of.end())
+      return;
+    Slot &s = slots[it->second];
+    s.entity = nullptr;
+    s.id = -1;
+    s.generation++;
+    free_slots.push_back(it->second);
+    slot_of.erase(it);
+  }
+
+  afterhours::Entity *find(afterhours::EntityID id) {
+    if (id < 0)
+      return nullptr;
+    if (auto it = slot_of.find(id); it != slot_of.end()) {
+      afterhours::Entity *entity = slots[it->second].entity;
+      return entity->cleanup ? nullptr : entity;
+    }
+    auto opt = afterhours::EntityQuery({.force_merge = true})
+                   .whereID(id)
+                   .gen_first();
+    if (!opt.valid()) {
+      return nullptr;
+    }
+    add(opt.asE());
+    return opt->cleanup ? nullptr : &opt.asE();
+  }
+
+  [[nodiscard]] bool contains(afterhours::EntityID id) {
+    return find(id) != nullptr;
+  }
+
+  Handle handle_for(afterhours::Entity &entity) { return add(entity); }
+
+  afterhours::Entity *resolve(const Handle &handle) const {
+    if (handle.id < 0 || handle.slot >= slots.size())
+      return nullptr;
+    const Slot &s = slots[handle.slot];
+    if (s.generation != handle.generation || s.id != handle.id)
+      return nullptr;
+    return s.entity->cleanup ? nullptr : s.entity;
+  }
+
+  // Forget everything that is about to be freed
+  void prune() {
+    for (uint32_t slot = 0; slot < slots.size(); slot++) {
+      const Slot &s = slots[slot];
+      if (s.entity && s.entity->cleanup)
+        remove(s.id);
+    }
+  }
+
+private:
+  [[nodiscard]] Handle handle_at(uint32_t slot) const {
+    return Handle{.id = slots[slot].id,
+                  .slot = slot,
+                  .generation = slots[slot].generation};
+  }
+};
+
+// EntityHelper::cleanup() for code that frees entities outside a
+// SystemManager pass (benchmarks, headless match teardown). Pruning in the
+// same call means no slot is ever left holding a freed entity for find() or
+// resolve() to read `cleanup` through.
+inline void cleanup_entities() {
+  EntityIndex::get().prune();
+  afterhours::EntityHelper::cleanup();
+}
+
+// Registered last in each pass, next to InvalidateSpatialIndex, since the
+// pass ends in EntityHelper::cleanup().
+struct PruneEntityIndex : afterhours::System<> {
+  virtual void once(float) override { EntityIndex::get().prune(); }
+};
@@ -0,0 +1,148 @@
+#include "headless.h"
+
+#include "game_state_manager.h"
+#include "makers.h"
+#include "map_system.h"
+#include "pressed_inputs.h"
+#include "profiler.h"
+#include "replay.h"
+#include "sim_clock.h"
+#include "spatial_index.h"
+#include "systems/systems.h"
+#include "systems/systems_ai.h"
+#include <afterhours/src/plugins/animation.h>
+
+using namespace afterhours;
+
+namespace {
+
+// Animations only exist to be looked at; without the texture_manager systems
+// nothing would ever finish them.
+struct DropHeadlessAnimations : System<texture_manager::HasAnimation> {
+  virtual void for_each_with(Entity &entity, texture_manager::HasAnimation &,
+                             float) override {
+    entity.cleanup = true;
+  }
+};
+
+} // namespace
+
+void register_simulation_systems(SystemManager &fixed) {
+  profiler::set_pass(fixed, profiler::Pass::Fixed);
+  profiler::register_update(
+      fixed, std::make_unique<SnapshotPreviousTransform>());
+  profiler::register_update(fixed, std::make_unique<AdvanceSimulationClock>());
+  profiler::register_update(fixed, std::make_unique<RebuildSpatialIndex>());
+  profiler::register_update(fixed, std::make_unique<ResolveCarAffectors>());
+  profiler::register_update(fixed, std::make_unique<VelFromInput>());
+  profiler::register_update(fixed, std::make_unique<ProcessBoostRequests>());
+  profiler::register_update(fixed, std::make_unique<BoostDecay>());
+  profiler::register_update(fixed, std::make_unique<Move>());
+  profiler::register_update(fixed, std::make_unique<UpdateProjectiles>());
+
+  // Move ran, refresh before anything queries overlaps
+  profiler::register_update(fixed, std::make_unique<RebuildSpatialIndex>());
+  profiler::register_update(fixed, std::make_unique<DetectContacts>());
+  profiler::register_update(fixed, std::make_unique<AISetActiveMode>());
+  profiler::register_update(
+      fixed, std::make_unique<AIUpdateAIParamsSystem>());
+  profiler::register_update(fixed, std::make_unique<Shoot>());
+  profiler::register_update(fixed, std::make_unique<MatchKartsToPlayers>());
+  profiler::register_update(
+      fixed, std::make_unique<ProcessProjectileDamage>());
+  profiler::register_update(
+      fixed, std::make_unique<ProcessCollisionAbsorption>());
+  profiler::register_update(
+      fixed, std::make_unique<ProcessProjectileAbsorption>());
+  profiler::register_update(fixed, std::make_unique<ProcessDeath>());
+  profiler::register_update(fixed, std::make_unique<SkidMarks>());
+  profiler::register_update(
+      fixed, std::make_unique<UpdateCollidingEntities>());
+  profiler::register_update(fixed, std::make_unique<WrapAroundTransform>());
+  profiler::register_update(fixed, std::make_unique<WrapProjectiles>());
+  profiler::register_update(fixed, std::make_unique<UpdateNavGrid>());
+  profiler::register_update(fixed, std::make_unique<ScheduleAIDecisions>());
+  profiler::register_update(fixed, std::make_unique<CaptureAISnapshot>());
+  profiler::register_update(fixed, std::make_unique<EvaluateAI>());
+  profiler::register_update(fixed, std::make_unique<ApplyAICommands>());
+  profiler::register_update(fixed, std::make_unique<WeaponCooldownSystem>());
+  profiler::register_update(fixed, std::make_unique<WeaponFireSystem>());
+  profiler::register_update(fixed, std::make_unique<ProjectileSpawnSystem>());
+  profiler::register_update(fixed, std::make_unique<WeaponRecoilSystem>());
+  profiler::register_update(fixed, std::make_unique<LatchWeaponSound>());
+  profiler::register_update(
+      fixed, std::make_unique<WeaponFiredCleanupSystem>());
+  profiler::register_update(fixed, std::make_unique<UpdateTrackingEntities>());
+  profiler::register_update(fixed, std::make_unique<CheckLivesWinFFA>());
+  profiler::register_update(fixed, std::make_unique<CheckLivesWinTeam>());
+  profiler::register_update(fixed, std::make_unique<CheckKillsWinFFA>());
+  profiler::register_update(fixed, std::make_unique<CheckKillsWinTeam>());
+  profiler::register_update(fixed, std::make_unique<CheckHippoWinFFA>());
+  profiler::register_update(fixed, std::make_unique<CheckHippoWinTeam>());
+  profiler::register_update(fixed, std::make_unique<CheckTagAndGoWinFFA>());
+  profiler::register_update(fixed, std::make_unique<CheckTagAndGoWinTeam>());
+
+  profiler::register_update(fixed, std::make_unique<ProcessHippoCollection>());
+  profiler::register_update(fixed, std::make_unique<SpawnHippoItems>());
+  profiler::register_update(fixed, std::make_unique<InitializeTagAndGoGame>());
+  profiler::register_update(fixed, std::make_unique<UpdateTagAndGoTimers>());
+  profiler::register_update(fixed, std::make_unique<UpdateRoundCountdown>());
+  profiler::register_update(
+      fixed, std::make_unique<HandleTagAndGoTagTransfer>());
+  profiler::register_update(fixed, std::make_unique<ScaleTaggerSize>());
+
+  // each step ends in EntityHelper::cleanup() as well
+  profiler::register_update(fixed, std::make_unique<InvalidateSpatialIndex>());
+  profiler::register_update(fixed, std::make_unique<ClearContacts>());
+  profiler::register_update(fixed, std::make_unique<InvalidateQueryCache>());
+  profiler::register_update(fixed, std::make_unique<PruneEntityIndex>());
+  profiler::register_update(fixed, std::make_unique<ConsumePressedInputs>());
+  profiler::end_updates(fixed);
+}
+
+void apply_ai_tables(SystemManager &fixed_systems, float dt) {
+  GameStateManager::get().set_screen(
+      GameStateManager::Screen::CharacterCreation);
+  fixed_systems.run(dt);
+}
+
+void start_headless_round(int map_index) {
+  MapManager::get().set_selected_map(map_index);
+  MapManager::get().create_map();
+  GameStateManager::get().start_game();
+}
+
+void end_headless_match() {
+  auto *colors = EntityHelper::get_singleton_cmp<ManagesAvailableColors>();
+  for (Entity &entity : EntityQuery({.force_merge = true})
+                            .whereHasComponent<Transform>()
+                            .gen()) {
+    if (colors && entity.has<AIControlled>()) {
+      colors->release_only(static_cast<size_t>(entity.id));
+    }
+    entity.cleanup = true;
+  }
+  QueryCache::get().invalidate();
+  cleanup_entities();
+  ProjectilePool::get().clear();
+  GameStateManager::get().current_state = GameStateManager::GameState::Menu;
+}
+
+void register_headless_systems(SystemManager &fixed_systems,
+                               SystemManager &systems, bool replaying) {
+  profiler::label_update(systems, "input plugin");
+  input::register_update_systems(systems);
+  profiler::register_update(systems, std::make_unique<LatchPressedInputs>());
+  // replaces what was latched with the recorded presses
+  if (replaying) {
+    profiler::register_update(systems,
+                              std::make_unique<replay::ReplayInput>());
+  }
+  register_simulation_systems(fixed_systems);
+  profiler::register_update(
+      systems, std::make_unique<DropHeadlessAnimations>());
+  profiler::register_update(systems, std::make_unique<InvalidateQueryCache>());
+  profiler::register_update(systems, std::make_unique<PruneEntityIndex>());
+  profiler::end_updates(systems);
+}
+
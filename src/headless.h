@@ -0,0 +1,32 @@
+#pragma once
+
+#include <afterhours/ah.h>
+
+// Running the game's simulation without a window: what --headless, --replay
+// and tools/tournament.cpp share with the windowed game.
+
+// Gameplay systems shared by the windowed game and every headless run.
+// Nothing registered here may touch the window, GL context or audio device.
+//
+// All of them are stepped by SimulationClock at a constant rate no matter how
+// fast frames come in (see step_simulation), so a frame only ever renders,
+// and blends between the last two steps.
+void register_simulation_systems(afterhours::SystemManager &fixed);
+
+// The above, plus the per-frame pass a run without a window still needs:
+// input and freeing what only exists to be looked at
+void register_headless_systems(afterhours::SystemManager &fixed_systems,
+                               afterhours::SystemManager &systems,
+                               bool replaying);
+
+// AIUpdateAIParamsSystem only applies the difficulty tables while the
+// character creation screen is up, so this gives it one tick there. Set each
+// AIDifficulty before, and change AIParams after if they shouldn't be the
+// tables.
+void apply_ai_tables(afterhours::SystemManager &fixed_systems, float dt);
+
+// Builds the map and starts the round on the karts made so far
+void start_headless_round(int map_index);
+
+// Frees the karts, the map and the shots, ready for the next match
+void end_headless_match();
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <afterhours/src/singleton.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A few worker threads for splitting one loop across cores.
+//
+// rfc_worker_threads.md is why this is so narrow: running whole systems on
+// another thread raced with the main thread over the entities. Jobs here
+// never see the ECS or raylib. The caller copies what they need out first,
+// each index writes only its own output slot, and parallel_for doesn't
+// return until every index is done, so the main thread picks the results
+// up with nothing else running.
+SINGLETON_FWD(JobPool)
+struct JobPool {
+  SINGLETON(JobPool)
+
+  static constexpr unsigned MAX_WORKERS = 7;
+  // Read once, by the first get(). tools/tournament.cpp already keeps every
+  // core busy with a match each and sets it to 0.
+  inline static unsigned worker_limit = MAX_WORKERS;
+
+  JobPool() {
+    const unsigned cores = std::thread::hardware_concurrency();
+    const unsigned count = cores > 1 ? std::min(cores - 1, worker_limit) : 0;
+    for (unsigned i = 0; i < count; i++) {
+      workers.emplace_back([this]() { run(); });
+    }
+  }
+
+  ~JobPool() {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+  }
+
+  JobPool(const JobPool &) = delete;
+  JobPool &operator=(const JobPool &) = delete;
+
+  [[nodiscard]] size_t threads() const { return workers.size() + 1; }
+
+  // Calls fn(i) for every i in [0, count), on the workers and the calling
+  // thread, and returns once all of them have finished
+  void parallel_for(size_t count, const std::function<void(size_t)> &fn) {
+    if (workers.empty() || count < 2) {
+      for (size_t i = 0; i < count; i++) {
+        fn(i);
+      }
+      return;
+    }
+
+    {
+      std::lock_guard lock(mutex);
+      job = &fn;
+      job_count = count;
+      next = 0;
+      done = 0;
+      generation++;
+    }
+    wake.notify_all();
+    work();
+
+    std::unique_lock lock(mutex);
+    finished.wait(lock, [&]() { return done == job_count && active == 0; });
+    // a worker that wakes up late sees no job instead of a dangling one
+    job = nullptr;
+    job_count = 0;
+  }
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+
+  const std::function<void(size_t)> *job = nullptr;
+  size_t job_count = 0;
+  size_t generation = 0;
+  size_t active = 0;
+  bool stopping = false;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+
+  void work() {
+    size_t i = 0;
+    while ((i = next.fetch_add(1)) < job_count) {
+      (*job)(i);
+      if (done.fetch_add(1) + 1 == job_count) {
+        std::lock_guard lock(mutex);
+        finished.notify_one();
+      }
+    }
+  }
+
+  void run() {
+    size_t seen = 0;
+    std::unique_lock lock(mutex);
+    while (true) {
+      wake.wait(lock, [&]() { return stopping || generation != seen; });
+      if (stopping)
+        return;
+      seen = generation;
+      if (!job)
+        continue;
+      active++;
+      lock.unlock();
+      work();
+      lock.lock();
+      active--;
+      finished.notify_one();
+    }
+  }
+};
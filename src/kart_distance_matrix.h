@@ -0,0 +1,136 @@
+#pragma once
+
+#include "ai_snapshot.h"
+#include "components.h"
+#include "query_cache.h"
+#include <afterhours/src/singleton.h>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+// Squared distance and unit direction between every pair of karts, worked
+// out once per frame for the AI (CaptureAISnapshot builds it, in the same
+// kart order as AISnapshot::karts).
+//
+// lives_ai_target scored each candidate by how far it was from every other
+// kart, for every AI: N^3 distance checks a frame. kills_ai_target and
+// AIShoot each walked the karts again on their own. Now the per-kart
+// "distance from everyone" sum is a column of this matrix, and the AI
+// systems only read rows.
+//
+// Stored as flat float arrays (struct of arrays) with rows padded to a
+// multiple of 8, so the build loop is straight-line float math the compiler
+// can vectorize.
+SINGLETON_FWD(KartDistanceMatrix)
+struct KartDistanceMatrix {
+  SINGLETON(KartDistanceMatrix)
+
+  // Past this (squared) distance a kart counts as fully "away" from another
+  // when the Lives AI scores avoidance
+  static constexpr float AVOIDANCE_RANGE_SQ = 10000.f;
+  // closer than this (squared) there is no meaningful direction
+  static constexpr float SAME_SPOT_SQ = 0.001f * 0.001f;
+  static constexpr size_t ROW_ALIGN = 8;
+
+  size_t count = 0;
+  size_t stride = 0;
+  std::vector<afterhours::EntityID> ids;
+  // 1 for karts with a PlayerID (human controlled)
+  std::vector<uint8_t> human;
+  std::vector<float> x;
+  std::vector<float> y;
+
+  // [i * stride + j]; dir is the unit vector from i toward j, zero when they
+  // are on the same spot
+  std::vector<float> dist_sq;
+  std::vector<float> dir_x;
+  std::vector<float> dir_y;
+
+  // per kart: sum over the others of min(dist_sq / AVOIDANCE_RANGE_SQ, 1)
+  std::vector<float> avoidance;
+
+  void build(const QueryCache::Refs &karts) {
+    resize(karts.size());
+    for (size_t i = 0; i < count; i++) {
+      const afterhours::Entity &kart = karts[i].get();
+      ids[i] = kart.id;
+      human[i] = kart.has<PlayerID>() ? 1 : 0;
+      const vec2 pos = kart.get<Transform>().pos();
+      x[i] = pos.x;
+      y[i] = pos.y;
+    }
+    compute();
+  }
+
+  // Same, from karts already copied out of the ECS
+  void build(const std::vector<AIKart> &karts) {
+    resize(karts.size());
+    for (size_t i = 0; i < count; i++) {
+      ids[i] = karts[i].id;
+      human[i] = karts[i].human ? 1 : 0;
+      x[i] = karts[i].pos.x;
+      y[i] = karts[i].pos.y;
+    }
+    compute();
+  }
+
+  // Row of `entity`, nullopt if it wasn't a kart when the matrix was built
+  [[nodiscard]] std::optional<size_t>
+  slot_of(const afterhours::Entity &entity) const {
+    const auto it = std::ranges::find(ids, entity.id);
+    if (it == ids.end())
+      return std::nullopt;
+    return static_cast<size_t>(it - ids.begin());
+  }
+
+  [[nodiscard]] float distance_sq(size_t i, size_t j) const {
+    return dist_sq[(i * stride) + j];
+  }
+
+  [[nodiscard]] vec2 direction(size_t i, size_t j) const {
+    return vec2{dir_x[(i * stride) + j], dir_y[(i * stride) + j]};
+  }
+
+  [[nodiscard]] vec2 position(size_t i) const { return vec2{x[i], y[i]}; }
+
+private:
+  void resize(size_t n) {
+    count = n;
+    stride = ((count + ROW_ALIGN - 1) / ROW_ALIGN) * ROW_ALIGN;
+    ids.resize(count);
+    human.resize(count);
+    x.assign(stride, 0.f);
+    y.assign(stride, 0.f);
+  }
+
+  void compute() {
+    dist_sq.assign(stride * count, 0.f);
+    dir_x.assign(stride * count, 0.f);
+    dir_y.assign(stride * count, 0.f);
+    avoidance.assign(count, 0.f);
+
+    constexpr float inv_range = 1.f / AVOIDANCE_RANGE_SQ;
+    for (size_t i = 0; i < count; i++) {
+      const float xi = x[i];
+      const float yi = y[i];
+      float *d2_row = &dist_sq[i * stride];
+      float *dx_row = &dir_x[i * stride];
+      float *dy_row = &dir_y[i * stride];
+      float away = 0.f;
+      // no branches on j, so this stays one vector loop; the i == j term
+      // is zero on its own
+      for (size_t j = 0; j < count; j++) {
+        const float dx = x[j] - xi;
+        const float dy = y[j] - yi;
+        const float d2 = (dx * dx) + (dy * dy);
+        const float inv = d2 > SAME_SPOT_SQ ? 1.f / std::sqrt(d2) : 0.f;
+        d2_row[j] = d2;
+        dx_row[j] = dx * inv;
+        dy_row[j] = dy * inv;
+        away += std::min(d2 * inv_range, 1.f);
+      }
+      avoidance[i] = away;
+    }
+  }
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "rl.h"
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// A label's text laid out against a font once, so later frames draw the
+// glyph quads directly instead of decoding the UTF-8 and looking every
+// codepoint up in the font again. Same layout as raylib's DrawTextEx.
+struct GlyphRun {
+  struct Quad {
+    raylib::Rectangle source;
+    // relative to the label position
+    raylib::Rectangle dest;
+  };
+  std::vector<Quad> quads;
+  unsigned int font_texture = 0;
+  float font_size = 0.f;
+
+  [[nodiscard]] bool matches(const raylib::Font &font, float size) const {
+    return font_texture == font.texture.id && font_size == size;
+  }
+
+  void shape(const raylib::Font &font, std::string_view text, float size,
+             float spacing) {
+    quads.clear();
+    font_texture = font.texture.id;
+    font_size = size;
+    if (font.baseSize <= 0 || font.glyphs == nullptr)
+      return;
+
+    const float scale = size / static_cast<float>(font.baseSize);
+    const float pad = static_cast<float>(font.glyphPadding);
+    float x = 0.f;
+    size_t i = 0;
+    while (i < text.size()) {
+      int bytes = 0;
+      const int codepoint = raylib::GetCodepointNext(text.data() + i, &bytes);
+      i += static_cast<size_t>(bytes > 0 ? bytes : 1);
+      const int index = raylib::GetGlyphIndex(font, codepoint);
+      const raylib::Rectangle rec = font.recs[index];
+      const raylib::GlyphInfo &glyph = font.glyphs[index];
+
+      if (codepoint != ' ' && codepoint != '\t') {
+        quads.push_back(Quad{
+            raylib::Rectangle{rec.x - pad, rec.y - pad,
+                              rec.width + (2.f * pad),
+                              rec.height + (2.f * pad)},
+            raylib::Rectangle{x + ((glyph.offsetX - pad) * scale),
+                              (glyph.offsetY - pad) * scale,
+                              (rec.width + (2.f * pad)) * scale,
+                              (rec.height + (2.f * pad)) * scale},
+        });
+      }
+      x += (glyph.advanceX == 0 ? rec.width
+                                : static_cast<float>(glyph.advanceX)) *
+               scale +
+           spacing;
+    }
+  }
+
+  void draw(const raylib::Font &font, vec2 pos, raylib::Color tint) const {
+    for (const Quad &q : quads) {
+      raylib::DrawTexturePro(font.texture, q.source,
+                             raylib::Rectangle{pos.x + q.dest.x,
+                                               pos.y + q.dest.y, q.dest.width,
+                                               q.dest.height},
+                             vec2{0.f, 0.f}, 0.f, tint);
+    }
+  }
+};
+
+// What a LabelInfo showed last frame. Numbers are compared after rounding
+// to the precision they are printed with, so the run is only reshaped when
+// the text on screen would actually change.
+struct LabelCache {
+  // labels print one decimal
+  static constexpr float PRECISION = 10.f;
+
+  bool valid = false;
+  int64_t value = 0;
+  bool negative = false;
+  GlyphRun run;
+
+  [[nodiscard]] static int64_t quantize(float v) {
+    return static_cast<int64_t>(std::llround(v * PRECISION));
+  }
+};
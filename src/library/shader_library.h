@@ -5,6 +5,7 @@
 #include <afterhours/src/singleton.h>
 
 #include "../rl.h"
+#include <array>
 #include <string>
 #include <unordered_map>
 
@@ -19,6 +20,21 @@ struct ShaderLibrary {
   std::unordered_map<ShaderType, std::unordered_map<UniformLocation, int>>
       uniform_locations;
 
+  // Last value uploaded to each uniform. A shader keeps its uniforms while
+  // it is not bound, so the set_uniform() calls below only reach the GPU when
+  // the value changed. This only holds if every write goes through them:
+  // don't SetShaderValue() a library shader directly.
+  using UniformValue = std::array<float, 4>;
+  std::unordered_map<ShaderType,
+                     std::unordered_map<UniformLocation, UniformValue>>
+      uniform_values;
+
+  // Running totals; the profiler overlay shows them per frame
+  struct UniformStats {
+    size_t uploads = 0;
+    size_t skips = 0;
+  } uniform_stats;
+
   // Load all shaders at startup using magic_enum
   void load_all_shaders() {
     // Use magic_enum to automatically load all shader types
@@ -54,6 +70,40 @@ struct ShaderLibrary {
     return uniform_it->second;
   }
 
+  // Typed uniform setters. Return false if the shader has no such uniform
+  // (or it was optimized out), like a -1 location.
+  bool set_uniform(ShaderType type, UniformLocation uniform, float value) {
+    return upload(type, uniform, {value, 0.f, 0.f, 0.f},
+                  raylib::SHADER_UNIFORM_FLOAT);
+  }
+
+  bool set_uniform(ShaderType type, UniformLocation uniform, vec2 value) {
+    return upload(type, uniform, {value.x, value.y, 0.f, 0.f},
+                  raylib::SHADER_UNIFORM_VEC2);
+  }
+
+  // Colors go up normalized, as a vec4
+  bool set_uniform(ShaderType type, UniformLocation uniform,
+                   raylib::Color value) {
+    return upload(type, uniform,
+                  {value.r / 255.f, value.g / 255.f, value.b / 255.f,
+                   value.a / 255.f},
+                  raylib::SHADER_UNIFORM_VEC4);
+  }
+
+  // time and resolution, which nearly every shader here declares
+  void set_common_uniforms(ShaderType type) {
+    set_uniform(type, UniformLocation::Time,
+                static_cast<float>(raylib::GetTime()));
+    auto *rez = afterhours::EntityHelper::get_singleton_cmp<
+        afterhours::window_manager::ProvidesCurrentResolution>();
+    if (rez) {
+      set_uniform(type, UniformLocation::Resolution,
+                  vec2{static_cast<float>(rez->current_resolution.width),
+                       static_cast<float>(rez->current_resolution.height)});
+    }
+  }
+
   // Check if shader exists
   [[nodiscard]] bool contains(ShaderType type) const {
     return shaders_by_type.find(type) != shaders_by_type.end();
@@ -68,9 +118,28 @@ struct ShaderLibrary {
   void unload_all() {
     shaders_by_type.clear();
     uniform_locations.clear();
+    uniform_values.clear();
   }
 
 private:
+  bool upload(ShaderType type, UniformLocation uniform,
+              const UniformValue &value, int uniform_type) {
+    const int loc = get_uniform_location(type, uniform);
+    if (loc == -1)
+      return false;
+
+    auto &values = uniform_values[type];
+    auto it = values.find(uniform);
+    if (it != values.end() && it->second == value) {
+      uniform_stats.skips++;
+      return true;
+    }
+    raylib::SetShaderValue(get(type), loc, value.data(), uniform_type);
+    values[uniform] = value;
+    uniform_stats.uploads++;
+    return true;
+  }
+
   void load_shader(ShaderType type) {
     // Use magic_enum to automatically convert enum name to filename
     std::string enum_name = std::string(magic_enum::enum_name(type));
@@ -82,6 +151,8 @@ private:
     raylib::Shader shader =
         raylib::LoadShader(vert_path.c_str(), frag_path.c_str());
     shaders_by_type[type] = shader;
+    // a reloaded shader starts from its defaults again
+    uniform_values.erase(type);
 
     // Cache uniform locations for this shader
     cache_uniform_locations(type, shader);
@@ -101,18 +172,6 @@ private:
         raylib::GetShaderLocation(shader, UniformNames::SPEED);
     locations[UniformLocation::WinnerRainbow] =
         raylib::GetShaderLocation(shader, UniformNames::WINNER_RAINBOW);
-    locations[UniformLocation::SpotlightEnabled] =
-        raylib::GetShaderLocation(shader, UniformNames::SPOTLIGHT_ENABLED);
-    locations[UniformLocation::SpotlightPos] =
-        raylib::GetShaderLocation(shader, UniformNames::SPOTLIGHT_POS);
-    locations[UniformLocation::SpotlightRadius] =
-        raylib::GetShaderLocation(shader, UniformNames::SPOTLIGHT_RADIUS);
-    locations[UniformLocation::SpotlightSoftness] =
-        raylib::GetShaderLocation(shader, UniformNames::SPOTLIGHT_SOFTNESS);
-    locations[UniformLocation::DimAmount] =
-        raylib::GetShaderLocation(shader, UniformNames::DIM_AMOUNT);
-    locations[UniformLocation::DesaturateAmount] =
-        raylib::GetShaderLocation(shader, UniformNames::DESATURATE_AMOUNT);
     locations[UniformLocation::UvMin] =
         raylib::GetShaderLocation(shader, UniformNames::UV_MIN);
     locations[UniformLocation::UvMax] =
@@ -124,40 +183,13 @@ struct UpdateShaderValues : afterhours::System<> {
   virtual void once(float) override {
     // Update shader values for all active shaders
     // This system runs once per frame to update global shader uniforms
-
-    auto *resolution_provider = afterhours::EntityHelper::get_singleton_cmp<
-        afterhours::window_manager::ProvidesCurrentResolution>();
-    if (!resolution_provider) {
-      return;
-    }
-
-    const auto &resolution = resolution_provider->current_resolution;
-    const float current_time = static_cast<float>(raylib::GetTime());
-
-    // Update all shaders with current time and resolution
+    auto &library = ShaderLibrary::get();
     constexpr auto shader_types = magic_enum::enum_values<ShaderType>();
     for (auto shader_type : shader_types) {
-      if (!ShaderLibrary::get().contains(shader_type)) {
+      if (!library.contains(shader_type)) {
         continue;
       }
-
-      const auto &shader = ShaderLibrary::get().get(shader_type);
-
-      // Update time uniform if available
-      int time_loc = raylib::GetShaderLocation(shader, "time");
-      if (time_loc != -1) {
-        raylib::SetShaderValue(shader, time_loc, &current_time,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-
-      // Update resolution uniform if available
-      int res_loc = raylib::GetShaderLocation(shader, "resolution");
-      if (res_loc != -1) {
-        vec2 res_vec = {static_cast<float>(resolution.width),
-                        static_cast<float>(resolution.height)};
-        raylib::SetShaderValue(shader, res_loc, &res_vec,
-                               raylib::SHADER_UNIFORM_VEC2);
-      }
+      library.set_common_uniforms(shader_type);
     }
   }
 };
@@ -8,12 +8,20 @@ backward::SignalHandling sh;
 
 #include "game.h"
 #include "e2e_integration.h"
+#include "headless.h"
 #include "./ui/navigation.h"
 #include "argh.h"
+#include "benchmarks.h"
+#include "dynamic_resolution.h"
 #include "map_system.h"
 #include "mcp_integration.h"
 #include "preload.h"
+#include "pressed_inputs.h"
+#include "profiler.h"
+#include "replay.h"
 #include "settings.h"
+#include "sim_clock.h"
+#include "spatial_index.h"
 #include <afterhours/src/plugins/settings.h>
 #include "systems/sound_systems.h"
 #include "systems/systems.h"
@@ -23,6 +31,7 @@ backward::SignalHandling sh;
 #include <afterhours/src/plugins/animation.h>
 #include <afterhours/src/plugins/camera.h>
 #include <afterhours/src/plugins/files.h>
+#include <chrono>
 
 // TODO add honking
 
@@ -36,6 +45,17 @@ using namespace afterhours;
 // From intro.cpp
 void intro();
 
+// Runs as many fixed steps as the frame time has paid for; whatever is left
+// over becomes SimulationClock::alpha for the renderers.
+static int step_simulation(SystemManager &fixed, float frame_dt) {
+  auto &clock = SimulationClock::get();
+  const int steps = clock.begin_frame(frame_dt);
+  for (int i = 0; i < steps; i++) {
+    fixed.run(clock.fixed_dt);
+  }
+  return steps;
+}
+
 void game() {
   mainRT = raylib::LoadRenderTexture(Settings::get_screen_width(),
                                      Settings::get_screen_height());
@@ -43,6 +63,7 @@ void game() {
                                        Settings::get_screen_height());
 
   SystemManager systems;
+  SystemManager fixed_systems;
 
   // debug systems
   {
@@ -59,151 +80,127 @@ void game() {
 
   // external plugins
   {
+    profiler::label_update(systems, "input plugin");
     input::register_update_systems(systems);
+    profiler::label_update(systems, "mcp_integration");
     mcp_integration::register_systems(systems);
+    // after everything that adds presses (mcp injects its own)
+    profiler::register_update(systems, std::make_unique<LatchPressedInputs>());
+    profiler::label_update(systems, "window_manager plugin");
     window_manager::register_update_systems(systems);
+    profiler::label_update(systems, "sound_system plugin");
     sound_system::register_update_systems(systems);
   }
 
-  // Fixed update
-  {
-    systems.register_fixed_update_system(std::make_unique<VelFromInput>());
-    systems.register_fixed_update_system(
-        std::make_unique<ProcessBoostRequests>());
-    systems.register_fixed_update_system(std::make_unique<BoostDecay>());
-    systems.register_fixed_update_system(std::make_unique<Move>());
-  }
+  bool create_startup = true;
+  profiler::register_update(systems, "startup", [&](float) {
+    if (create_startup) {
+      make_player(0);
+      // TODO id love to have this but its hard to read the UI
+      // because the racing lines and stuff go over it
+      // MapManager::get().create_map();
+      // make_ai();
+      // make_ai();
+
+      create_startup = false;
+    }
+  });
+
+  register_simulation_systems(fixed_systems);
 
   // normal update
   {
-    bool create_startup = true;
-    systems.register_update_system([&](float) {
-      if (create_startup) {
-        make_player(0);
-        // TODO id love to have this but its hard to read the UI
-        // because the racing lines and stuff go over it
-        // MapManager::get().create_map();
-        // make_ai();
-        // make_ai();
-
-        create_startup = false;
-      }
-    });
-    systems.register_update_system(std::make_unique<AISetActiveMode>());
-    systems.register_update_system(std::make_unique<AIUpdateAIParamsSystem>());
-    systems.register_update_system(std::make_unique<Shoot>());
-    systems.register_update_system(std::make_unique<MatchKartsToPlayers>());
-    systems.register_update_system(std::make_unique<ProcessDamage>());
-    systems.register_update_system(
-        std::make_unique<ProcessCollisionAbsorption>());
-    systems.register_update_system(std::make_unique<ProcessDeath>());
-    systems.register_update_system(std::make_unique<SkidMarks>());
-    systems.register_update_system(std::make_unique<UpdateCollidingEntities>());
-    systems.register_update_system(std::make_unique<WrapAroundTransform>());
-    systems.register_update_system(
-        std::make_unique<UpdateColorBasedOnEntityID>());
-    systems.register_update_system(std::make_unique<AITargetSelection>());
-    systems.register_update_system(std::make_unique<AIVelocity>());
-    systems.register_update_system(std::make_unique<AIShoot>());
-    systems.register_update_system(std::make_unique<WeaponCooldownSystem>());
-    systems.register_update_system(std::make_unique<WeaponFireSystem>());
-    systems.register_update_system(std::make_unique<ProjectileSpawnSystem>());
-    systems.register_update_system(std::make_unique<WeaponRecoilSystem>());
-    systems.register_update_system(std::make_unique<WeaponSoundSystem>());
-    systems.register_update_system(
-        std::make_unique<WeaponFiredCleanupSystem>());
-    systems.register_update_system(std::make_unique<DrainLife>());
-    systems.register_update_system(std::make_unique<UpdateTrackingEntities>());
-    systems.register_update_system(std::make_unique<CheckLivesWinFFA>());
-    systems.register_update_system(std::make_unique<CheckLivesWinTeam>());
-    systems.register_update_system(std::make_unique<CheckKillsWinFFA>());
-    systems.register_update_system(std::make_unique<CheckKillsWinTeam>());
-    systems.register_update_system(std::make_unique<CheckHippoWinFFA>());
-    systems.register_update_system(std::make_unique<CheckHippoWinTeam>());
-    systems.register_update_system(std::make_unique<CheckTagAndGoWinFFA>());
-    systems.register_update_system(std::make_unique<CheckTagAndGoWinTeam>());
-
-    systems.register_update_system(std::make_unique<ProcessHippoCollection>());
-    systems.register_update_system(std::make_unique<SpawnHippoItems>());
-    systems.register_update_system(std::make_unique<InitializeTagAndGoGame>());
-    systems.register_update_system(std::make_unique<UpdateTagAndGoTimers>());
-    systems.register_update_system(std::make_unique<UpdateRoundCountdown>());
-    systems.register_update_system(
-        std::make_unique<HandleTagAndGoTagTransfer>());
-    systems.register_update_system(std::make_unique<ScaleTaggerSize>());
-
-    systems.register_update_system(std::make_unique<UpdateSpriteTransform>());
-    systems.register_update_system(std::make_unique<UpdateShaderValues>());
-    systems.register_update_system(
-        std::make_unique<UpdateAnimationTransform>());
-    systems.register_update_system(std::make_unique<MarkEntitiesWithShaders>());
-    systems.register_update_system(std::make_unique<ApplyWinnerShader>());
+    profiler::register_update(systems, std::make_unique<WeaponSoundSystem>());
+    profiler::register_update(
+        systems, std::make_unique<UpdateSpriteTransform>());
+    profiler::register_update(systems, std::make_unique<UpdateShaderValues>());
+    profiler::register_update(
+        systems, std::make_unique<UpdateAnimationTransform>());
+    profiler::register_update(
+        systems, std::make_unique<MarkEntitiesWithShaders>());
+    profiler::register_update(systems, std::make_unique<ApplyWinnerShader>());
+    profiler::label_update(systems, "texture_manager plugin");
     texture_manager::register_update_systems(systems);
 
-    // Initialize map previews
-    systems.register_update_system([](float) {
-      static bool initialized = false;
-
-      if (!initialized) {
-        MapManager::get().initialize_preview_textures();
-        initialized = true;
-      }
-    });
-
+    profiler::label_update(systems, "ui");
     register_ui_systems(systems);
+    profiler::label_update(systems, "e2e_integration");
     e2e_integration::register_systems(systems);
 
-    systems.register_update_system(std::make_unique<UpdateRenderTexture>());
-    systems.register_update_system(std::make_unique<MarkEntitiesWithShaders>());
+    profiler::register_update(systems, std::make_unique<UpdateRenderTexture>());
+    profiler::register_update(
+        systems, std::make_unique<MarkEntitiesWithShaders>());
+    // the last fixed step dropped its index; the culling needs one
+    profiler::register_update(systems, std::make_unique<RebuildSpatialIndex>());
+    profiler::register_update(systems, std::make_unique<CollectVisibleSet>());
+    profiler::register_update(
+        systems, std::make_unique<InvalidateSpatialIndex>());
+    profiler::register_update(
+        systems, std::make_unique<InvalidateQueryCache>());
+    profiler::register_update(systems, std::make_unique<PruneEntityIndex>());
+    profiler::end_updates(systems);
 
     // renders
     {
-      systems.register_render_system(std::make_unique<BeginWorldRender>());
+      profiler::register_render(systems, std::make_unique<StampSkidMarks>());
+      profiler::register_render(
+          systems, std::make_unique<BakeStaticMapLayer>());
+      profiler::register_render(systems, std::make_unique<BeginWorldRender>());
 
       {
+        profiler::label_render(systems, "begin camera");
         camera::register_begin_camera(systems);
-        systems.register_render_system(std::make_unique<RenderSkid>());
-        systems.register_render_system(std::make_unique<RenderEntities>());
+        profiler::register_render(systems, std::make_unique<RenderSkid>());
+        profiler::register_render(
+            systems, std::make_unique<RenderStaticMapLayer>());
+        profiler::register_render(systems, std::make_unique<RenderEntities>());
+        profiler::register_render(
+            systems, std::make_unique<RenderProjectiles>());
+        // draws right away, so under the DrawList; it only gets sprites
+        // without a shader (MarkEntitiesWithShaders), which karts are not
+        profiler::label_render(systems, "texture_manager plugin");
         texture_manager::register_render_systems(systems);
-        systems.register_render_system(
-            std::make_unique<RenderSpritesWithShaders>());
-        systems.register_render_system(
-            std::make_unique<RenderAnimationsWithShaders>());
+        profiler::register_render(
+            systems, std::make_unique<RenderSpritesWithShaders>());
+        profiler::register_render(
+            systems, std::make_unique<RenderAnimationsWithShaders>());
+        profiler::register_render(
+            systems, std::make_unique<RenderWeaponCooldown>());
+        // everything above only queued its draws; sort and draw them now
+        profiler::register_render(systems, std::make_unique<SubmitDrawList>());
         //
-        systems.register_render_system(std::make_unique<RenderPlayerHUD>());
-        systems.register_render_system(std::make_unique<RenderLabels>());
-        systems.register_render_system(
-            std::make_unique<RenderWeaponCooldown>());
-        systems.register_render_system(std::make_unique<RenderOOB>());
+        profiler::register_render(systems, std::make_unique<RenderPlayerHUD>());
+        profiler::register_render(systems, std::make_unique<RenderLabels>());
+        profiler::register_render(systems, std::make_unique<RenderOOB>());
+        profiler::label_render(systems, "end camera");
         camera::register_end_camera(systems);
-        // (UI moved to pass 2 so it is after tag shader)
+        // (UI is drawn in pass 2, outside the world camera)
       }
-      systems.register_render_system(std::make_unique<EndWorldRender>());
-      // pass 2: render mainRT with tag shader into screenRT, then draw UI into
-      // screenRT
-      systems.register_render_system(
-          std::make_unique<ConfigureTaggerSpotlight>());
-      systems.register_render_system(std::make_unique<BeginTagShaderRender>());
-      // render UI into screenRT (still in texture mode)
-      systems.register_render_system(std::make_unique<RenderWeaponHUD>());
+      profiler::register_render(systems, std::make_unique<EndWorldRender>());
+      // pass 2: UI into screenRT, over a transparent clear
+      profiler::register_render(
+          systems, std::make_unique<ConfigureTaggerSpotlight>());
+      profiler::register_render(systems, std::make_unique<BeginUIRender>());
+      profiler::register_render(systems, std::make_unique<RenderWeaponHUD>());
+      profiler::label_render(systems, "ui");
       ui::register_render_systems<InputAction>(
           systems, InputAction::ToggleUILayoutDebug);
-      systems.register_render_system(std::make_unique<EndTagShaderRender>());
-      // pass 3: draw to screen with base post-processing shader
-      systems.register_render_system(
-          std::make_unique<BeginPostProcessingRender>());
-      systems.register_render_system(
-          std::make_unique<SetupPostProcessingShader>());
-
-      systems.register_render_system(std::make_unique<RenderScreenToWindow>());
-      systems.register_render_system(
-          std::make_unique<EndPostProcessingShader>());
-      systems.register_render_system(std::make_unique<RenderLetterboxBars>());
-      systems.register_render_system(std::make_unique<RenderRoundTimer>());
-      systems.register_render_system(std::make_unique<RenderFPS>());
-      systems.register_render_system(std::make_unique<RenderDebugWindowInfo>());
-
-      systems.register_render_system(std::make_unique<EndDrawing>());
+      profiler::register_render(systems, std::make_unique<EndUIRender>());
+      // pass 3: world and UI to the window in one post-processing pass
+      profiler::register_render(
+          systems, std::make_unique<BeginPostProcessingRender>());
+      profiler::register_render(
+          systems, std::make_unique<RenderPostFxToWindow>());
+      profiler::register_render(
+          systems, std::make_unique<RenderLetterboxBars>());
+      profiler::register_render(systems, std::make_unique<RenderRoundTimer>());
+      profiler::register_render(systems, std::make_unique<RenderFPS>());
+      profiler::register_render(
+          systems, std::make_unique<RenderDebugWindowInfo>());
+      profiler::register_overlay(systems);
+
+      profiler::register_render(systems, std::make_unique<EndDrawing>());
+      profiler::end_renders(systems);
       //
     }
 
@@ -216,7 +213,12 @@ void game() {
 
       float dt = raylib::GetFrameTime();
       e2e_integration::tick(dt);
+      profiler::begin_frame();
+      replay::Recorder::get().begin_frame();
+      const int steps = step_simulation(fixed_systems, dt);
+      replay::Recorder::get().record_frame(dt, steps);
       systems.run(dt);
+      profiler::end_frame();
       
       e2e_integration::post_render(dt);
       
@@ -228,12 +230,153 @@ void game() {
 
       mcp_integration::clear_frame_state();
     }
+    replay::Recorder::get().finish();
 
     std::cout << "Num entities: " << EntityHelper::get_entities().size()
               << std::endl;
   }
 }
 
+struct HeadlessOptions {
+  // stop after this many ticks, 0 means "until `matches` are done"
+  int ticks = 0;
+  int matches = 1;
+  int num_ais = 4;
+  int map_index = MapManager::RANDOM_MAP_INDEX;
+};
+
+static void start_headless_match(SystemManager &fixed_systems,
+                                 const HeadlessOptions &options, float dt) {
+  for (int i = 0; i < options.num_ais; i++) {
+    make_ai();
+  }
+  apply_ai_tables(fixed_systems, dt);
+  start_headless_round(options.map_index);
+}
+
+int run_headless(const HeadlessOptions &options) {
+  // nothing is drawn, so every frame is exactly one fixed step
+  const float TICK_DT = SimulationClock::get().fixed_dt;
+  // Matches that nobody wins (e.g. bots stuck on a wall) end as a draw
+  constexpr float MATCH_TIMEOUT_SECONDS = 300.f;
+
+  SystemManager systems;
+  SystemManager fixed_systems;
+  register_headless_systems(fixed_systems, systems, false);
+
+  int ticks = 0;
+  int matches_played = 0;
+  int timeouts = 0;
+  const auto start = std::chrono::high_resolution_clock::now();
+
+  while (running) {
+    start_headless_match(fixed_systems, options, TICK_DT);
+    int match_ticks = 0;
+    while (GameStateManager::get().is_game_active()) {
+      profiler::begin_frame();
+      replay::Recorder::get().begin_frame();
+      fixed_systems.run(TICK_DT);
+      replay::Recorder::get().record_frame(TICK_DT, 1);
+      systems.run(TICK_DT);
+      profiler::end_frame();
+      ticks++;
+      match_ticks++;
+      if (options.ticks > 0 && ticks >= options.ticks)
+        break;
+      if ((float)match_ticks * TICK_DT > MATCH_TIMEOUT_SECONDS) {
+        timeouts++;
+        break;
+      }
+    }
+    // only the first match is recorded, while its karts are still around
+    replay::Recorder::get().finish();
+    end_headless_match();
+    matches_played++;
+
+    if (options.ticks > 0 ? ticks >= options.ticks
+                          : matches_played >= options.matches)
+      break;
+  }
+
+  const float seconds =
+      std::chrono::duration<float>(std::chrono::high_resolution_clock::now() -
+                                   start)
+          .count();
+  std::cout << fmt::format(
+      "headless: {} ticks, {} matches ({} timed out) in {:.2f}s -> {:.0f} "
+      "ticks/s ({:.1f}x realtime)\n",
+      ticks, matches_played, timeouts, seconds, (float)ticks / seconds,
+      ((float)ticks * TICK_DT) / seconds);
+  return 0;
+}
+
+struct ReplayOptions {
+  std::string path;
+  // write the frame-time histogram here
+  std::string histogram_out;
+  // and/or compare it against one written earlier
+  std::string baseline;
+  float tolerance = 0.1f;
+};
+
+// Plays a recording back headless as fast as it will go. Returns 2 if the
+// simulation ended somewhere else than the recording did and 1 if the frame
+// times regressed against the baseline.
+int run_replay(const ReplayOptions &options) {
+  auto &player = replay::Player::get();
+  if (!player.load(options.path)) {
+    return 1;
+  }
+
+  SystemManager systems;
+  SystemManager fixed_systems;
+  register_headless_systems(fixed_systems, systems, true);
+  player.start_match(fixed_systems);
+
+  replay::Histogram histogram;
+  const float fixed_dt = SimulationClock::get().fixed_dt;
+  for (; player.cursor < player.frames.size(); player.cursor++) {
+    const replay::Frame &frame = player.frames[player.cursor];
+    const auto start = std::chrono::high_resolution_clock::now();
+    profiler::begin_frame();
+    player.apply_input(player.cursor);
+    for (int i = 0; i < frame.steps; i++) {
+      fixed_systems.run(fixed_dt);
+    }
+    systems.run(frame.dt);
+    profiler::end_frame();
+    histogram.add(std::chrono::duration<float, std::micro>(
+                      std::chrono::high_resolution_clock::now() - start)
+                      .count());
+  }
+
+  int result = 0;
+  if (player.has_checksum) {
+    const uint64_t checksum = replay::checksum_karts();
+    if (checksum != player.checksum) {
+      log_error("replay: diverged from the recording after {} frames "
+                "(checksum {:016x}, recorded {:016x})",
+                player.frames.size(), checksum, player.checksum);
+      result = 2;
+    } else {
+      std::cout << fmt::format("replay: {} frames, matches the recording\n",
+                               player.frames.size());
+    }
+  }
+
+  histogram.print();
+  if (!options.histogram_out.empty()) {
+    histogram.write(options.histogram_out);
+  }
+  if (!options.baseline.empty() &&
+      !histogram.compare(options.baseline, options.tolerance) && result == 0) {
+    result = 1;
+  }
+
+  end_headless_match();
+  return result;
+}
+
 int main(int argc, char *argv[]) {
 
   // if nothing else ends up using this, we should move into preload.cpp
@@ -243,6 +386,11 @@ int main(int argc, char *argv[]) {
   cmdl({"-w", "--width"}, 1280) >> screenWidth;
   cmdl({"-h", "--height"}, 720) >> screenHeight;
 
+  std::string bench_name;
+  if (cmdl("--bench") >> bench_name) {
+    return benchmarks::run(bench_name, screenWidth, screenHeight);
+  }
+
   // Initialize files plugin first (needed for settings and resources)
   ::afterhours::files::init("Cart Chaos", "resources");
 
@@ -252,11 +400,58 @@ int main(int argc, char *argv[]) {
   // Load savefile first
   Settings::load_save_file(screenWidth, screenHeight);
 
+  float tick_rate = SimulationClock::REFERENCE_HZ;
+  if (cmdl("--tick-rate") >> tick_rate) {
+    SimulationClock::get().set_rate(tick_rate);
+  }
+
+  std::string profile_csv, profile_trace;
+  cmdl("--profile-csv") >> profile_csv;
+  cmdl("--profile-trace") >> profile_trace;
+  profiler::init(profile_csv, profile_trace);
+
+  std::string record_path;
+  if (cmdl("--record") >> record_path) {
+    replay::Recorder::get().path = record_path;
+  }
+
+  ReplayOptions replay_options;
+  if (cmdl("--replay") >> replay_options.path) {
+    cmdl("--histogram-out") >> replay_options.histogram_out;
+    cmdl("--baseline") >> replay_options.baseline;
+    cmdl("--tolerance", replay_options.tolerance) >> replay_options.tolerance;
+
+    Preload::get().init_headless().make_singleton();
+    const int result = run_replay(replay_options);
+    profiler::shutdown();
+    return result;
+  }
+
+  if (cmdl[{"--headless"}]) {
+    HeadlessOptions options;
+    cmdl("--ticks", options.ticks) >> options.ticks;
+    cmdl("--matches", options.matches) >> options.matches;
+    cmdl("--ais", options.num_ais) >> options.num_ais;
+    cmdl("--map", options.map_index) >> options.map_index;
+
+    Preload::get().init_headless().make_singleton();
+    const int result = run_headless(options);
+    profiler::shutdown();
+    return result;
+  }
+
   Preload::get() //
       .init("Cart Chaos")
       .make_singleton();
   Settings::refresh_settings();
 
+  // --dynamic-resolution turns it on for this run without saving it
+  auto &dynamic_resolution = DynamicResolution::get();
+  dynamic_resolution.enabled = Settings::get_dynamic_resolution_enabled() ||
+                               cmdl[{"--dynamic-resolution"}];
+  cmdl("--target-frame-ms", dynamic_resolution.target_ms) >>
+      dynamic_resolution.target_ms;
+
   if (cmdl[{"--mcp"}]) {
     mcp_integration::init();
   }
@@ -271,6 +466,7 @@ int main(int argc, char *argv[]) {
 
   game();
 
+  profiler::shutdown();
   mcp_integration::shutdown();
 
   Settings::write_save_file();
@@ -3,6 +3,8 @@
 #include "makers.h"
 
 #include "components.h"
+#include "projectile_pool.h"
+#include "query_cache.h"
 #include "round_settings.h"
 #include "tags.h"
 
@@ -10,10 +12,20 @@ using namespace afterhours;
 using afterhours::texture_manager::HasAnimation;
 using afterhours::texture_manager::idx_to_sprite_frame;
 
+// Everything made here is indexed by id so trackers and damage attribution
+// can find it without a scan, see EntityIndex. The components the makers add
+// change which cached query lists it belongs to, see QueryCache.
+static afterhours::Entity &create_entity() {
+  auto &entity = afterhours::EntityHelper::createEntity();
+  EntityIndex::get().add(entity);
+  QueryCache::get().invalidate();
+  return entity;
+}
+
 void make_explosion_anim(afterhours::Entity &parent) {
   const Transform &parent_transform = parent.get<Transform>();
 
-  auto &poof = afterhours::EntityHelper::createEntity();
+  auto &poof = create_entity();
   poof.addComponent<Transform>(parent_transform.pos(), vec2{10.f, 10.f});
 
   const Transform &transform = poof.get<Transform>();
@@ -61,8 +73,8 @@ void make_poof_anim(afterhours::Entity &parent, const Weapon &wp, float angle_of
     break;
   }
 
-  auto &poof = afterhours::EntityHelper::createEntity();
-  poof.addComponent<TracksEntity>(parent.id, off);
+  auto &poof = create_entity();
+  poof.addComponent<TracksEntity>(parent, off);
   poof.addComponent<Transform>(parent_transform.pos() + off, vec2{10.f, 10.f})
       .set_angle(parent_transform.angle + angle_offset);
   const Transform &transform = poof.get<Transform>();
@@ -99,53 +111,28 @@ void make_bullet(afterhours::Entity &parent, const Weapon &wp, float angle_offse
   }
 
   if (wp.config.spread > 0.f) {
-    // TODO: improve RNG seeding/determinism for projectile spread
-    std::mt19937_64 rng;
-    const auto timeSeed =
-        std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::seed_seq ss{uint32_t(timeSeed & 0xffffffff), uint32_t(timeSeed >> 32)};
-    rng.seed(ss);
     std::uniform_real_distribution<float> unif(-wp.config.spread,
                                                wp.config.spread);
-    angle_offset += wp.config.size.x * unif(rng);
+    angle_offset += wp.config.size.x * unif(sim_rng());
   }
 
   vec2 spawn_bias{0, wp.config.size.y};
-  auto bullet_spawn_pos = transform.pos() + spawn_bias;
-
-  auto &bullet = afterhours::EntityHelper::createEntity();
-  bullet.addComponent<Transform>(bullet_spawn_pos, wp.config.size)
-      .set_angle(angle_offset);
-
-  bullet.addComponent<CanDamage>(parent, wp.config.base_damage);
-  bullet.addComponent<CollisionAbsorber>(
-      CollisionAbsorber::AbsorberType::Absorbed, parent.id);
-  bullet.addComponent<HasLifetime>(wp.config.life_time_seconds);
-
-  // If the config doesn't want wrapping,
-  // this will make the bullet go into the "void"
-  auto wrap_padding =
-      wp.config.can_wrap_around ? 0.f : std::numeric_limits<float>::max();
-  bullet.addComponent<CanWrapAround>(wrap_padding);
-
-  bullet.addComponent<HasEntityIDBasedColor>(
-      parent.id, parent.get<HasColor>().color(), raylib::RED);
-
   const auto rad = transform.as_rad() + to_radians(angle + angle_offset);
-  auto &bullet_transform = bullet.get<Transform>();
-
-  bullet_transform.collision_config =
-      CollisionConfig{.mass = 1.f, .friction = 0.f, .restitution = 0.f};
-
-  bullet_transform.velocity =
-      vec2{std::sin(rad) * wp.config.speed, -std::cos(rad) * wp.config.speed};
-
-  bullet_transform.accel = wp.config.acceleration;
 
-  bullet_transform.render_out_of_bounds =
-      wp.config.can_wrap_around && wp.config.render_out_of_bounds;
-
-  bullet_transform.cleanup_out_of_bounds = !wp.config.can_wrap_around;
+  ProjectilePool::get().spawn(ProjectilePool::Spawn{
+      .position = transform.pos() + spawn_bias,
+      .size = wp.config.size,
+      .velocity = vec2{std::sin(rad) * wp.config.speed,
+                       -std::cos(rad) * wp.config.speed},
+      .angle = angle_offset,
+      .accel = wp.config.acceleration,
+      .lifetime = wp.config.life_time_seconds,
+      .damage = wp.config.base_damage,
+      .source = parent,
+      .color = parent.get<HasColor>().color(),
+      .can_wrap = wp.config.can_wrap_around,
+      .render_out_of_bounds = wp.config.render_out_of_bounds,
+  });
 }
 
 void make_poof_anim(afterhours::Entity &parent, Weapon::FiringDirection dir,
@@ -173,8 +160,8 @@ void make_poof_anim(afterhours::Entity &parent, Weapon::FiringDirection dir,
     break;
   }
 
-  auto &poof = afterhours::EntityHelper::createEntity();
-  poof.addComponent<TracksEntity>(parent.id, off);
+  auto &poof = create_entity();
+  poof.addComponent<TracksEntity>(parent, off);
   poof.addComponent<Transform>(parent_transform.pos() + off, vec2{10.f, 10.f})
       .set_angle(base_angle + angle_offset);
   const Transform &transform = poof.get<Transform>();
@@ -213,54 +200,30 @@ void make_bullet(afterhours::Entity &parent, const ProjectileConfig &cfg,
 
   float final_angle_offset = angle_offset;
   if (cfg.spread > 0.f) {
-    // TODO: improve RNG seeding/determinism for projectile spread
-    std::mt19937_64 rng;
-    const auto timeSeed =
-        std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    std::seed_seq ss{uint32_t(timeSeed & 0xffffffff), uint32_t(timeSeed >> 32)};
-    rng.seed(ss);
     std::uniform_real_distribution<float> unif(-cfg.spread, cfg.spread);
-    final_angle_offset += cfg.size.x * unif(rng);
+    final_angle_offset += cfg.size.x * unif(sim_rng());
   }
 
   vec2 spawn_bias{0, cfg.size.y};
-  auto bullet_spawn_pos = transform.pos() + spawn_bias;
-
-  auto &bullet = afterhours::EntityHelper::createEntity();
-  bullet.addComponent<Transform>(bullet_spawn_pos, cfg.size)
-      .set_angle(final_angle_offset);
-
-  bullet.addComponent<CanDamage>(parent, cfg.base_damage);
-  bullet.addComponent<CollisionAbsorber>(
-      CollisionAbsorber::AbsorberType::Absorbed, parent.id);
-  bullet.addComponent<HasLifetime>(cfg.life_time_seconds);
-
-  auto wrap_padding =
-      cfg.can_wrap_around ? 0.f : std::numeric_limits<float>::max();
-  bullet.addComponent<CanWrapAround>(wrap_padding);
-
-  bullet.addComponent<HasEntityIDBasedColor>(
-      parent.id, parent.get<HasColor>().color(), raylib::RED);
-
   const auto rad = transform.as_rad() + to_radians(angle + final_angle_offset);
-  auto &bullet_transform = bullet.get<Transform>();
-
-  bullet_transform.collision_config =
-      CollisionConfig{.mass = 1.f, .friction = 0.f, .restitution = 0.f};
-
-  bullet_transform.velocity =
-      vec2{std::sin(rad) * cfg.speed, -std::cos(rad) * cfg.speed};
-
-  bullet_transform.accel = cfg.acceleration;
 
-  bullet_transform.render_out_of_bounds =
-      cfg.can_wrap_around && cfg.render_out_of_bounds;
-
-  bullet_transform.cleanup_out_of_bounds = !cfg.can_wrap_around;
+  ProjectilePool::get().spawn(ProjectilePool::Spawn{
+      .position = transform.pos() + spawn_bias,
+      .size = cfg.size,
+      .velocity = vec2{std::sin(rad) * cfg.speed, -std::cos(rad) * cfg.speed},
+      .angle = final_angle_offset,
+      .accel = cfg.acceleration,
+      .lifetime = cfg.life_time_seconds,
+      .damage = cfg.base_damage,
+      .source = parent,
+      .color = parent.get<HasColor>().color(),
+      .can_wrap = cfg.can_wrap_around,
+      .render_out_of_bounds = cfg.render_out_of_bounds,
+  });
 }
 
 afterhours::Entity &make_car(size_t id) {
-  auto &entity = afterhours::EntityHelper::createEntity();
+  auto &entity = create_entity();
 
   int starting_lives = RoundManager::get().fetch_num_starting_lives();
   entity.addComponent<HasMultipleLives>(starting_lives);
@@ -279,6 +242,7 @@ afterhours::Entity &make_car(size_t id) {
   entity.addComponent<CanWrapAround>();
   entity.addComponent<HasHealth>(MAX_HEALTH);
   entity.addComponent<TireMarkComponent>();
+  entity.addComponent<CarAffectorCache>();
   entity.addComponent<HasColor>([&entity]() -> raylib::Color {
     return afterhours::EntityHelper::get_singleton_cmp<ManagesAvailableColors>()
         ->get_next_available(entity.id);
@@ -330,7 +294,7 @@ afterhours::Entity &make_car(size_t id) {
 
 afterhours::Entity &make_obstacle(raylib::Rectangle rect, const raylib::Color color,
                       const CollisionConfig &collision_config) {
-  auto &entity = afterhours::EntityHelper::createEntity();
+  auto &entity = create_entity();
 
   auto &transform = entity.addComponent<Transform>(std::move(rect));
   transform.collision_config = collision_config;
@@ -406,7 +370,7 @@ void make_ai() {
 }
 
 afterhours::Entity &make_hippo_item(vec2 position) {
-  auto &entity = afterhours::EntityHelper::createEntity();
+  auto &entity = create_entity();
 
   entity.addComponent<Transform>(position, vec2{30, 30});
   entity.addComponent<HippoItem>(0.0f);
@@ -420,8 +384,7 @@ afterhours::Entity &make_hippo_item(vec2 position) {
 afterhours::Entity &make_oil_slick(raylib::Rectangle rect, float steering_multiplier,
                        float acceleration_multiplier,
                        float steering_sensitivity_increment) {
-  raylib::Color darker_oil{20, 12, 6, 255};
-  auto &entity = afterhours::EntityHelper::createEntity();
+  auto &entity = create_entity();
 
   auto &transform = entity.addComponent<Transform>(std::move(rect));
   transform.collision_config =
@@ -431,7 +394,7 @@ afterhours::Entity &make_oil_slick(raylib::Rectangle rect, float steering_multip
 
   entity.addComponent<CanWrapAround>();
   entity.enableTag(GameTag::MapGenerated);
-  entity.addComponent<HasColor>(darker_oil);
+  entity.addComponent<HasColor>(OIL_SLICK_COLOR);
   entity.enableTag(GameTag::FloorOverlay);
   entity.addComponent<SteeringAffector>(steering_multiplier);
   entity.addComponent<AccelerationAffector>(acceleration_multiplier);
@@ -445,8 +408,7 @@ afterhours::Entity &make_default_oil_slick(raylib::Rectangle rect) {
 }
 
 afterhours::Entity &make_sticky_goo(raylib::Rectangle rect) {
-  raylib::Color goo{57, 255, 20, 255};
-  auto &entity = afterhours::EntityHelper::createEntity();
+  auto &entity = create_entity();
 
   auto &transform = entity.addComponent<Transform>(std::move(rect));
   transform.collision_config =
@@ -456,7 +418,7 @@ afterhours::Entity &make_sticky_goo(raylib::Rectangle rect) {
 
   entity.addComponent<CanWrapAround>();
   entity.enableTag(GameTag::MapGenerated);
-  entity.addComponent<HasColor>(goo);
+  entity.addComponent<HasColor>(STICKY_GOO_COLOR);
   entity.enableTag(GameTag::FloorOverlay);
   entity.addComponent<SpeedAffector>(0.95f);
 
@@ -33,6 +33,9 @@ void make_ai();
 /// @param position is the location where the hippo item will be spawned.
 afterhours::Entity &make_hippo_item(vec2 position);
 
+constexpr raylib::Color OIL_SLICK_COLOR{20, 12, 6, 255};
+constexpr raylib::Color STICKY_GOO_COLOR{57, 255, 20, 255};
+
 /// Creates an oil slick area that affects car steering and acceleration.
 afterhours::Entity &make_oil_slick(raylib::Rectangle rect, float steering_multiplier,
                        float acceleration_multiplier,
@@ -4,6 +4,11 @@
 #include "rl.h"
 #include "round_settings.h"
 #include "tags.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
 
 // Map preview constants
 namespace {
@@ -11,23 +16,108 @@ namespace {
 // Range: 200-500px works well for most screen resolutions
 constexpr int PREVIEW_TEXTURE_SIZE = 300;
 
-// Preview isolation offset (keeps preview entities far from main game)
-// Range: 50000+ to avoid any collision with main game area
-// Should be >> largest possible screen resolution + wrap padding
-constexpr float PREVIEW_BASE_OFFSET = 100000.0f;
-
-// Spacing between different map previews
-// Range: 20000+ to ensure complete separation between map preview areas
-constexpr float PREVIEW_MAP_SPACING = 10000.0f;
-
 // Camera zoom margin (prevents edge clipping in preview)
 // Range: 0.7-0.9, lower = more margin, higher = tighter crop
 constexpr float PREVIEW_ZOOM_MARGIN = 0.8f;
 
-// Helper function to calculate preview offset for a given map index
-vec2 get_preview_offset(int map_index) {
-  float offset = PREVIEW_BASE_OFFSET + (map_index * PREVIEW_MAP_SPACING);
-  return {offset, offset};
+// Bump when the way previews are drawn changes, so old cache files are
+// ignored
+constexpr uint64_t PREVIEW_FORMAT = 1;
+
+namespace fs = std::filesystem;
+
+// The per-user cache folder (what sago::getCacheDir() returns); written out
+// here because platform_folders.h is not header-only safe
+fs::path user_cache_dir() {
+#if defined(_WIN32)
+  const char *local = std::getenv("LOCALAPPDATA");
+  return local ? fs::path(local) : fs::temp_directory_path();
+#else
+  const char *home = std::getenv("HOME");
+#if defined(__APPLE__)
+  return home ? fs::path(home) / "Library" / "Caches"
+              : fs::temp_directory_path();
+#else
+  const char *xdg = std::getenv("XDG_CACHE_HOME");
+  if (xdg && xdg[0] == '/')
+    return fs::path(xdg);
+  return home ? fs::path(home) / ".cache" : fs::temp_directory_path();
+#endif
+#endif
+}
+
+fs::path preview_cache_dir() {
+  return user_cache_dir() / "cart_chaos" / "map_previews";
+}
+
+struct Fnv1a {
+  uint64_t h = 0xcbf29ce484222325ull;
+
+  template <typename T> void add(const T &value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (unsigned char b : bytes) {
+      h ^= b;
+      h *= 0x100000001b3ull;
+    }
+  }
+};
+
+// Changes whenever anything that ends up in the picture does
+uint64_t preview_key(const MapDescription &map,
+                     const afterhours::window_manager::Resolution &resolution) {
+  Fnv1a hash;
+  hash.add(PREVIEW_FORMAT);
+  hash.add(PREVIEW_TEXTURE_SIZE);
+  hash.add(resolution.width);
+  hash.add(resolution.height);
+  for (const MapPiece &piece : map) {
+    hash.add(piece.kind);
+    hash.add(piece.at.x);
+    hash.add(piece.at.y);
+    hash.add(piece.size.x);
+    hash.add(piece.size.y);
+    const raylib::Color color = piece.draw_color();
+    hash.add(color.r);
+    hash.add(color.g);
+    hash.add(color.b);
+    hash.add(color.a);
+  }
+  return hash.h;
+}
+
+// Draws the layout as the game would show it at `resolution`, scaled down
+// into a square thumbnail, and returns it right side up
+raylib::Image
+draw_preview(const MapDescription &map,
+             const afterhours::window_manager::Resolution &resolution) {
+  raylib::RenderTexture2D target =
+      raylib::LoadRenderTexture(PREVIEW_TEXTURE_SIZE, PREVIEW_TEXTURE_SIZE);
+
+  raylib::Camera2D camera = {};
+  float zoom_x = PREVIEW_TEXTURE_SIZE / static_cast<float>(resolution.width);
+  float zoom_y = PREVIEW_TEXTURE_SIZE / static_cast<float>(resolution.height);
+  camera.zoom = std::min(zoom_x, zoom_y) * PREVIEW_ZOOM_MARGIN;
+  camera.offset = {PREVIEW_TEXTURE_SIZE / 2.0f, PREVIEW_TEXTURE_SIZE / 2.0f};
+  camera.target = {resolution.width / 2.0f, resolution.height / 2.0f};
+
+  raylib::BeginTextureMode(target);
+  raylib::ClearBackground(raylib::DARKGRAY);
+  raylib::BeginMode2D(camera);
+  for (const MapPiece &piece : map) {
+    const raylib::Rectangle rect = piece.rect(resolution);
+    raylib::DrawRectangle(static_cast<int>(rect.x), static_cast<int>(rect.y),
+                          static_cast<int>(rect.width),
+                          static_cast<int>(rect.height), piece.draw_color());
+  }
+  raylib::EndMode2D();
+  raylib::EndTextureMode();
+
+  raylib::Image image = raylib::LoadImageFromTexture(target.texture);
+  // render textures come back upside down
+  raylib::ImageFlipVertical(&image);
+  raylib::UnloadRenderTexture(target);
+  return image;
 }
 } // namespace
 
@@ -36,253 +126,192 @@ const std::array<MapConfig, MapManager::MAP_COUNT> MapManager::available_maps =
        .description = "Classic open arena with strategic obstacles",
        .compatible_round_types = std::bitset<4>(
            0b1111), // All round types (Lives, Kills, Score, TagAndGo)
-       .create_map_func = create_arena_map},
+       .describe = describe_arena_map},
       {.display_name = "Maze",
        .description = "Complex maze layout for tactical gameplay",
        .compatible_round_types = std::bitset<4>(0b0011), // Lives, Kills
-       .create_map_func = create_maze_map},
+       .describe = describe_maze_map},
       {.display_name = "Race Track",
        .description = "Race track layout with speed-focused gameplay",
        .compatible_round_types = std::bitset<4>(0b1100), // Score, TagAndGo
-       .create_map_func = create_race_map},
+       .describe = describe_race_map},
       {.display_name = "Battle Arena",
        .description = "Combat-focused layout with cover points",
        .compatible_round_types = std::bitset<4>(0b0011), // Lives, Kills
-       .create_map_func = create_battle_map},
+       .describe = describe_battle_map},
       {.display_name = "Tag And Go",
        .description = "Special layout optimized for tag gameplay",
        .compatible_round_types = std::bitset<4>(0b1000), // TagAndGo only
-       .create_map_func = create_tagandgo_map},
+       .describe = describe_tagandgo_map},
       {.display_name = "Test Map",
        .description = "Test map with green walls and big X for preview testing",
        .compatible_round_types = std::bitset<4>(
            0b1111), // All round types (Lives, Kills, Score, TagAndGo)
-       .create_map_func = create_test_map}}};
-
-void MapManager::initialize_preview_textures() {
-  if (preview_textures_initialized)
-    return;
-
-  for (size_t i = 0; i < preview_textures.size(); i++) {
-    preview_textures[i] =
-        raylib::LoadRenderTexture(PREVIEW_TEXTURE_SIZE, PREVIEW_TEXTURE_SIZE);
+       .describe = describe_test_map}}};
+
+void MapManager::spawn(
+    const MapDescription &map,
+    const afterhours::window_manager::Resolution &resolution) {
+  for (const MapPiece &piece : map) {
+    const raylib::Rectangle rect = piece.rect(resolution);
+    switch (piece.kind) {
+    case MapPiece::Kind::Obstacle:
+      make_obstacle(rect, piece.color, piece.collision);
+      break;
+    case MapPiece::Kind::OilSlick:
+      make_default_oil_slick(rect);
+      break;
+    case MapPiece::Kind::StickyGoo:
+      make_sticky_goo(rect);
+      break;
+    }
   }
-
-  preview_textures_initialized = true;
-  generate_all_previews();
 }
 
-void MapManager::generate_map_preview(int map_index) {
-  if (!preview_textures_initialized || map_index < 0 || map_index >= MAP_COUNT)
-    return;
-
-  cleanup_preview_area(map_index);
-  available_maps[map_index].create_map_func();
-
-  vec2 preview_offset = get_preview_offset(map_index);
+std::vector<raylib::Rectangle> MapManager::wall_rects(
+    const MapDescription &map,
+    const afterhours::window_manager::Resolution &resolution) {
+  std::vector<raylib::Rectangle> walls;
+  for (const MapPiece &piece : map) {
+    // balls and other movable obstacles leave their spawn cell, so only
+    // infinite mass ones block, as in StaticMapLayer::is_static
+    if (piece.kind == MapPiece::Kind::Obstacle &&
+        piece.collision.mass == std::numeric_limits<float>::max()) {
+      walls.push_back(piece.rect(resolution));
+    }
+  }
+  return walls;
+}
 
-  auto map_entities = afterhours::EntityQuery({.force_merge = true})
-                          .whereHasTag(GameTag::MapGenerated)
-                          .gen();
+void MapManager::build_nav_grid(
+    const MapDescription &map,
+    const afterhours::window_manager::Resolution &resolution) {
+  NavGrid::get().build(wall_rects(map, resolution),
+                       static_cast<float>(resolution.width),
+                       static_cast<float>(resolution.height));
+}
 
-  for (auto &entity : map_entities) {
-    if (entity.get().has<Transform>()) {
-      auto &transform = entity.get().get<Transform>();
-      transform.position.x += preview_offset.x;
-      transform.position.y += preview_offset.y;
-    }
+const raylib::Texture2D &MapManager::get_preview_texture(int map_index) {
+  auto &preview = previews[static_cast<size_t>(map_index)];
+  if (!preview.has_value()) {
+    preview = load_preview(map_index);
   }
+  return preview.value();
+}
 
-  // Calculate the actual map bounds to center the camera properly
+raylib::Texture2D MapManager::load_preview(int map_index) const {
   auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
       afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  raylib::Camera2D camera = {};
-  float zoom_x = PREVIEW_TEXTURE_SIZE / static_cast<float>(resolution.width);
-  float zoom_y = PREVIEW_TEXTURE_SIZE / static_cast<float>(resolution.height);
-  camera.zoom = std::min(zoom_x, zoom_y) * PREVIEW_ZOOM_MARGIN;
-  camera.offset = {PREVIEW_TEXTURE_SIZE / 2.0f, PREVIEW_TEXTURE_SIZE / 2.0f};
-
-  // The map is created using screen coordinates, so the actual map bounds are:
-  // X: preview_offset.x + 0 to preview_offset.x + resolution.width
-  // Y: preview_offset.y + 0 to preview_offset.y + resolution.height
-  vec2 map_center = {preview_offset.x + resolution.width / 2.0f,
-                     preview_offset.y + resolution.height / 2.0f};
-  camera.target = map_center;
-
-  raylib::BeginTextureMode(preview_textures[map_index]);
-  raylib::ClearBackground(raylib::DARKGRAY);
-  raylib::BeginMode2D(camera);
-
-  auto preview_entities = afterhours::EntityQuery({.force_merge = true})
-                              .whereHasComponent<Transform>()
-                              .whereHasComponent<afterhours::HasColor>()
-                              .gen();
-
-  for (auto &entity : preview_entities) {
-    auto &transform = entity.get().get<Transform>();
-    auto &color = entity.get().get<afterhours::HasColor>();
-
-    if (transform.position.x >= preview_offset.x &&
-        transform.position.x < preview_offset.x + resolution.width &&
-        transform.position.y >= preview_offset.y &&
-        transform.position.y < preview_offset.y + resolution.height) {
-
-      raylib::DrawRectangle(static_cast<int>(transform.position.x),
-                            static_cast<int>(transform.position.y),
-                            static_cast<int>(transform.size.x),
-                            static_cast<int>(transform.size.y), color.color());
+  const afterhours::window_manager::Resolution resolution =
+      pcr->current_resolution;
+  const MapDescription map =
+      available_maps[static_cast<size_t>(map_index)].describe();
+
+  const fs::path dir = preview_cache_dir();
+  const fs::path file =
+      dir / fmt::format("{:016x}.png", preview_key(map, resolution));
+
+  std::error_code ec;
+  if (fs::exists(file, ec)) {
+    raylib::Texture2D texture = raylib::LoadTexture(file.string().c_str());
+    if (texture.id != 0) {
+      return texture;
     }
+    log_warn("map preview cache: could not load {}, redrawing",
+             file.string());
   }
 
-  raylib::EndMode2D();
-  raylib::EndTextureMode();
-  cleanup_preview_area(map_index);
+  raylib::Image image = draw_preview(map, resolution);
+  fs::create_directories(dir, ec);
+  if (ec || !raylib::ExportImage(image, file.string().c_str())) {
+    log_warn("map preview cache: could not write {}", file.string());
+  }
+  raylib::Texture2D texture = raylib::LoadTextureFromImage(image);
+  raylib::UnloadImage(image);
+  return texture;
 }
 
-void MapManager::generate_all_previews() {
-  for (int i = 0; i < MAP_COUNT; i++) {
-    generate_map_preview(i);
+void MapManager::release_previews() {
+  for (auto &preview : previews) {
+    if (preview.has_value()) {
+      raylib::UnloadTexture(preview.value());
+      preview.reset();
+    }
   }
 }
 
-const raylib::RenderTexture2D &
-MapManager::get_preview_texture(int map_index) const {
-  return preview_textures[map_index];
+// Map layouts
+namespace {
+const CollisionConfig STATIC_CONFIG{
+    .mass = std::numeric_limits<float>::max(),
+    .friction = 1.f,
+    .restitution = 0.f,
+};
+
+MapPiece obstacle(float x, float y, float size, raylib::Color color,
+                  const CollisionConfig &config = STATIC_CONFIG) {
+  return MapPiece{.kind = MapPiece::Kind::Obstacle,
+                  .at = {x, y},
+                  .size = {size, size},
+                  .color = color,
+                  .collision = config};
 }
 
-void MapManager::cleanup_preview_textures() {
-  if (!preview_textures_initialized)
-    return;
-
-  for (auto &texture : preview_textures) {
-    raylib::UnloadRenderTexture(texture);
-  }
-  preview_textures_initialized = false;
+MapPiece oil_slick(float x, float y, float size) {
+  return MapPiece{.kind = MapPiece::Kind::OilSlick,
+                  .at = {x, y},
+                  .size = {size, size}};
 }
 
-void MapManager::cleanup_preview_area(int map_index) {
-  vec2 preview_offset = get_preview_offset(map_index);
-
-  auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
-      afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  auto entities_in_area =
-      afterhours::EntityQuery({.force_merge = true}).whereHasComponent<Transform>().gen();
-
-  for (auto &entity : entities_in_area) {
-    if (entity.get().has<Transform>()) {
-      auto &transform = entity.get().get<Transform>();
-
-      if (transform.position.x >= preview_offset.x &&
-          transform.position.x < preview_offset.x + resolution.width &&
-          transform.position.y >= preview_offset.y &&
-          transform.position.y < preview_offset.y + resolution.height) {
-        entity.get().cleanup = true;
-      }
-    }
-  }
+MapPiece sticky_goo(float x, float y, float size) {
+  return MapPiece{.kind = MapPiece::Kind::StickyGoo,
+                  .at = {x, y},
+                  .size = {size, size}};
 }
+} // namespace
 
-// Map creation functions
-void MapManager::create_arena_map() {
-  auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
-      afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  const auto screen_pct = [resolution](float x, float y, float w, float h) {
-    return Rectangle{
-        resolution.width * x,
-        resolution.height * y,
-        w,
-        h,
-    };
-  };
-
-  const CollisionConfig rock_config{
-      .mass = std::numeric_limits<float>::max(),
-      .friction = 1.f,
-      .restitution = 0.f,
-  };
-
+MapDescription MapManager::describe_arena_map() {
   const CollisionConfig ball_config{
       .mass = 100.f,
       .friction = 0.f,
       .restitution = .75f,
   };
 
-  // Corner obstacles
-  make_obstacle(screen_pct(0.2f, 0.2f, 50, 50), raylib::BLACK, rock_config);
-  make_obstacle(screen_pct(0.2f, 0.8f, 50, 50), raylib::BLACK, rock_config);
-  make_obstacle(screen_pct(0.8f, 0.8f, 50, 50), raylib::BLACK, rock_config);
-  make_obstacle(screen_pct(0.8f, 0.2f, 50, 50), raylib::BLACK, rock_config);
-
-  // Center obstacles
-  make_obstacle(screen_pct(0.5f, 0.2f, 50, 50), raylib::WHITE, ball_config);
-  make_obstacle(screen_pct(0.5f, 0.8f, 50, 50), raylib::WHITE, ball_config);
+  return {
+      // Corner obstacles
+      obstacle(0.2f, 0.2f, 50, raylib::BLACK),
+      obstacle(0.2f, 0.8f, 50, raylib::BLACK),
+      obstacle(0.8f, 0.8f, 50, raylib::BLACK),
+      obstacle(0.8f, 0.2f, 50, raylib::BLACK),
 
-  make_default_oil_slick(screen_pct(0.35f, 0.5f, 120, 120));
-}
+      // Center obstacles
+      obstacle(0.5f, 0.2f, 50, raylib::WHITE, ball_config),
+      obstacle(0.5f, 0.8f, 50, raylib::WHITE, ball_config),
 
-void MapManager::create_maze_map() {
-  auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
-      afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  const auto screen_pct = [resolution](float x, float y, float w, float h) {
-    return Rectangle{
-        resolution.width * x,
-        resolution.height * y,
-        w,
-        h,
-    };
+      oil_slick(0.35f, 0.5f, 120),
   };
+}
 
-  const CollisionConfig wall_config{
-      .mass = std::numeric_limits<float>::max(),
-      .friction = 1.f,
-      .restitution = 0.f,
-  };
+MapDescription MapManager::describe_maze_map() {
+  MapDescription map;
+  const auto wall_color = afterhours::colors::increase(raylib::DARKGRAY, 2);
 
   // Horizontal walls
-  auto wall_color = afterhours::colors::increase(raylib::DARKGRAY, 2);
   for (int i = 0; i < 5; i++) {
-    make_obstacle(screen_pct(0.1f + i * 0.2f, 0.3f, 30, 30), wall_color,
-                  wall_config);
-    make_obstacle(screen_pct(0.1f + i * 0.2f, 0.7f, 30, 30), wall_color,
-                  wall_config);
+    map.push_back(obstacle(0.1f + i * 0.2f, 0.3f, 30, wall_color));
+    map.push_back(obstacle(0.1f + i * 0.2f, 0.7f, 30, wall_color));
   }
 
   // Vertical walls
   for (int i = 0; i < 3; i++) {
-    make_obstacle(screen_pct(0.3f, 0.1f + i * 0.3f, 30, 30), wall_color,
-                  wall_config);
-    make_obstacle(screen_pct(0.7f, 0.1f + i * 0.3f, 30, 30), wall_color,
-                  wall_config);
+    map.push_back(obstacle(0.3f, 0.1f + i * 0.3f, 30, wall_color));
+    map.push_back(obstacle(0.7f, 0.1f + i * 0.3f, 30, wall_color));
   }
+  return map;
 }
 
-void MapManager::create_race_map() {
-  auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
-      afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  const auto screen_pct = [resolution](float x, float y, float w, float h) {
-    return Rectangle{
-        resolution.width * x,
-        resolution.height * y,
-        w,
-        h,
-    };
-  };
-
-  const CollisionConfig barrier_config{
-      .mass = std::numeric_limits<float>::max(),
-      .friction = 1.f,
-      .restitution = 0.f,
-  };
+MapDescription MapManager::describe_race_map() {
+  MapDescription map;
 
   // Create race track barriers
   // Outer track
@@ -290,7 +319,7 @@ void MapManager::create_race_map() {
     float angle = i * 0.785f; // 45 degrees
     float x = 0.5f + 0.3f * cos(angle);
     float y = 0.5f + 0.3f * sin(angle);
-    make_obstacle(screen_pct(x, y, 40, 40), raylib::ORANGE, barrier_config);
+    map.push_back(obstacle(x, y, 40, raylib::ORANGE));
   }
 
   // Inner track
@@ -298,104 +327,47 @@ void MapManager::create_race_map() {
     float angle = i * 1.047f; // 60 degrees
     float x = 0.5f + 0.15f * cos(angle);
     float y = 0.5f + 0.15f * sin(angle);
-    make_obstacle(screen_pct(x, y, 40, 40), raylib::RED, barrier_config);
+    map.push_back(obstacle(x, y, 40, raylib::RED));
   }
+  return map;
 }
 
-void MapManager::create_battle_map() {
-  auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
-      afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  const auto screen_pct = [resolution](float x, float y, float w, float h) {
-    return Rectangle{
-        resolution.width * x,
-        resolution.height * y,
-        w,
-        h,
-    };
-  };
-
-  const CollisionConfig cover_config{
-      .mass = std::numeric_limits<float>::max(),
-      .friction = 1.f,
-      .restitution = 0.f,
+MapDescription MapManager::describe_battle_map() {
+  return {
+      // Corner cover
+      obstacle(0.15f, 0.15f, 35, raylib::BROWN),
+      obstacle(0.85f, 0.15f, 35, raylib::BROWN),
+      obstacle(0.15f, 0.85f, 35, raylib::BROWN),
+      obstacle(0.85f, 0.85f, 35, raylib::BROWN),
+
+      // Center cover
+      obstacle(0.5f, 0.3f, 35, raylib::BROWN),
+      obstacle(0.5f, 0.7f, 35, raylib::BROWN),
+      obstacle(0.3f, 0.5f, 35, raylib::BROWN),
+      obstacle(0.7f, 0.5f, 35, raylib::BROWN),
   };
-
-  // Create cover points for battle
-  // Corner cover
-  make_obstacle(screen_pct(0.15f, 0.15f, 35, 35), raylib::BROWN, cover_config);
-  make_obstacle(screen_pct(0.85f, 0.15f, 35, 35), raylib::BROWN, cover_config);
-  make_obstacle(screen_pct(0.15f, 0.85f, 35, 35), raylib::BROWN, cover_config);
-  make_obstacle(screen_pct(0.85f, 0.85f, 35, 35), raylib::BROWN, cover_config);
-
-  // Center cover
-  make_obstacle(screen_pct(0.5f, 0.3f, 35, 35), raylib::BROWN, cover_config);
-  make_obstacle(screen_pct(0.5f, 0.7f, 35, 35), raylib::BROWN, cover_config);
-  make_obstacle(screen_pct(0.3f, 0.5f, 35, 35), raylib::BROWN, cover_config);
-  make_obstacle(screen_pct(0.7f, 0.5f, 35, 35), raylib::BROWN, cover_config);
 }
 
-void MapManager::create_tagandgo_map() {
-  auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
-      afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  const auto screen_pct = [resolution](float x, float y, float w, float h) {
-    return Rectangle{
-        resolution.width * x,
-        resolution.height * y,
-        w,
-        h,
-    };
-  };
-
-  const CollisionConfig safe_zone_config{
-      .mass = std::numeric_limits<float>::max(),
-      .friction = 1.f,
-      .restitution = 0.f,
+MapDescription MapManager::describe_tagandgo_map() {
+  return {
+      // Safe zones (smaller, harder to reach)
+      obstacle(0.1f, 0.1f, 25, raylib::GREEN),
+      obstacle(0.9f, 0.1f, 25, raylib::GREEN),
+      obstacle(0.1f, 0.9f, 25, raylib::GREEN),
+      obstacle(0.9f, 0.9f, 25, raylib::GREEN),
+
+      // Chase obstacles
+      obstacle(0.5f, 0.2f, 25, raylib::BLUE),
+      obstacle(0.5f, 0.8f, 25, raylib::BLUE),
+      obstacle(0.2f, 0.5f, 25, raylib::BLUE),
+      obstacle(0.8f, 0.5f, 25, raylib::BLUE),
   };
-
-  // Create safe zones and obstacles for Tag And Go
-  // Safe zones (smaller, harder to reach)
-  make_obstacle(screen_pct(0.1f, 0.1f, 25, 25), raylib::GREEN,
-                safe_zone_config);
-  make_obstacle(screen_pct(0.9f, 0.1f, 25, 25), raylib::GREEN,
-                safe_zone_config);
-  make_obstacle(screen_pct(0.1f, 0.9f, 25, 25), raylib::GREEN,
-                safe_zone_config);
-  make_obstacle(screen_pct(0.9f, 0.9f, 25, 25), raylib::GREEN,
-                safe_zone_config);
-
-  // Chase obstacles
-  make_obstacle(screen_pct(0.5f, 0.2f, 25, 25), raylib::BLUE, safe_zone_config);
-  make_obstacle(screen_pct(0.5f, 0.8f, 25, 25), raylib::BLUE, safe_zone_config);
-  make_obstacle(screen_pct(0.2f, 0.5f, 25, 25), raylib::BLUE, safe_zone_config);
-  make_obstacle(screen_pct(0.8f, 0.5f, 25, 25), raylib::BLUE, safe_zone_config);
 }
 
-void MapManager::create_test_map() {
-  auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
-      afterhours::window_manager::ProvidesCurrentResolution>();
-  afterhours::window_manager::Resolution resolution = pcr->current_resolution;
-
-  const auto screen_pct = [resolution](float x, float y, float w, float h) {
-    return Rectangle{
-        resolution.width * x,
-        resolution.height * y,
-        w,
-        h,
-    };
-  };
-
-  const CollisionConfig wall_config{
-      .mass = std::numeric_limits<float>::max(),
-      .friction = 1.f,
-      .restitution = 0.f,
+MapDescription MapManager::describe_test_map() {
+  return {
+      obstacle(0.15f, 0.2f, 60, raylib::LIGHTGRAY),
+      oil_slick(0.4f, 0.5f, 120),
+      sticky_goo(0.65f, 0.5f, 120),
   };
-
-  make_obstacle(screen_pct(0.15f, 0.2f, 60, 60), raylib::LIGHTGRAY,
-                wall_config);
-  make_default_oil_slick(screen_pct(0.4f, 0.5f, 120, 120));
-  make_sticky_goo(screen_pct(0.65f, 0.5f, 120, 120));
 }
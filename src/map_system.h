@@ -1,19 +1,60 @@
 #pragma once
 
 #include "makers.h"
+#include "nav_grid.h"
+#include "projectile_pool.h"
+#include "replay.h"
 #include "rl.h"
 #include "round_settings.h"
+#include "skid_decals.h"
+#include "static_map_layer.h"
 #include "tags.h"
 #include <afterhours/src/library.h>
 #include <bitset>
 #include <functional>
+#include <optional>
 #include <magic_enum/magic_enum.hpp>
 
+// One piece of a map layout. Positions are fractions of the screen so a
+// layout fits any resolution, sizes are in pixels.
+struct MapPiece {
+  enum struct Kind { Obstacle, OilSlick, StickyGoo };
+
+  Kind kind;
+  vec2 at;   // top left corner
+  vec2 size;
+  // obstacles only; slicks and goo bring their own
+  raylib::Color color{};
+  CollisionConfig collision{};
+
+  [[nodiscard]] raylib::Rectangle rect(
+      const afterhours::window_manager::Resolution &resolution) const {
+    return raylib::Rectangle{resolution.width * at.x,
+                             resolution.height * at.y, size.x, size.y};
+  }
+
+  [[nodiscard]] raylib::Color draw_color() const {
+    switch (kind) {
+    case Kind::OilSlick:
+      return OIL_SLICK_COLOR;
+    case Kind::StickyGoo:
+      return STICKY_GOO_COLOR;
+    case Kind::Obstacle:
+      break;
+    }
+    return color;
+  }
+};
+
+// Everything a map places. create_map() spawns it, the map selection screen
+// draws its preview straight from it.
+using MapDescription = std::vector<MapPiece>;
+
 struct MapConfig {
   std::string display_name;
   std::string description;
   std::bitset<magic_enum::enum_count<RoundType>()> compatible_round_types;
-  std::function<void()> create_map_func; // Function to create the map
+  std::function<MapDescription()> describe; // The map's layout
 };
 
 SINGLETON_FWD(MapManager)
@@ -25,11 +66,12 @@ struct MapManager {
   static const std::array<MapConfig, MAP_COUNT> available_maps;
   int selected_map_index = 0;
 
-  std::array<raylib::RenderTexture2D, MAP_COUNT> preview_textures;
-  bool preview_textures_initialized = false;
+  // Map thumbnails for the selection screen. Each is loaded (or drawn and
+  // written to the preview cache) the first time the screen asks for it and
+  // dropped again when the screen is left.
+  std::array<std::optional<raylib::Texture2D>, MAP_COUNT> previews;
 
   MapManager() = default;
-  ~MapManager() { cleanup_preview_textures(); }
 
   std::vector<std::pair<int, MapConfig>>
   get_maps_for_round_type(RoundType round_type) {
@@ -58,7 +100,12 @@ struct MapManager {
   }
 
   void create_map() {
+    // a new match; everything random from here on follows the match seed
+    replay::seed_match();
     cleanup_map_generated_entities();
+    // shots and skid marks from the last round shouldn't carry over
+    ProjectilePool::get().clear();
+    SkidDecals::get().request_clear();
 
     if (selected_map_index == RANDOM_MAP_INDEX) {
       auto maps =
@@ -70,25 +117,41 @@ struct MapManager {
       }
     }
 
+    NavGrid::get().clear();
     if (selected_map_index >= 0 &&
         selected_map_index < static_cast<int>(available_maps.size())) {
-      available_maps[selected_map_index].create_map_func();
+      auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
+          afterhours::window_manager::ProvidesCurrentResolution>();
+      const MapDescription map = available_maps[selected_map_index].describe();
+      spawn(map, pcr->current_resolution);
+      build_nav_grid(map, pcr->current_resolution);
     }
+    StaticMapLayer::get().mark_static_entities();
   }
 
-  void initialize_preview_textures();
-  void generate_map_preview(int map_index);
-  void generate_all_previews();
-  [[nodiscard]] const raylib::RenderTexture2D &
-  get_preview_texture(int map_index) const;
-  void cleanup_preview_textures();
-  void cleanup_preview_area(int map_index);
+  static void spawn(const MapDescription &map,
+                    const afterhours::window_manager::Resolution &resolution);
+  // The immovable obstacles' rects; slicks, goo and balls don't block
+  // anything for good
+  [[nodiscard]] static std::vector<raylib::Rectangle>
+  wall_rects(const MapDescription &map,
+             const afterhours::window_manager::Resolution &resolution);
+  // Walls only; karts drive through slicks and goo
+  static void
+  build_nav_grid(const MapDescription &map,
+                 const afterhours::window_manager::Resolution &resolution);
+
+  // Needs the window; the first call per map may draw it
+  [[nodiscard]] const raylib::Texture2D &get_preview_texture(int map_index);
+  void release_previews();
 
 private:
-  static void create_arena_map();
-  static void create_maze_map();
-  static void create_race_map();
-  static void create_battle_map();
-  static void create_tagandgo_map();
-  static void create_test_map();
+  [[nodiscard]] raylib::Texture2D load_preview(int map_index) const;
+
+  static MapDescription describe_arena_map();
+  static MapDescription describe_maze_map();
+  static MapDescription describe_race_map();
+  static MapDescription describe_battle_map();
+  static MapDescription describe_tagandgo_map();
+  static MapDescription describe_test_map();
 };
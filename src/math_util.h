@@ -82,6 +82,19 @@ constexpr static int truncate_to_seconds(float total_seconds) {
   return static_cast<int>(total_seconds) % 60;
 }
 
+// The simulation draws its random numbers from here and from rand(), so
+// seeding both is enough to make a match repeat exactly (see replay.h).
+inline std::mt19937_64 &sim_rng() {
+  static std::mt19937_64 rng{std::random_device{}()};
+  return rng;
+}
+
+inline void seed_sim_rng(uint64_t seed) {
+  sim_rng().seed(seed);
+  std::srand(static_cast<unsigned>(seed));
+  raylib::SetRandomSeed(static_cast<unsigned>(seed));
+}
+
 static vec2 vec_rand_in_box(const Rectangle &rect) {
   return vec2{
       rect.x + static_cast<float>(rand() % static_cast<int>(rect.width)),
@@ -4,6 +4,7 @@
 
 #include "game.h"
 #include "input_mapping.h"
+#include "post_fx.h"
 #include "rl.h"
 #include "settings.h"
 #include <afterhours/src/plugins/input_system.h>
@@ -25,8 +26,23 @@ inline int mouse_button_clicked = 0;
 inline std::map<int, afterhours::input::ValidInputs> action_mapping;
 
 inline std::vector<uint8_t> capture_screenshot() {
-    raylib::Image img = raylib::LoadImageFromTexture(screenRT.texture);
+    // screenRT only holds the UI now; put the frame back together the same
+    // way RenderPostFxToWindow does, minus the letterboxing
+    const int w = screenRT.texture.width;
+    const int h = screenRT.texture.height;
+    raylib::RenderTexture2D frame = raylib::LoadRenderTexture(w, h);
+    raylib::BeginTextureMode(frame);
+    raylib::ClearBackground(raylib::BLACK);
+    auto &post_fx = PostFx::get();
+    post_fx.compose(mainRT.texture, screenRT.texture,
+                    {0.f, 0.f, (float)w, (float)h},
+                    post_fx.effects(Settings::get_post_processing_enabled()),
+                    vec2{(float)w, (float)h});
+    raylib::EndTextureMode();
+
+    raylib::Image img = raylib::LoadImageFromTexture(frame.texture);
     raylib::ImageFlipVertical(&img);
+    raylib::UnloadRenderTexture(frame);
     
     int file_size = 0;
     unsigned char* png_data = raylib::ExportImageToMemory(img, "png", &file_size);
@@ -144,62 +144,20 @@ private:
 
   // Set common uniforms for a shader
   void set_common_uniforms(ShaderType shader_type,
-                           const raylib::Shader &shader) {
-    auto &shader_lib = ShaderLibrary::get();
-
-    // Set time uniform if available
-    int time_loc =
-        shader_lib.get_uniform_location(shader_type, UniformLocation::Time);
-    if (time_loc != -1) {
-      float time = static_cast<float>(raylib::GetTime());
-      raylib::SetShaderValue(shader, time_loc, &time,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-
-    // Set resolution uniform if available
-    int resolution_loc = shader_lib.get_uniform_location(
-        shader_type, UniformLocation::Resolution);
-    if (resolution_loc != -1) {
-      raylib::Vector2 resolution = {
-          static_cast<float>(raylib::GetScreenWidth()),
-          static_cast<float>(raylib::GetScreenHeight())};
-      raylib::SetShaderValue(shader, resolution_loc, &resolution,
-                             raylib::SHADER_UNIFORM_VEC2);
-    }
+                           const raylib::Shader & /* shader */) {
+    ShaderLibrary::get().set_common_uniforms(shader_type);
   }
 
   // Set entity-specific uniforms
-  void set_entity_uniforms(ShaderType shader_type, const raylib::Shader &shader,
+  void set_entity_uniforms(ShaderType shader_type,
+                           const raylib::Shader & /* shader */,
                            const raylib::Color &color, float speed = 0.0f,
                            bool is_winner = false) {
     auto &shader_lib = ShaderLibrary::get();
-
-    // Set entity color uniform if available
-    int color_loc = shader_lib.get_uniform_location(
-        shader_type, UniformLocation::EntityColor);
-    if (color_loc != -1) {
-      raylib::Vector4 color_vec = {color.r / 255.0f, color.g / 255.0f,
-                                   color.b / 255.0f, color.a / 255.0f};
-      raylib::SetShaderValue(shader, color_loc, &color_vec,
-                             raylib::SHADER_UNIFORM_VEC4);
-    }
-
-    // Set speed uniform if available
-    int speed_loc =
-        shader_lib.get_uniform_location(shader_type, UniformLocation::Speed);
-    if (speed_loc != -1) {
-      raylib::SetShaderValue(shader, speed_loc, &speed,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-
-    // Set winner rainbow uniform if available
-    int rainbow_loc = shader_lib.get_uniform_location(
-        shader_type, UniformLocation::WinnerRainbow);
-    if (rainbow_loc != -1) {
-      float rainbow_value = is_winner ? 1.0f : 0.0f;
-      raylib::SetShaderValue(shader, rainbow_loc, &rainbow_value,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
+    shader_lib.set_uniform(shader_type, UniformLocation::EntityColor, color);
+    shader_lib.set_uniform(shader_type, UniformLocation::Speed, speed);
+    shader_lib.set_uniform(shader_type, UniformLocation::WinnerRainbow,
+                           is_winner ? 1.0f : 0.0f);
   }
 
   // Configure a render pass
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "math_util.h"
+#include "rl.h"
+#include <afterhours/src/singleton.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+// Coarse occupancy grid of the current map plus cached flow fields over it,
+// so AI karts can steer around walls instead of straight at their target.
+//
+// The grid is built once per map (MapManager::create_map) from the
+// obstacle rects, each grown by CLEARANCE so a kart centered in a free cell
+// doesn't scrape the wall. A flow field is one Dijkstra pass out from a goal
+// cell; every free cell ends up pointing at the neighbour that is one step
+// closer. Fields are keyed by goal cell and shared, so eight karts chasing
+// the same hippo cost one field, and a moving goal only costs a new field
+// when it crosses into another cell. Looking up a direction is then a cell
+// index and two array reads.
+//
+// Fields nobody asked for in STALE_TICKS ticks are dropped, and at most
+// MAX_BUILDS_PER_TICK new ones are built per tick; a kart whose field
+// wasn't built yet steers straight for that tick, like it used to.
+SINGLETON_FWD(NavGrid)
+struct NavGrid {
+  SINGLETON(NavGrid)
+
+  static constexpr float CELL = 16.f;
+  // about half a kart's length
+  static constexpr float CLEARANCE = 12.f;
+  static constexpr int MAX_BUILDS_PER_TICK = 8;
+  static constexpr uint64_t STALE_TICKS = 30;
+  // how far nearest_free looks for an open cell, in cells
+  static constexpr int FREE_SEARCH_RADIUS = 4;
+  static constexpr uint32_t UNREACHABLE = 0xffffffffu;
+
+  struct FlowField {
+    int goal = -1;
+    // path cost to the goal, 10 per straight step and 14 per diagonal
+    std::vector<uint32_t> cost;
+    // the cell to head for next, -1 at the goal or if unreachable
+    std::vector<int32_t> next;
+    uint64_t last_used = 0;
+  };
+
+  int cols = 0;
+  int rows = 0;
+  std::vector<uint8_t> blocked;
+  std::unordered_map<int, FlowField> fields;
+
+  uint64_t tick = 0;
+  int builds_this_tick = 0;
+  // for the benchmark
+  size_t builds_total = 0;
+
+  [[nodiscard]] bool empty() const { return cols == 0 || rows == 0; }
+
+  void clear() {
+    cols = 0;
+    rows = 0;
+    blocked.clear();
+    fields.clear();
+  }
+
+  void build(const std::vector<raylib::Rectangle> &solid, float width,
+             float height) {
+    clear();
+    cols = static_cast<int>(std::ceil(width / CELL));
+    rows = static_cast<int>(std::ceil(height / CELL));
+    blocked.assign(static_cast<size_t>(cols * rows), 0);
+
+    for (const raylib::Rectangle &r : solid) {
+      const int x0 = std::max(0, cell_coord(r.x - CLEARANCE));
+      const int y0 = std::max(0, cell_coord(r.y - CLEARANCE));
+      const int x1 =
+          std::min(cols - 1, cell_coord(r.x + r.width + CLEARANCE));
+      const int y1 =
+          std::min(rows - 1, cell_coord(r.y + r.height + CLEARANCE));
+      for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+          blocked[static_cast<size_t>(index(x, y))] = 1;
+        }
+      }
+    }
+  }
+
+  // -1 off the grid
+  [[nodiscard]] int cell_of(vec2 pos) const {
+    const int x = cell_coord(pos.x);
+    const int y = cell_coord(pos.y);
+    if (x < 0 || y < 0 || x >= cols || y >= rows)
+      return -1;
+    return index(x, y);
+  }
+
+  [[nodiscard]] vec2 center(int cell) const {
+    return vec2{((cell % cols) + 0.5f) * CELL, ((cell / cols) + 0.5f) * CELL};
+  }
+
+  [[nodiscard]] bool is_blocked(int cell) const {
+    return blocked[static_cast<size_t>(cell)] != 0;
+  }
+
+  // Called once per tick before the AI runs
+  void begin_tick() {
+    tick++;
+    builds_this_tick = 0;
+    std::erase_if(fields, [&](const auto &entry) {
+      return entry.second.last_used + STALE_TICKS < tick;
+    });
+  }
+
+  // The field leading to `goal`, or nullptr if there is no grid, the goal is
+  // walled in, or this tick's build budget is spent. With may_build false
+  // only an already built field is returned.
+  const FlowField *field_to(vec2 goal, bool may_build = true) {
+    if (empty())
+      return nullptr;
+    const int goal_cell = nearest_free(cell_of(clamp_to_grid(goal)));
+    if (goal_cell < 0)
+      return nullptr;
+
+    auto it = fields.find(goal_cell);
+    if (it == fields.end()) {
+      if (!may_build || builds_this_tick >= MAX_BUILDS_PER_TICK)
+        return nullptr;
+      builds_this_tick++;
+      builds_total++;
+      it = fields.emplace(goal_cell, compute(goal_cell)).first;
+    }
+    it->second.last_used = tick;
+    return &it->second;
+  }
+
+  // Same as field_to without building or touching anything, for the AI
+  // worker threads (see ai_decisions.h)
+  [[nodiscard]] const FlowField *find_field(vec2 goal) const {
+    if (empty())
+      return nullptr;
+    const int goal_cell = nearest_free(cell_of(clamp_to_grid(goal)));
+    if (goal_cell < 0)
+      return nullptr;
+    const auto it = fields.find(goal_cell);
+    return it == fields.end() ? nullptr : &it->second;
+  }
+
+  // Where to aim to follow `field` from `from`: the center of the cell two
+  // steps along, which smooths out the 45 degree turns, or the goal itself
+  // once it is that close
+  [[nodiscard]] vec2 steer_point(const FlowField &field, vec2 from,
+                                 vec2 goal) const {
+    const int cell = cell_of(from);
+    if (cell < 0)
+      return goal;
+    const int step = field.next[static_cast<size_t>(cell)];
+    if (step < 0 || step == field.goal)
+      return goal;
+    const int ahead = field.next[static_cast<size_t>(step)];
+    if (ahead < 0 || ahead == field.goal)
+      return goal;
+    return center(ahead);
+  }
+
+  // Downhill on the threat's field is toward the threat, so fleeing picks
+  // the open neighbour that is furthest from it. nullopt when cornered.
+  [[nodiscard]] std::optional<vec2> flee_direction(const FlowField &threat,
+                                                   vec2 from) const {
+    const int cell = cell_of(from);
+    if (cell < 0)
+      return std::nullopt;
+
+    uint32_t best = threat.cost[static_cast<size_t>(cell)];
+    if (best == UNREACHABLE)
+      best = 0;
+    int best_cell = -1;
+    for_each_neighbour(cell, [&](int n, uint32_t) {
+      const uint32_t c = threat.cost[static_cast<size_t>(n)];
+      if (c != UNREACHABLE && c > best) {
+        best = c;
+        best_cell = n;
+      }
+    });
+    if (best_cell < 0)
+      return std::nullopt;
+    return vec_norm(center(best_cell) - from);
+  }
+
+private:
+  [[nodiscard]] static int cell_coord(float v) {
+    return static_cast<int>(std::floor(v / CELL));
+  }
+
+  [[nodiscard]] int index(int x, int y) const { return (y * cols) + x; }
+
+  [[nodiscard]] vec2 clamp_to_grid(vec2 pos) const {
+    return vec2{std::clamp(pos.x, 0.f, (cols * CELL) - 1.f),
+                std::clamp(pos.y, 0.f, (rows * CELL) - 1.f)};
+  }
+
+  // Closest open cell to `cell` (itself if open), -1 if none nearby
+  [[nodiscard]] int nearest_free(int cell) const {
+    if (cell < 0 || !is_blocked(cell))
+      return cell;
+    const int cx = cell % cols;
+    const int cy = cell / cols;
+    for (int r = 1; r <= FREE_SEARCH_RADIUS; r++) {
+      for (int y = cy - r; y <= cy + r; y++) {
+        for (int x = cx - r; x <= cx + r; x++) {
+          if (std::abs(x - cx) != r && std::abs(y - cy) != r)
+            continue;
+          if (x < 0 || y < 0 || x >= cols || y >= rows)
+            continue;
+          if (!is_blocked(index(x, y)))
+            return index(x, y);
+        }
+      }
+    }
+    return -1;
+  }
+
+  // Open 8-neighbours of `cell` with the step cost. Diagonals need both
+  // sides open so paths don't cut wall corners.
+  template <typename Fn> void for_each_neighbour(int cell, Fn &&fn) const {
+    const int x = cell % cols;
+    const int y = cell / cols;
+    for (int dy = -1; dy <= 1; dy++) {
+      for (int dx = -1; dx <= 1; dx++) {
+        if (dx == 0 && dy == 0)
+          continue;
+        const int nx = x + dx;
+        const int ny = y + dy;
+        if (nx < 0 || ny < 0 || nx >= cols || ny >= rows)
+          continue;
+        if (is_blocked(index(nx, ny)))
+          continue;
+        const bool diagonal = dx != 0 && dy != 0;
+        if (diagonal &&
+            (is_blocked(index(x + dx, y)) || is_blocked(index(x, y + dy))))
+          continue;
+        fn(index(nx, ny), diagonal ? 14u : 10u);
+      }
+    }
+  }
+
+  [[nodiscard]] FlowField compute(int goal_cell) const {
+    const size_t n = static_cast<size_t>(cols * rows);
+    FlowField field;
+    field.goal = goal_cell;
+    field.cost.assign(n, UNREACHABLE);
+    field.next.assign(n, -1);
+
+    using Open = std::pair<uint32_t, int>;
+    std::priority_queue<Open, std::vector<Open>, std::greater<>> open;
+    field.cost[static_cast<size_t>(goal_cell)] = 0;
+    open.push({0, goal_cell});
+    while (!open.empty()) {
+      const auto [cost, cell] = open.top();
+      open.pop();
+      if (cost > field.cost[static_cast<size_t>(cell)])
+        continue;
+      for_each_neighbour(cell, [&](int nb, uint32_t step) {
+        const uint32_t c = cost + step;
+        if (c < field.cost[static_cast<size_t>(nb)]) {
+          field.cost[static_cast<size_t>(nb)] = c;
+          field.next[static_cast<size_t>(nb)] = cell;
+          open.push({c, nb});
+        }
+      });
+    }
+
+    // A kart can still end up over a blocked cell (clearance, getting
+    // bumped); point those at their cheapest open neighbour so it backs out
+    for (size_t i = 0; i < n; i++) {
+      if (!blocked[i])
+        continue;
+      uint32_t best = UNREACHABLE;
+      for_each_neighbour(static_cast<int>(i), [&](int nb, uint32_t) {
+        if (field.cost[static_cast<size_t>(nb)] < best) {
+          best = field.cost[static_cast<size_t>(nb)];
+          field.next[i] = nb;
+        }
+      });
+    }
+    return field;
+  }
+};
+
+// Ages out flow fields and resets the per-tick build budget; registered
+// just before the AI systems
+struct UpdateNavGrid : afterhours::System<> {
+  virtual void once(float) override { NavGrid::get().begin_tick(); }
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "log.h"
+#include "rl.h"
+#include <afterhours/src/singleton.h>
+#include <array>
+#include <cstdint>
+#include <string>
+
+// The whole post-processing chain as a single full-screen pass.
+//
+// The world (mainRT) and the UI (screenRT, drawn over a transparent clear)
+// are composited straight to the window by one shader built from
+// resources/shaders/post_fx.fs. Each effect is a #define in that file, and
+// only the ones active this frame are compiled in; the variants are built
+// the first time they are needed and kept.
+//
+// This replaced a copy of the world into screenRT through a spotlight
+// shader, then a copy of screenRT to the window through a base effects
+// shader: two full-screen passes per frame, even with the spotlight off.
+SINGLETON_FWD(PostFx)
+struct PostFx {
+  SINGLETON(PostFx)
+
+  enum Effect : uint8_t {
+    Spotlight = 1 << 0,
+    BaseFx = 1 << 1,
+  };
+  static constexpr size_t NUM_VARIANTS = 4;
+
+  static constexpr const char *VERTEX_PATH = "resources/shaders/base.vs";
+  static constexpr const char *FRAGMENT_PATH = "resources/shaders/post_fx.fs";
+
+  // Filled in by ConfigureTaggerSpotlight each frame
+  struct SpotlightParams {
+    bool enabled = false;
+    vec2 pos{0.5f, 0.5f};
+    float radius = 0.f;
+    float softness = 0.f;
+    float dim = 0.f;
+    float desaturate = 0.f;
+  } spotlight;
+
+  struct Variant {
+    bool tried = false;
+    bool loaded = false;
+    raylib::Shader shader{};
+    int time = -1;
+    int resolution = -1;
+    int ui_texture = -1;
+    int spotlight_pos = -1;
+    int spotlight_radius = -1;
+    int spotlight_softness = -1;
+    int dim = -1;
+    int desaturate = -1;
+  };
+  std::array<Variant, NUM_VARIANTS> variants;
+
+  // last frame, for the profiler overlay
+  uint8_t last_effects = 0;
+  int full_screen_passes = 0;
+
+  [[nodiscard]] uint8_t effects(bool base_fx) const {
+    return static_cast<uint8_t>((spotlight.enabled ? Spotlight : 0) |
+                                (base_fx ? BaseFx : 0));
+  }
+
+  // "spotlight + base fx", "composite only", ...
+  static std::string describe(uint8_t effects) {
+    std::string out;
+    if (effects & Spotlight)
+      out += "spotlight";
+    if (effects & BaseFx)
+      out += out.empty() ? "base fx" : " + base fx";
+    return out.empty() ? "composite only" : out;
+  }
+
+  // post_fx.fs with the #defines for `effects` after its #version line
+  static std::string variant_source(const std::string &source,
+                                    uint8_t effects) {
+    std::string defines;
+    if (effects & Spotlight)
+      defines += "#define SPOTLIGHT\n";
+    if (effects & BaseFx)
+      defines += "#define BASE_FX\n";
+
+    const size_t line_end = source.find('\n');
+    if (line_end == std::string::npos)
+      return defines + source;
+    return source.substr(0, line_end + 1) + defines +
+           source.substr(line_end + 1);
+  }
+
+  // nullptr if the variant did not compile; the caller falls back to a plain
+  // draw of the world
+  Variant *variant(uint8_t effects) {
+    Variant &v = variants[effects];
+    if (!v.tried) {
+      v.tried = true;
+      load(v, effects);
+    }
+    return v.loaded ? &v : nullptr;
+  }
+
+  // Draws the world with the UI over it into dst of whatever is bound (the
+  // window, normally). Must not be inside a shader mode.
+  void compose(const raylib::Texture2D &world, const raylib::Texture2D &ui,
+               raylib::Rectangle dst, uint8_t effects, vec2 resolution) {
+    last_effects = effects;
+    full_screen_passes = 1;
+
+    // render textures are stored upside down
+    const raylib::Rectangle src{0.f, 0.f, (float)world.width,
+                                -(float)world.height};
+    Variant *v = variant(effects);
+    if (!v) {
+      raylib::DrawTexturePro(world, src, dst, {0.f, 0.f}, 0.f, raylib::WHITE);
+      // the UI target holds premultiplied color, see BeginUIRender
+      raylib::BeginBlendMode(raylib::BLEND_ALPHA_PREMULTIPLY);
+      raylib::DrawTexturePro(
+          ui, {0.f, 0.f, (float)ui.width, -(float)ui.height}, dst,
+          {0.f, 0.f}, 0.f, raylib::WHITE);
+      raylib::EndBlendMode();
+      full_screen_passes = 2;
+      return;
+    }
+
+    raylib::BeginShaderMode(v->shader);
+    set_uniforms(*v, effects, resolution);
+    raylib::SetShaderValueTexture(v->shader, v->ui_texture, ui);
+    raylib::DrawTexturePro(world, src, dst, {0.f, 0.f}, 0.f, raylib::WHITE);
+    raylib::EndShaderMode();
+  }
+
+  void unload_all() {
+    for (Variant &v : variants) {
+      if (v.loaded) {
+        raylib::UnloadShader(v.shader);
+      }
+      v = Variant{};
+    }
+  }
+
+private:
+  void load(Variant &v, uint8_t effects) {
+    char *fragment = raylib::LoadFileText(FRAGMENT_PATH);
+    char *vertex = raylib::LoadFileText(VERTEX_PATH);
+    if (!fragment || !vertex) {
+      log_error("post fx: could not read {} or {}", FRAGMENT_PATH,
+                VERTEX_PATH);
+    } else {
+      const std::string source = variant_source(fragment, effects);
+      v.shader = raylib::LoadShaderFromMemory(vertex, source.c_str());
+      // raylib hands back its default shader when compiling fails
+      v.loaded = raylib::IsShaderValid(v.shader) &&
+                 v.shader.id != raylib::rlGetShaderIdDefault();
+      if (!v.loaded) {
+        log_error("post fx: variant {} failed to compile", effects);
+      }
+    }
+    if (fragment)
+      raylib::UnloadFileText(fragment);
+    if (vertex)
+      raylib::UnloadFileText(vertex);
+    if (!v.loaded)
+      return;
+
+    const auto loc = [&](const char *name) {
+      return raylib::GetShaderLocation(v.shader, name);
+    };
+    v.time = loc("time");
+    v.resolution = loc("resolution");
+    v.ui_texture = loc("uiTexture");
+    v.spotlight_pos = loc("spotlightPos");
+    v.spotlight_radius = loc("spotlightRadius");
+    v.spotlight_softness = loc("spotlightSoftness");
+    v.dim = loc("dimAmount");
+    v.desaturate = loc("desaturateAmount");
+  }
+
+  static void set_float(const Variant &v, int loc, float value) {
+    if (loc != -1)
+      raylib::SetShaderValue(v.shader, loc, &value,
+                             raylib::SHADER_UNIFORM_FLOAT);
+  }
+
+  void set_uniforms(const Variant &v, uint8_t effects, vec2 resolution) const {
+    set_float(v, v.time, static_cast<float>(raylib::GetTime()));
+    if (v.resolution != -1)
+      raylib::SetShaderValue(v.shader, v.resolution, &resolution,
+                             raylib::SHADER_UNIFORM_VEC2);
+    if (!(effects & Spotlight))
+      return;
+    if (v.spotlight_pos != -1)
+      raylib::SetShaderValue(v.shader, v.spotlight_pos, &spotlight.pos,
+                             raylib::SHADER_UNIFORM_VEC2);
+    set_float(v, v.spotlight_radius, spotlight.radius);
+    set_float(v, v.spotlight_softness, spotlight.softness);
+    set_float(v, v.dim, spotlight.dim);
+    set_float(v, v.desaturate, spotlight.desaturate);
+  }
+};
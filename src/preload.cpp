@@ -85,14 +85,6 @@ Preload &Preload::init(const char *title) {
       files::get_resource_path("sounds", "replace/cobolt.mp3").string().c_str(),
       "menu_music");
 
-  ShaderLibrary::get().load(
-      files::get_resource_path("shaders", "post_processing.fs").string().c_str(),
-      "post_processing");
-
-  ShaderLibrary::get().load(
-      files::get_resource_path("shaders", "post_processing_tag.fs").string().c_str(),
-      "post_processing_tag");
-
   ShaderLibrary::get().load(
       files::get_resource_path("shaders", "entity_test.fs").string().c_str(),
       "entity_test");
@@ -134,6 +126,13 @@ Preload &Preload::init(const char *title) {
   return *this;
 }
 
+Preload &Preload::init_headless() {
+  headless = true;
+  raylib::SetTraceLogLevel(raylib::LOG_ERROR);
+  load_gamepad_mappings();
+  return *this;
+}
+
 void setup_fonts(Entity &sophie) {
   sophie.get<ui::FontManager>().load_font(
       get_font_name(FontID::English),
@@ -155,6 +154,21 @@ void setup_fonts(Entity &sophie) {
 Preload &Preload::make_singleton() {
   // sophie
   auto &sophie = EntityHelper::createEntity();
+  if (headless) {
+    input::add_singleton_components(sophie, get_mapping());
+
+    // window_manager would ask raylib for the monitor size, so just use the
+    // configured resolution
+    auto &pcr =
+        sophie.addComponent<window_manager::ProvidesCurrentResolution>();
+    pcr.current_resolution = Settings::get().resolution;
+    EntityHelper::registerSingleton<window_manager::ProvidesCurrentResolution>(
+        sophie);
+
+    sophie.addComponent<ManagesAvailableColors>();
+    EntityHelper::registerSingleton<ManagesAvailableColors>(sophie);
+    return *this;
+  }
   {
     input::add_singleton_components(sophie, get_mapping());
     window_manager::add_singleton_components(sophie, 200);
@@ -199,6 +213,8 @@ Preload &Preload::make_singleton() {
 }
 
 Preload::~Preload() {
+  if (headless)
+    return;
   if (raylib::IsAudioDeviceReady()) {
     // nothing to stop currently
   }
@@ -17,6 +17,11 @@ struct Preload {
   Preload(const Preload &) = delete;
   void operator=(const Preload &) = delete;
 
+  // No window, audio, shaders or textures; only the singletons the
+  // simulation systems need. Used by --headless.
+  bool headless = false;
+
   Preload &init(const char *title);
+  Preload &init_headless();
   Preload &make_singleton();
 };
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <afterhours/ah.h>
+#include <afterhours/src/singleton.h>
+#include <vector>
+
+// One-shot presses (boost, shoot, honk) carried from the frame that saw them
+// to the next fixed step.
+//
+// The input plugin collects once per rendered frame, but the gameplay that
+// acts on a press runs on SimulationClock's fixed steps: read straight from
+// InputCollector::inputs_pressed, a press would be lost on a frame that runs
+// no step (any frame rate above the tick rate) and acted on twice on one that
+// runs two. LatchPressedInputs adds each frame's presses to `pending`, the
+// fixed steps read them from there, and ConsumePressedInputs clears them at
+// the end of the first step that saw them.
+SINGLETON_FWD(PressedInputs)
+struct PressedInputs {
+  SINGLETON(PressedInputs)
+
+  std::vector<afterhours::input::ActionDone> pending;
+};
+
+// Per frame, after the input plugin
+struct LatchPressedInputs : afterhours::System<> {
+  virtual void once(float) override {
+    auto inpc = afterhours::input::get_input_collector();
+    if (!inpc.has_value())
+      return;
+    auto &pending = PressedInputs::get().pending;
+    for (const auto &pressed : inpc.inputs_pressed()) {
+      pending.push_back(pressed);
+    }
+  }
+};
+
+// Last thing in each fixed step
+struct ConsumePressedInputs : afterhours::System<> {
+  virtual void once(float) override { PressedInputs::get().pending.clear(); }
+};
@@ -0,0 +1,259 @@
+#include "profiler.h"
+
+#ifdef AFTER_HOURS_ENABLE_PROFILER
+
+#include "ai_scheduler.h"
+#include "draw_list.h"
+#include "dynamic_resolution.h"
+#include "library/shader_library.h"
+#include "post_fx.h"
+#include "visible_set.h"
+#include <algorithm>
+
+namespace profiler {
+
+namespace {
+
+float to_ms(Clock::duration d) {
+  return std::chrono::duration<float, std::milli>(d).count();
+}
+
+long long to_us(Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+// system names come from the type, but escape anyway so a stray quote or
+// backslash can't break the trace file
+std::string json_escape(const std::string &in) {
+  std::string out;
+  out.reserve(in.size());
+  for (char c : in) {
+    if (c == '"' || c == '\\')
+      out.push_back('\\');
+    out.push_back(c);
+  }
+  return out;
+}
+
+} // namespace
+
+void Profiler::end_frame() {
+  close(Clock::now());
+  const float frame_ms = to_ms(Clock::now() - frame_start);
+  avg_frame_ms += (frame_ms - avg_frame_ms) * SMOOTHING;
+
+  const auto &stats = ShaderLibrary::get().uniform_stats;
+  uniform_uploads = stats.uploads - uniform_uploads_seen;
+  uniform_skips = stats.skips - uniform_skips_seen;
+  uniform_uploads_seen = stats.uploads;
+  uniform_skips_seen = stats.skips;
+
+  for (size_t i = 0; i < slots.size(); i++) {
+    Slot &s = slots[i];
+    const float ms = to_ms(s.frame_time);
+    s.avg_ms += (ms - s.avg_ms) * SMOOTHING;
+    s.avg_entities +=
+        (static_cast<float>(s.frame_entities) - s.avg_entities) * SMOOTHING;
+    s.max_ms = std::max(s.max_ms * (1.f - SMOOTHING), ms);
+    s.last_calls = s.frame_calls;
+
+    if (csv.is_open() && s.frame_calls > 0) {
+      csv << fmt::format("{},{},\"{}\",{:.4f},{},{}\n", frame,
+                         magic_enum::enum_name(s.pass), s.name, ms,
+                         s.frame_entities, s.frame_calls);
+    }
+
+    s.frame_time = {};
+    s.frame_entities = 0;
+    s.frame_calls = 0;
+  }
+
+  if (trace.is_open()) {
+    for (const Event &e : frame_events) {
+      const Slot &s = slots[e.slot];
+      trace << fmt::format(
+          "{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{},"
+          "\"dur\":{},\"pid\":0,\"tid\":{}}}",
+          trace_needs_comma ? ",\n" : "", json_escape(s.name),
+          magic_enum::enum_name(s.pass), to_us(e.start - started),
+          to_us(e.duration), static_cast<int>(s.pass));
+      trace_needs_comma = true;
+    }
+    frame_events.clear();
+    trace << fmt::format(
+        "{}{{\"name\":\"uniforms\",\"ph\":\"C\",\"ts\":{},\"pid\":0,"
+        "\"args\":{{\"uploads\":{},\"skips\":{}}}}}",
+        trace_needs_comma ? ",\n" : "", to_us(Clock::now() - started),
+        uniform_uploads, uniform_skips);
+    trace_needs_comma = true;
+  }
+
+  frame++;
+}
+
+void Profiler::init(const std::string &csv_path,
+                    const std::string &trace_path) {
+  if (!csv_path.empty()) {
+    csv.open(csv_path);
+    if (!csv) {
+      log_error("profiler: could not open {} for writing", csv_path);
+    } else {
+      csv << "frame,pass,system,ms,entities,calls\n";
+    }
+  }
+  if (!trace_path.empty()) {
+    trace.open(trace_path);
+    if (!trace) {
+      log_error("profiler: could not open {} for writing", trace_path);
+    } else {
+      trace << "{\"traceEvents\":[\n";
+    }
+  }
+}
+
+void Profiler::shutdown() {
+  if (csv.is_open()) {
+    csv.close();
+  }
+  if (trace.is_open()) {
+    trace << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    trace.close();
+  }
+  log_info("profiler: recorded {} frames over {} systems", frame,
+           slots.size());
+}
+
+bool RenderProfilerOverlay::should_run(float) {
+  auto &prof = Profiler::get();
+  if (raylib::IsKeyPressed(raylib::KEY_F3)) {
+    prof.overlay_visible = !prof.overlay_visible;
+  }
+  if (prof.overlay_visible && raylib::IsKeyPressed(raylib::KEY_F4)) {
+    prof.sort_by = magic_enum::enum_value<Profiler::SortBy>(
+        (magic_enum::enum_index(prof.sort_by).value() + 1) %
+        magic_enum::enum_count<Profiler::SortBy>());
+  }
+  return prof.overlay_visible;
+}
+
+void RenderProfilerOverlay::for_each_with(
+    const afterhours::Entity &,
+    const afterhours::window_manager::ProvidesCurrentResolution &pcr,
+    float) const {
+  constexpr int MAX_ROWS = 24;
+  constexpr int FONT = 12;
+  constexpr int ROW_H = 14;
+  constexpr int WIDTH = 460;
+  // budget for a 60hz display
+  constexpr float FRAME_BUDGET_MS = 1000.f / 60.f;
+
+  const auto &prof = Profiler::get();
+
+  std::vector<size_t> order(prof.slots.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::ranges::sort(order, [&](size_t a, size_t b) {
+    const auto &sa = prof.slots[a];
+    const auto &sb = prof.slots[b];
+    switch (prof.sort_by) {
+    case Profiler::SortBy::Time:
+      return sa.avg_ms > sb.avg_ms;
+    case Profiler::SortBy::Max:
+      return sa.max_ms > sb.max_ms;
+    case Profiler::SortBy::Entities:
+      return sa.avg_entities > sb.avg_entities;
+    case Profiler::SortBy::Calls:
+      return sa.last_calls > sb.last_calls;
+    case Profiler::SortBy::Name:
+      return sa.name < sb.name;
+    case Profiler::SortBy::Registration:
+      break;
+    }
+    return a < b;
+  });
+
+  // sit just left of RenderDebugWindowInfo
+  const int x = pcr.width() - 160 - WIDTH;
+  int y = 18;
+  const int rows = std::min(MAX_ROWS, static_cast<int>(order.size()));
+  raylib::DrawRectangle(x - 4, y - 4, WIDTH, (rows + 8) * ROW_H + 8,
+                        raylib::Fade(raylib::BLACK, 0.7f));
+
+  raylib::DrawText(
+      fmt::format("frame {:.2f}ms / {:.2f}ms  sort: {} (F4)", prof.avg_frame_ms,
+                  FRAME_BUDGET_MS, magic_enum::enum_name(prof.sort_by))
+          .c_str(),
+      x, y, FONT,
+      prof.avg_frame_ms > FRAME_BUDGET_MS ? raylib::RED : raylib::WHITE);
+  y += ROW_H;
+  raylib::DrawText(fmt::format("uniforms: {} uploaded, {} unchanged",
+                               prof.uniform_uploads, prof.uniform_skips)
+                       .c_str(),
+                   x, y, FONT, raylib::LIGHTGRAY);
+  y += ROW_H;
+  const auto &visible = VisibleSet::get();
+  raylib::DrawText(fmt::format("culling: {} drawn, {} culled", visible.drawn,
+                               visible.culled)
+                       .c_str(),
+                   x, y, FONT, raylib::LIGHTGRAY);
+  y += ROW_H;
+  const auto &draws = DrawList::get().stats;
+  raylib::DrawText(
+      fmt::format("draw state changes: {} sorted, {} unsorted ({} items)",
+                  draws.changes_sorted, draws.changes_unsorted, draws.items)
+          .c_str(),
+      x, y, FONT, raylib::LIGHTGRAY);
+  y += ROW_H;
+  const auto &dynamic = DynamicResolution::get();
+  raylib::DrawText(
+      fmt::format("world scale: {:.0f}%{}", dynamic.scale * 100.f,
+                  dynamic.enabled
+                      ? fmt::format(" (target {:.1f}ms)", dynamic.target_ms)
+                      : std::string(" (dynamic resolution off)"))
+          .c_str(),
+      x, y, FONT, raylib::LIGHTGRAY);
+  y += ROW_H;
+  const auto &ai = AIScheduler::get();
+  raylib::DrawText(
+      fmt::format("ai decisions: {} of {} due (cap {}), {} deferred "
+                  "(~{:.3f}ms each)",
+                  ai.admitted, ai.due, ai.cap, ai.deferred,
+                  ai.avg_decision_ms)
+          .c_str(),
+      x, y, FONT, ai.deferred > 0 ? raylib::YELLOW : raylib::LIGHTGRAY);
+  y += ROW_H;
+  const auto &post_fx = PostFx::get();
+  raylib::DrawText(fmt::format("post fx: {} full-screen pass{} ({})",
+                               post_fx.full_screen_passes,
+                               post_fx.full_screen_passes == 1 ? "" : "es",
+                               PostFx::describe(post_fx.last_effects))
+                       .c_str(),
+                   x, y, FONT, raylib::LIGHTGRAY);
+  y += ROW_H;
+  raylib::DrawText(
+      fmt::format("{:<30} {:>6} {:>7} {:>7} {:>6} {:>5}", "system", "pass",
+                  "avg ms", "max ms", "ents", "calls")
+          .c_str(),
+      x, y, FONT, raylib::LIGHTGRAY);
+  y += ROW_H;
+
+  for (int i = 0; i < rows; i++) {
+    const auto &s = prof.slots[order[static_cast<size_t>(i)]];
+    const float share = s.avg_ms / FRAME_BUDGET_MS;
+    const raylib::Color col = share > 0.25f   ? raylib::RED
+                              : share > 0.05f ? raylib::YELLOW
+                                              : raylib::WHITE;
+    raylib::DrawText(fmt::format("{:<30.30} {:>6.6} {:>7.3f} {:>7.3f} {:>6.0f} "
+                                 "{:>5}",
+                                 s.name, magic_enum::enum_name(s.pass),
+                                 s.avg_ms, s.max_ms, s.avg_entities,
+                                 s.last_calls)
+                         .c_str(),
+                     x, y, FONT, col);
+    y += ROW_H;
+  }
+}
+
+} // namespace profiler
+
+#endif
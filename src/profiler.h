@@ -0,0 +1,298 @@
+#pragma once
+
+#include "rl.h"
+#include <afterhours/src/singleton.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// Per-system frame profiler, compiled in with AFTER_HOURS_ENABLE_PROFILER
+// (`make PROFILE=1` / `xmake f --profiler=y`).
+//
+// SystemManager runs systems in registration order, so instead of patching
+// it we register a tiny marker system in front of every real one. A marker
+// closes the section the previous marker opened and opens its own, which
+// bills the wall time in between to the system it precedes. Plugin batches
+// that register several systems at once get a single label_update() or
+// label_render().
+//
+// Without the define every helper below collapses to the plain
+// register_*_system call.
+namespace profiler {
+
+enum struct Pass { Fixed, Update, Render };
+
+#ifdef AFTER_HOURS_ENABLE_PROFILER
+
+using Clock = std::chrono::steady_clock;
+
+template <typename... Cs>
+size_t count_matching(const afterhours::System<Cs...> *) {
+  if constexpr (sizeof...(Cs) == 0) {
+    return 0;
+  } else {
+    size_t n = 0;
+    for (const auto &entity : afterhours::EntityHelper::get_entities()) {
+      if (entity && (entity->has<Cs>() && ...))
+        n++;
+    }
+    return n;
+  }
+}
+
+template <typename T> std::string type_name() {
+#if defined(__GNUG__)
+  int status = 0;
+  char *demangled =
+      abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+  std::string name = status == 0 ? demangled : typeid(T).name();
+  std::free(demangled);
+  return name;
+#else
+  return typeid(T).name();
+#endif
+}
+
+SINGLETON_FWD(Profiler)
+struct Profiler {
+  SINGLETON(Profiler)
+
+  static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+  // exponential smoothing for the overlay, roughly the last 30 frames
+  static constexpr float SMOOTHING = 1.f / 30.f;
+
+  struct Slot {
+    std::string name;
+    Pass pass;
+    std::function<size_t()> count;
+
+    // accumulated over the current frame
+    Clock::duration frame_time{};
+    size_t frame_entities = 0;
+    int frame_calls = 0;
+
+    // what the overlay shows
+    float avg_ms = 0.f;
+    float max_ms = 0.f;
+    float avg_entities = 0.f;
+    int last_calls = 0;
+  };
+
+  struct Event {
+    size_t slot;
+    Clock::time_point start;
+    Clock::duration duration;
+  };
+
+  enum struct SortBy { Time, Max, Entities, Calls, Name, Registration };
+
+  std::vector<Slot> slots;
+  std::map<const afterhours::SystemManager *, Pass> passes;
+
+  size_t open = NO_SLOT;
+  Clock::time_point open_at;
+
+  const Clock::time_point started = Clock::now();
+  Clock::time_point frame_start;
+  float avg_frame_ms = 0.f;
+  long long frame = 0;
+
+  // ShaderLibrary uniform writes last frame, and the ones it skipped because
+  // the value had not changed
+  size_t uniform_uploads = 0;
+  size_t uniform_skips = 0;
+  size_t uniform_uploads_seen = 0;
+  size_t uniform_skips_seen = 0;
+
+  bool overlay_visible = false;
+  SortBy sort_by = SortBy::Time;
+
+  std::ofstream csv;
+  std::ofstream trace;
+  bool trace_needs_comma = false;
+  std::vector<Event> frame_events;
+
+  [[nodiscard]] Pass pass_for(const afterhours::SystemManager &systems,
+                              Pass fallback) const {
+    auto it = passes.find(&systems);
+    return it == passes.end() ? fallback : it->second;
+  }
+
+  size_t add_slot(std::string name, Pass pass,
+                  std::function<size_t()> count = {}) {
+    slots.push_back(Slot{.name = std::move(name),
+                         .pass = pass,
+                         .count = std::move(count)});
+    return slots.size() - 1;
+  }
+
+  void hit(size_t slot) {
+    // counting walks every entity; do it before reading the clock so it is
+    // not billed to anyone
+    const size_t entities =
+        slot != NO_SLOT && slots[slot].count ? slots[slot].count() : 0;
+    const auto now = Clock::now();
+    close(now);
+    if (slot == NO_SLOT)
+      return;
+    Slot &s = slots[slot];
+    s.frame_entities += entities;
+    s.frame_calls++;
+    open = slot;
+    open_at = now;
+  }
+
+  void close(Clock::time_point now) {
+    if (open == NO_SLOT)
+      return;
+    slots[open].frame_time += now - open_at;
+    if (trace.is_open()) {
+      frame_events.push_back(Event{open, open_at, now - open_at});
+    }
+    open = NO_SLOT;
+  }
+
+  void begin_frame() { frame_start = Clock::now(); }
+  void end_frame();
+
+  void init(const std::string &csv_path, const std::string &trace_path);
+  void shutdown();
+};
+
+struct Mark : afterhours::System<> {
+  size_t slot;
+  explicit Mark(size_t slot_) : slot(slot_) {}
+  virtual void once(float) override { Profiler::get().hit(slot); }
+  virtual void once(float) const override { Profiler::get().hit(slot); }
+};
+
+// Sortable table of the slowest systems, F3 shows it and F4 cycles the sort
+// column.
+struct RenderProfilerOverlay
+    : afterhours::System<
+          afterhours::window_manager::ProvidesCurrentResolution> {
+  virtual bool should_run(float) override;
+  virtual void for_each_with(
+      const afterhours::Entity &,
+      const afterhours::window_manager::ProvidesCurrentResolution &,
+      float) const override;
+};
+
+inline void set_pass(afterhours::SystemManager &systems, Pass pass) {
+  Profiler::get().passes[&systems] = pass;
+}
+
+template <typename T>
+void register_update(afterhours::SystemManager &systems,
+                     std::unique_ptr<T> system) {
+  auto &prof = Profiler::get();
+  const T *raw = system.get();
+  const size_t slot =
+      prof.add_slot(type_name<T>(), prof.pass_for(systems, Pass::Update),
+                    [raw]() { return count_matching(raw); });
+  systems.register_update_system(std::make_unique<Mark>(slot));
+  systems.register_update_system(std::move(system));
+}
+
+template <typename T>
+void register_render(afterhours::SystemManager &systems,
+                     std::unique_ptr<T> system) {
+  auto &prof = Profiler::get();
+  const T *raw = system.get();
+  const size_t slot = prof.add_slot(type_name<T>(), Pass::Render,
+                                    [raw]() { return count_matching(raw); });
+  systems.register_render_system(std::make_unique<Mark>(slot));
+  systems.register_render_system(std::move(system));
+}
+
+template <typename Fn>
+void register_update(afterhours::SystemManager &systems, const char *name,
+                     Fn &&fn) {
+  auto &prof = Profiler::get();
+  const size_t slot =
+      prof.add_slot(name, prof.pass_for(systems, Pass::Update));
+  systems.register_update_system(std::make_unique<Mark>(slot));
+  systems.register_update_system(std::forward<Fn>(fn));
+}
+
+// Bills whatever gets registered next (until the next marker) to `name`
+inline void label_update(afterhours::SystemManager &systems, const char *name) {
+  auto &prof = Profiler::get();
+  systems.register_update_system(std::make_unique<Mark>(
+      prof.add_slot(name, prof.pass_for(systems, Pass::Update))));
+}
+
+inline void label_render(afterhours::SystemManager &systems, const char *name) {
+  systems.register_render_system(
+      std::make_unique<Mark>(Profiler::get().add_slot(name, Pass::Render)));
+}
+
+// Closes the last section of a pass so EntityHelper::cleanup() and the gap
+// before the next pass are not billed to its last system
+inline void end_updates(afterhours::SystemManager &systems) {
+  systems.register_update_system(std::make_unique<Mark>(Profiler::NO_SLOT));
+}
+
+inline void end_renders(afterhours::SystemManager &systems) {
+  systems.register_render_system(std::make_unique<Mark>(Profiler::NO_SLOT));
+}
+
+inline void register_overlay(afterhours::SystemManager &systems) {
+  systems.register_render_system(std::make_unique<RenderProfilerOverlay>());
+}
+
+inline void begin_frame() { Profiler::get().begin_frame(); }
+inline void end_frame() { Profiler::get().end_frame(); }
+inline void init(const std::string &csv_path, const std::string &trace_path) {
+  Profiler::get().init(csv_path, trace_path);
+}
+inline void shutdown() { Profiler::get().shutdown(); }
+
+#else
+
+inline void set_pass(afterhours::SystemManager &, Pass) {}
+
+template <typename T>
+void register_update(afterhours::SystemManager &systems,
+                     std::unique_ptr<T> system) {
+  systems.register_update_system(std::move(system));
+}
+
+template <typename T>
+void register_render(afterhours::SystemManager &systems,
+                     std::unique_ptr<T> system) {
+  systems.register_render_system(std::move(system));
+}
+
+template <typename Fn>
+void register_update(afterhours::SystemManager &systems, const char *,
+                     Fn &&fn) {
+  systems.register_update_system(std::forward<Fn>(fn));
+}
+
+inline void label_update(afterhours::SystemManager &, const char *) {}
+inline void label_render(afterhours::SystemManager &, const char *) {}
+inline void end_updates(afterhours::SystemManager &) {}
+inline void end_renders(afterhours::SystemManager &) {}
+inline void register_overlay(afterhours::SystemManager &) {}
+inline void begin_frame() {}
+inline void end_frame() {}
+inline void init(const std::string &csv_path, const std::string &trace_path) {
+  if (!csv_path.empty() || !trace_path.empty()) {
+    log_warn("profiler output requested but this build has no profiler, "
+             "rebuild with PROFILE=1");
+  }
+}
+inline void shutdown() {}
+
+#endif
+
+} // namespace profiler
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "components.h"
+#include <afterhours/src/singleton.h>
+#include <vector>
+
+// Bullets are too short-lived and too numerous to be entities: a machine gun
+// fires 25 a second per car and each one used to cost an entity, seven
+// components and a trip through EntityHelper::cleanup(). They live here
+// instead, as parallel arrays indexed by slot, with dead slots recycled
+// through a free list. Passes walk [0, high_water) and skip dead slots.
+//
+// See systems_projectiles.h for the passes that move, wrap, hit-test and
+// draw them.
+SINGLETON_FWD(ProjectilePool)
+struct ProjectilePool {
+  SINGLETON(ProjectilePool)
+
+  static constexpr size_t CAPACITY = 8192;
+  // what every bullet entity used to carry in its Transform
+  inline static const CollisionConfig COLLISION{
+      .mass = 1.f, .friction = 0.f, .restitution = 0.f};
+
+  struct Spawn {
+    vec2 position;
+    vec2 size;
+    vec2 velocity;
+    float angle;
+    float accel;
+    float lifetime;
+    int damage;
+    afterhours::Entity &source;
+    raylib::Color color;
+    bool can_wrap;
+    bool render_out_of_bounds;
+  };
+
+  // touched every tick
+  std::vector<float> x, y, prev_x, prev_y, vx, vy, lifetime;
+  std::vector<uint8_t> alive;
+  // touched on hits, wraps and draws
+  std::vector<float> w, h, angle, accel;
+  std::vector<int> damage;
+  std::vector<afterhours::EntityID> source_id;
+  std::vector<EntityIndex::Handle> source;
+  std::vector<raylib::Color> color;
+  std::vector<uint8_t> can_wrap, render_out_of_bounds;
+
+  std::vector<size_t> free_slots;
+  size_t high_water = 0;
+  size_t live = 0;
+  bool warned_full = false;
+
+  void allocate() {
+    for (auto *v : {&x, &y, &prev_x, &prev_y, &vx, &vy, &lifetime, &w, &h,
+                    &angle, &accel})
+      v->resize(CAPACITY);
+    for (auto *v : {&alive, &can_wrap, &render_out_of_bounds})
+      v->resize(CAPACITY);
+    damage.resize(CAPACITY);
+    source_id.resize(CAPACITY);
+    source.resize(CAPACITY);
+    color.resize(CAPACITY);
+    free_slots.reserve(CAPACITY);
+  }
+
+  bool spawn(const Spawn &s) {
+    if (alive.empty())
+      allocate();
+
+    size_t i;
+    if (!free_slots.empty()) {
+      i = free_slots.back();
+      free_slots.pop_back();
+    } else if (high_water < CAPACITY) {
+      i = high_water++;
+    } else {
+      if (!warned_full) {
+        log_warn("projectile pool is full ({}), dropping shots", CAPACITY);
+        warned_full = true;
+      }
+      return false;
+    }
+
+    x[i] = prev_x[i] = s.position.x;
+    y[i] = prev_y[i] = s.position.y;
+    vx[i] = s.velocity.x;
+    vy[i] = s.velocity.y;
+    w[i] = s.size.x;
+    h[i] = s.size.y;
+    angle[i] = s.angle;
+    accel[i] = s.accel;
+    lifetime[i] = s.lifetime;
+    damage[i] = s.damage;
+    source_id[i] = s.source.id;
+    source[i] = EntityIndex::get().handle_for(s.source);
+    color[i] = s.color;
+    can_wrap[i] = s.can_wrap;
+    render_out_of_bounds[i] = s.render_out_of_bounds;
+    alive[i] = 1;
+    live++;
+    return true;
+  }
+
+  void kill(size_t i) {
+    if (!alive[i])
+      return;
+    alive[i] = 0;
+    live--;
+    if (live == 0) {
+      // everything is dead, start packing from the front again
+      high_water = 0;
+      free_slots.clear();
+    } else {
+      free_slots.push_back(i);
+    }
+  }
+
+  void clear() {
+    for (size_t i = 0; i < high_water; i++) {
+      alive[i] = 0;
+    }
+    high_water = 0;
+    live = 0;
+    free_slots.clear();
+  }
+
+  // fn(slot) for every live projectile; fn may kill() the slot it is given
+  template <typename Fn> void for_each_live(Fn &&fn) {
+    for (size_t i = 0; i < high_water; i++) {
+      if (alive[i])
+        fn(i);
+    }
+  }
+
+  template <typename Fn> void for_each_live(Fn &&fn) const {
+    for (size_t i = 0; i < high_water; i++) {
+      if (alive[i])
+        fn(i);
+    }
+  }
+
+  [[nodiscard]] raylib::Rectangle rect(size_t i) const {
+    return raylib::Rectangle{x[i], y[i], w[i], h[i]};
+  }
+
+  // Same blend Transform::render_position() does for entities
+  [[nodiscard]] vec2 render_position(size_t i, float alpha) const {
+    const vec2 prev{prev_x[i], prev_y[i]};
+    const vec2 delta = vec2{x[i], y[i]} - prev;
+    if (vec_mag(delta) > Transform::MAX_INTERPOLATED_DISTANCE)
+      return vec2{x[i], y[i]};
+    return prev + (delta * alpha);
+  }
+};
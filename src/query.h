@@ -2,6 +2,7 @@
 #pragma once
 
 #include "components.h"
+#include "spatial_index.h"
 
 struct EQ : public afterhours::EntityQuery<EQ> {
   struct WhereInRange : afterhours::EntityQuery<EQ>::Modification {
@@ -52,6 +53,47 @@ struct EQ : public afterhours::EntityQuery<EQ> {
 
   EQ &whereOverlaps(const Rectangle r) { return add_mod(new WhereOverlaps(r)); }
 
+  // Index-backed versions of whereOverlaps / whereInRange for lookups that run
+  // once per entity. Candidates come straight out of the SpatialIndex buckets;
+  // if the index is stale (e.g. during render) this falls back to a scan.
+  template <typename... Components, typename Fn>
+  static void for_each_overlapping(const Rectangle &r, Fn &&fn) {
+    auto &index = SpatialIndex::get();
+    if (!index.valid) {
+      EQ query;
+      (query.whereHasComponent<Components>(), ...);
+      for (afterhours::Entity &entity : query.whereOverlaps(r).gen())
+        fn(entity);
+      return;
+    }
+    index.for_each_overlapping(r, [&](afterhours::Entity &entity) {
+      if ((entity.has<Components>() && ...))
+        fn(entity);
+    });
+  }
+
+  template <typename... Components>
+  static afterhours::RefEntities overlapping(const Rectangle &r) {
+    afterhours::RefEntities out;
+    for_each_overlapping<Components...>(
+        r, [&](afterhours::Entity &entity) { out.push_back(entity); });
+    return out;
+  }
+
+  template <typename... Components>
+  static afterhours::RefEntities in_range(const vec2 &position, float range) {
+    afterhours::RefEntities out;
+    const Rectangle bounds{position.x - range, position.y - range,
+                           range * 2.f, range * 2.f};
+    for_each_overlapping<Components...>(
+        bounds, [&](afterhours::Entity &entity) {
+          if (distance_sq(position, entity.get<Transform>().pos()) <
+              range * range)
+            out.push_back(entity);
+        });
+    return out;
+  }
+
   EQ &orderByPlayerID() {
     return orderByLambda([](const afterhours::Entity &a, const afterhours::Entity &b) {
       return a.get<PlayerID>().id < b.get<PlayerID>().id;
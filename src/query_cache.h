@@ -0,0 +1,111 @@
+#pragma once
+
+#include <afterhours/ah.h>
+#include <afterhours/src/singleton.h>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+// Entity lists keyed on a component signature, shared by every system that
+// asks for the same one. The AI used to run the same "all karts" query once
+// per AI per system per frame; now the first caller in a tick builds it and
+// everyone else reads the cached list.
+//
+// Nothing here is rebuilt on a timer. An entry goes stale when:
+//  - a maker creates an entity (create_entity() calls invalidate()),
+//  - anything it holds is flagged for cleanup (InvalidateQueryCache, run
+//    right before EntityHelper::cleanup() frees it),
+//  - the entity count changed behind our back (plugin and UI entities).
+// The signatures cached here are only ever added by the makers, so that also
+// covers component changes. Anything that adds or removes one of them on a
+// live entity has to call invalidate() itself.
+//
+// Per-entity state (is_tagger, collected, ...) is not part of the key; filter
+// it out of the cached list at the call site.
+SINGLETON_FWD(QueryCache)
+struct QueryCache {
+  SINGLETON(QueryCache)
+
+  using Refs = std::vector<afterhours::RefEntity>;
+
+  struct Entry {
+    Refs refs;
+    bool valid = false;
+  };
+
+  std::unordered_map<std::type_index, Entry> entries;
+  size_t entity_count = 0;
+  // lists built since startup; a handful per tick is the expected steady state
+  size_t builds = 0;
+
+  // Entities with every one of Cs
+  template <typename... Cs> const Refs &with() {
+    return lookup<All<Cs...>>([](const afterhours::Entity &e) {
+      return (e.has<Cs>() && ...);
+    });
+  }
+
+  // Entities with Required and at least one of Alternatives
+  template <typename Required, typename... Alternatives>
+  const Refs &with_any() {
+    return lookup<AnyOf<Required, Alternatives...>>(
+        [](const afterhours::Entity &e) {
+          return e.has<Required>() && (e.has<Alternatives>() || ...);
+        });
+  }
+
+  void invalidate() {
+    for (auto &[key, entry] : entries) {
+      entry.valid = false;
+    }
+  }
+
+  // True if any cached entity is about to be freed
+  [[nodiscard]] bool holds_cleanup() const {
+    for (const auto &[key, entry] : entries) {
+      if (!entry.valid)
+        continue;
+      for (const auto &ref : entry.refs) {
+        if (ref.get().cleanup)
+          return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  template <typename... Cs> struct All {};
+  template <typename... Cs> struct AnyOf {};
+
+  template <typename Key, typename Pred> const Refs &lookup(Pred &&pred) {
+    // merge first so a pending entity shows up in the count below instead
+    // of only in whichever list happens to be built next
+    afterhours::EntityHelper::get_default_collection().merge_entity_arrays();
+    const size_t count = afterhours::EntityHelper::get_entities().size();
+    if (count != entity_count) {
+      entity_count = count;
+      invalidate();
+    }
+
+    Entry &entry = entries[std::type_index(typeid(Key))];
+    if (!entry.valid) {
+      entry.refs = afterhours::EntityQuery({.force_merge = true})
+                       .whereLambda(std::forward<Pred>(pred))
+                       .gen();
+      entry.valid = true;
+      builds++;
+    }
+    return entry.refs;
+  }
+};
+
+// Registered next to PruneEntityIndex, before EntityHelper::cleanup() runs,
+// so no cached list outlives the entities in it.
+struct InvalidateQueryCache : afterhours::System<> {
+  virtual void once(float) override {
+    auto &cache = QueryCache::get();
+    if (cache.holds_cleanup()) {
+      cache.invalidate();
+    }
+  }
+};
@@ -0,0 +1,461 @@
+#include "replay.h"
+
+#include "components.h"
+#include "game_state_manager.h"
+#include "makers.h"
+#include "map_system.h"
+#include "pressed_inputs.h"
+#include "round_settings.h"
+#include "sim_clock.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <random>
+#include <sstream>
+
+using namespace afterhours;
+
+namespace replay {
+
+namespace {
+
+enum struct Tag : uint8_t { Frame = 1, End = 2 };
+
+uint64_t match_seed = 0;
+std::optional<uint64_t> next_seed;
+
+template <typename T> void write_pod(std::ostream &out, const T &v) {
+  out.write(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T> bool read_pod(std::istream &in, T &v) {
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(&v), sizeof(T)));
+}
+
+void write_string(std::ostream &out, const std::string &s) {
+  write_pod(out, static_cast<uint32_t>(s.size()));
+  out.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+bool read_string(std::istream &in, std::string &s) {
+  uint32_t size = 0;
+  if (!read_pod(in, size))
+    return false;
+  s.resize(size);
+  return static_cast<bool>(in.read(s.data(), size));
+}
+
+template <typename T>
+void write_vector(std::ostream &out, const std::vector<T> &v) {
+  write_pod(out, static_cast<uint32_t>(v.size()));
+  for (const T &item : v)
+    write_pod(out, item);
+}
+
+template <typename T> bool read_vector(std::istream &in, std::vector<T> &v) {
+  uint32_t size = 0;
+  if (!read_pod(in, size))
+    return false;
+  v.resize(size);
+  for (T &item : v) {
+    if (!read_pod(in, item))
+      return false;
+  }
+  return true;
+}
+
+// Karts in creation order, which is the same in a recording and its replay
+RefEntities karts() {
+  return EntityQuery({.force_merge = true})
+      .whereHasComponent<Transform>()
+      .whereLambda([](const Entity &e) {
+        return e.has<PlayerID>() || e.has<AIControlled>();
+      })
+      .gen();
+}
+
+std::vector<Action> to_actions(const std::vector<input::ActionDone> &done) {
+  std::vector<Action> out;
+  out.reserve(done.size());
+  for (const auto &a : done) {
+    out.push_back(Action{.medium = static_cast<uint8_t>(a.medium),
+                         .gamepad = static_cast<int8_t>(a.id),
+                         .action = static_cast<uint8_t>(a.action),
+                         .amount = a.amount_pressed,
+                         .length = a.length_pressed});
+  }
+  return out;
+}
+
+void from_actions(const std::vector<Action> &actions,
+                  std::vector<input::ActionDone> &out) {
+  out.clear();
+  for (const Action &a : actions) {
+    out.push_back(input::ActionDone(
+        static_cast<input::DeviceMedium>(a.medium),
+        static_cast<input::GamepadID>(a.gamepad), a.action, a.amount,
+        a.length));
+  }
+}
+
+void fnv(uint64_t &h, const void *data, size_t size) {
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; i++) {
+    h ^= bytes[i];
+    h *= 0x100000001b3ull;
+  }
+}
+
+} // namespace
+
+void seed_match() {
+  const Player &player = Player::get();
+  if (player.loaded) {
+    match_seed = player.header.seed;
+  } else if (next_seed) {
+    match_seed = *next_seed;
+    next_seed.reset();
+  } else {
+    std::random_device rd;
+    match_seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+  }
+  seed_sim_rng(match_seed);
+}
+
+void set_next_seed(uint64_t seed) { next_seed = seed; }
+
+uint64_t checksum_karts() {
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (const Entity &kart : karts()) {
+    const Transform &t = kart.get<Transform>();
+    fnv(h, &t.position, sizeof(t.position));
+    fnv(h, &t.velocity, sizeof(t.velocity));
+    fnv(h, &t.angle, sizeof(t.angle));
+    if (kart.has<HasHealth>()) {
+      const auto &health = kart.get<HasHealth>().amount;
+      fnv(h, &health, sizeof(health));
+    }
+  }
+  return h;
+}
+
+void Recorder::begin_frame() {
+  if (path.empty() || finished)
+    return;
+  // what the coming steps will act on, not what the collector holds now
+  pressed = to_actions(PressedInputs::get().pending);
+
+  const auto &gsm = GameStateManager::get();
+  if (recording) {
+    if (gsm.is_menu_active())
+      finish();
+    return;
+  }
+  if (!gsm.is_game_active())
+    return;
+
+  out.open(path, std::ios::binary);
+  if (!out) {
+    log_error("replay: could not open {} for writing", path);
+    finished = true;
+    return;
+  }
+
+  const auto &clock = SimulationClock::get();
+  Header header{.seed = match_seed,
+                .tick_hz = 1.f / clock.fixed_dt,
+                .clock = clock.elapsed,
+                .map_index = MapManager::get().get_selected_map(),
+                .round_settings = RoundManager::get().to_json().dump()};
+  for (const Entity &kart : karts()) {
+    if (kart.has<PlayerID>()) {
+      header.humans.push_back(static_cast<int32_t>(kart.get<PlayerID>().id));
+    } else if (kart.has<AIDifficulty>()) {
+      header.ai_difficulty.push_back(
+          static_cast<uint8_t>(kart.get<AIDifficulty>().difficulty));
+    }
+  }
+
+  write_pod(out, MAGIC);
+  write_pod(out, VERSION);
+  write_pod(out, header.seed);
+  write_pod(out, header.tick_hz);
+  write_pod(out, header.clock);
+  write_pod(out, header.map_index);
+  write_vector(out, header.humans);
+  write_vector(out, header.ai_difficulty);
+  write_string(out, header.round_settings);
+
+  recording = true;
+  log_info("replay: recording to {} (seed {}, map {}, {} humans, {} ais)",
+           path, header.seed, header.map_index, header.humans.size(),
+           header.ai_difficulty.size());
+}
+
+void Recorder::record_frame(float dt, int steps) {
+  if (!recording)
+    return;
+
+  auto *collector = EntityHelper::get_singleton_cmp<input::InputCollector>();
+  write_pod(out, Tag::Frame);
+  write_pod(out, dt);
+  write_pod(out, static_cast<uint8_t>(std::clamp(steps, 0, 255)));
+  write_vector(out, collector ? to_actions(collector->inputs)
+                              : std::vector<Action>{});
+  write_vector(out, pressed);
+  frames++;
+}
+
+void Recorder::finish() {
+  if (!recording)
+    return;
+  write_pod(out, Tag::End);
+  write_pod(out, checksum_karts());
+  out.close();
+  recording = false;
+  finished = true;
+  log_info("replay: wrote {} frames to {}", frames, path);
+}
+
+bool Player::load(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    log_error("replay: could not open {}", path);
+    return false;
+  }
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  if (!read_pod(in, magic) || magic != MAGIC) {
+    log_error("replay: {} is not a replay file", path);
+    return false;
+  }
+  if (!read_pod(in, version) || version != VERSION) {
+    log_error("replay: {} is version {}, expected {}", path, version, VERSION);
+    return false;
+  }
+
+  const bool header_ok =
+      read_pod(in, header.seed) && read_pod(in, header.tick_hz) &&
+      read_pod(in, header.clock) && read_pod(in, header.map_index) &&
+      read_vector(in, header.humans) &&
+      read_vector(in, header.ai_difficulty) &&
+      read_string(in, header.round_settings);
+  if (!header_ok) {
+    log_error("replay: {} has a truncated header", path);
+    return false;
+  }
+
+  frames.clear();
+  Tag tag;
+  while (read_pod(in, tag)) {
+    if (tag == Tag::End) {
+      has_checksum = read_pod(in, checksum);
+      break;
+    }
+    Frame frame;
+    if (tag != Tag::Frame || !read_pod(in, frame.dt) ||
+        !read_pod(in, frame.steps) || !read_vector(in, frame.held) ||
+        !read_vector(in, frame.pressed)) {
+      log_warn("replay: {} is corrupt after frame {}, playing what we have",
+               path, frames.size());
+      break;
+    }
+    frames.push_back(std::move(frame));
+  }
+  if (!has_checksum) {
+    log_warn("replay: {} has no end marker, the recording was cut short",
+             path);
+  }
+
+  loaded = true;
+  cursor = 0;
+  return true;
+}
+
+void Player::start_match(SystemManager &fixed_systems) {
+  RoundManager::get().from_json(
+      nlohmann::json::parse(header.round_settings, nullptr, false));
+  SimulationClock::get().set_rate(header.tick_hz);
+
+  for (int32_t id : header.humans) {
+    make_player(static_cast<input::GamepadID>(id));
+  }
+  for (size_t i = 0; i < header.ai_difficulty.size(); i++) {
+    make_ai();
+  }
+  size_t ai = 0;
+  for (Entity &kart : EntityQuery({.force_merge = true})
+                          .whereHasComponent<AIDifficulty>()
+                          .gen()) {
+    if (ai < header.ai_difficulty.size()) {
+      kart.get<AIDifficulty>().difficulty =
+          static_cast<AIDifficulty::Difficulty>(header.ai_difficulty[ai++]);
+    }
+  }
+
+  // same steps as a headless match start, see start_headless_match()
+  GameStateManager::get().set_screen(
+      GameStateManager::Screen::CharacterCreation);
+  fixed_systems.run(SimulationClock::get().fixed_dt);
+
+  MapManager::get().set_selected_map(header.map_index);
+  MapManager::get().create_map();
+  GameStateManager::get().start_game();
+  SimulationClock::get().elapsed = header.clock;
+  cursor = 0;
+  started = true;
+}
+
+void Player::apply_input(size_t i) const {
+  auto *collector = EntityHelper::get_singleton_cmp<input::InputCollector>();
+  if (!collector)
+    return;
+  if (i >= frames.size()) {
+    collector->inputs.clear();
+    collector->inputs_pressed.clear();
+    PressedInputs::get().pending.clear();
+    return;
+  }
+  from_actions(frames[i].held, collector->inputs);
+  from_actions(frames[i].pressed, collector->inputs_pressed);
+  from_actions(frames[i].pressed, PressedInputs::get().pending);
+}
+
+void ReplayInput::once(float) {
+  const Player &player = Player::get();
+  if (player.playing()) {
+    player.apply_input(player.cursor + 1);
+  }
+}
+
+float Histogram::percentile(float p) const {
+  if (samples_us.empty())
+    return 0.f;
+  std::vector<float> sorted = samples_us;
+  const size_t k = std::min(
+      sorted.size() - 1,
+      static_cast<size_t>(p * static_cast<float>(sorted.size() - 1) + 0.5f));
+  std::nth_element(sorted.begin(),
+                   sorted.begin() + static_cast<std::ptrdiff_t>(k),
+                   sorted.end());
+  return sorted[k];
+}
+
+namespace {
+
+float bucket_low(int b) {
+  return std::exp2(static_cast<float>(b) /
+                   static_cast<float>(Histogram::BUCKETS_PER_OCTAVE));
+}
+
+int bucket_of(float us) {
+  const int b = static_cast<int>(
+      std::floor(std::log2(std::max(us, 1.f)) *
+                 static_cast<float>(Histogram::BUCKETS_PER_OCTAVE)));
+  return std::clamp(b, 0, Histogram::NUM_BUCKETS - 1);
+}
+
+std::vector<int> bucket_counts(const std::vector<float> &samples) {
+  std::vector<int> counts(Histogram::NUM_BUCKETS, 0);
+  for (float us : samples)
+    counts[static_cast<size_t>(bucket_of(us))]++;
+  return counts;
+}
+
+float mean(const std::vector<float> &samples) {
+  if (samples.empty())
+    return 0.f;
+  double sum = 0.0;
+  for (float us : samples)
+    sum += us;
+  return static_cast<float>(sum / static_cast<double>(samples.size()));
+}
+
+} // namespace
+
+void Histogram::print() const {
+  constexpr int BAR_WIDTH = 50;
+  std::cout << fmt::format(
+      "frame time over {} frames: mean {:.1f}us p50 {:.1f}us p90 {:.1f}us "
+      "p99 {:.1f}us max {:.1f}us\n",
+      samples_us.size(), mean(samples_us), percentile(0.5f), percentile(0.9f),
+      percentile(0.99f), percentile(1.f));
+
+  const std::vector<int> counts = bucket_counts(samples_us);
+  const int most = *std::ranges::max_element(counts);
+  if (most == 0)
+    return;
+  for (int b = 0; b < NUM_BUCKETS; b++) {
+    const int n = counts[static_cast<size_t>(b)];
+    if (n == 0)
+      continue;
+    std::cout << fmt::format("{:>9.1f} - {:>9.1f}us {:>7} {}\n", bucket_low(b),
+                             bucket_low(b + 1), n,
+                             std::string(static_cast<size_t>(
+                                             (n * BAR_WIDTH + most - 1) / most),
+                                         '#'));
+  }
+}
+
+bool Histogram::write(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    log_error("replay: could not open {} for writing", path);
+    return false;
+  }
+  out << fmt::format("p50 {:.3f}\np90 {:.3f}\np99 {:.3f}\nmax {:.3f}\n"
+                     "mean {:.3f}\n",
+                     percentile(0.5f), percentile(0.9f), percentile(0.99f),
+                     percentile(1.f), mean(samples_us));
+  const std::vector<int> counts = bucket_counts(samples_us);
+  for (int b = 0; b < NUM_BUCKETS; b++) {
+    out << fmt::format("bucket {:.3f} {:.3f} {}\n", bucket_low(b),
+                       bucket_low(b + 1), counts[static_cast<size_t>(b)]);
+  }
+  return true;
+}
+
+bool Histogram::compare(const std::string &baseline_path,
+                        float tolerance) const {
+  std::ifstream in(baseline_path);
+  if (!in) {
+    log_error("replay: could not open baseline {}", baseline_path);
+    return false;
+  }
+  float base_p50 = -1.f;
+  float base_p99 = -1.f;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    float value = 0.f;
+    if (!(fields >> key >> value))
+      continue;
+    if (key == "p50")
+      base_p50 = value;
+    else if (key == "p99")
+      base_p99 = value;
+  }
+  if (base_p50 <= 0.f || base_p99 <= 0.f) {
+    log_error("replay: baseline {} has no p50/p99", baseline_path);
+    return false;
+  }
+
+  bool ok = true;
+  const auto check = [&](const char *name, float base, float now) {
+    const float change = (now - base) / base;
+    const bool regressed = change > tolerance;
+    std::cout << fmt::format("{}: {:.1f}us -> {:.1f}us ({:+.1f}%){}\n", name,
+                             base, now, change * 100.f,
+                             regressed ? "  REGRESSED" : "");
+    ok = ok && !regressed;
+  };
+  check("p50", base_p50, percentile(0.5f));
+  check("p99", base_p99, percentile(0.99f));
+  return ok;
+}
+
+} // namespace replay
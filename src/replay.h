@@ -0,0 +1,133 @@
+#pragma once
+
+#include "rl.h"
+#include <afterhours/src/singleton.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Match recordings, for reproducible performance runs.
+//
+// `--record <file>` writes the first match played (windowed or headless):
+// the RNG seed, map, roster and round settings, then one record per rendered
+// frame with its dt, how many fixed steps it ran, what the InputCollector
+// held and the presses latched for those steps (PressedInputs). `--headless --replay <file>` rebuilds that match and feeds the frames
+// back through the same simulation systems, then reports a frame-time
+// histogram that can be checked against a stored baseline.
+//
+// A recording made headless replays bit for bit (a checksum of every kart is
+// stored at the end and compared). One made in the window is close but not
+// exact: the frame that pressed "start" keeps running menu systems after the
+// map is built, and the replay has no menu.
+namespace replay {
+
+constexpr uint32_t MAGIC = 0x4c50524b; // "KRPL"
+constexpr uint32_t VERSION = 2;
+
+struct Action {
+  uint8_t medium;
+  int8_t gamepad;
+  uint8_t action;
+  float amount;
+  float length;
+};
+
+struct Frame {
+  float dt = 0.f;
+  uint8_t steps = 0;
+  std::vector<Action> held;
+  // PressedInputs::pending as the frame's steps saw it
+  std::vector<Action> pressed;
+};
+
+struct Header {
+  uint64_t seed = 0;
+  float tick_hz = 0.f;
+  double clock = 0.0;
+  int32_t map_index = 0;
+  // gamepad ids of the human karts, in creation order
+  std::vector<int32_t> humans;
+  // AIDifficulty::Difficulty of each AI kart, in creation order
+  std::vector<uint8_t> ai_difficulty;
+  // RoundManager::to_json()
+  std::string round_settings;
+};
+
+// Seeds sim_rng()/rand() for a new match; MapManager::create_map() calls it
+// before it does anything random. Uses the recording's seed while replaying.
+void seed_match();
+// The next seed_match() uses `seed` instead of a fresh one, for tools that
+// play the same match more than once
+void set_next_seed(uint64_t seed);
+
+SINGLETON_FWD(Recorder)
+struct Recorder {
+  SINGLETON(Recorder)
+
+  std::string path;
+  std::ofstream out;
+  bool recording = false;
+  bool finished = false;
+  size_t frames = 0;
+  // taken in begin_frame, written by record_frame
+  std::vector<Action> pressed;
+
+  // Call once per rendered frame before the fixed steps; starts recording
+  // when the first match goes live and stops when it is over.
+  void begin_frame();
+  // Call once per rendered frame after the fixed steps ran
+  void record_frame(float dt, int steps);
+  void finish();
+};
+
+SINGLETON_FWD(Player)
+struct Player {
+  SINGLETON(Player)
+
+  Header header;
+  std::vector<Frame> frames;
+  uint64_t checksum = 0;
+  bool has_checksum = false;
+  bool loaded = false;
+  bool started = false;
+  size_t cursor = 0;
+
+  bool load(const std::string &path);
+  // Recreates the recorded roster, settings and map and starts the match
+  void start_match(afterhours::SystemManager &fixed_systems);
+  // Puts frames[i] into the InputCollector and PressedInputs, or clears them
+  // past the end
+  void apply_input(size_t i) const;
+  [[nodiscard]] bool playing() const {
+    return started && cursor < frames.size();
+  }
+};
+
+// Registered right after the input plugin in replay runs. Swaps whatever the
+// input plugin collected for the next recorded frame, so the rest of the
+// frame and the following fixed steps see exactly what the recording saw.
+struct ReplayInput : afterhours::System<> {
+  virtual void once(float) override;
+};
+
+// Hash of every kart's position, velocity, angle and health
+uint64_t checksum_karts();
+
+// Frame times from a replay, bucketed on a log scale.
+struct Histogram {
+  static constexpr int BUCKETS_PER_OCTAVE = 4;
+  static constexpr int NUM_BUCKETS = 24 * BUCKETS_PER_OCTAVE;
+
+  std::vector<float> samples_us;
+
+  void add(float us) { samples_us.push_back(us); }
+  [[nodiscard]] float percentile(float p) const;
+  void print() const;
+  bool write(const std::string &path) const;
+  // Fails (returns false) if p50 or p99 is more than `tolerance` slower than
+  // the baseline file written by write()
+  bool compare(const std::string &baseline_path, float tolerance) const;
+};
+
+} // namespace replay
@@ -101,6 +101,9 @@ void Settings::update_master_volume(float vol) {
 }
 
 void match_fullscreen_to_setting(bool fs_enabled) {
+  // headless runs never open a window
+  if (!raylib::IsWindowReady())
+    return;
   if (raylib::IsWindowFullscreen() && fs_enabled)
     return;
   if (!raylib::IsWindowFullscreen() && !fs_enabled)
@@ -135,6 +138,10 @@ void Settings::toggle_post_processing() {
   data.post_processing_enabled = !data.post_processing_enabled;
 }
 
+bool &Settings::get_dynamic_resolution_enabled() {
+  return Settings::get().dynamic_resolution_enabled;
+}
+
 translation_manager::Language Settings::get_language() {
   return Settings::get().language;
 }
@@ -34,6 +34,8 @@ struct SettingsData {
 
   bool fullscreen_enabled = false;
   bool post_processing_enabled = true;
+  // let DynamicResolution shrink the world render target on slow machines
+  bool dynamic_resolution_enabled = false;
 
   translation_manager::Language language =
       translation_manager::Language::English;
@@ -54,6 +56,7 @@ struct SettingsData {
 
     j["fullscreen_enabled"] = fullscreen_enabled;
     j["post_processing_enabled"] = post_processing_enabled;
+    j["dynamic_resolution_enabled"] = dynamic_resolution_enabled;
 
     nlohmann::json lang_j;
     ::to_json(lang_j, language);
@@ -78,6 +81,10 @@ struct SettingsData {
       data.post_processing_enabled = j.at("post_processing_enabled");
     }
 
+    if (j.contains("dynamic_resolution_enabled")) {
+      data.dynamic_resolution_enabled = j.at("dynamic_resolution_enabled");
+    }
+
     if (j.contains("language")) {
       ::from_json(j.at("language"), data.language);
     }
@@ -118,6 +125,7 @@ struct Settings {
   static void toggle_fullscreen();
   static bool &get_post_processing_enabled();
   static void toggle_post_processing();
+  static bool &get_dynamic_resolution_enabled();
   static translation_manager::Language get_language();
   static void set_language(translation_manager::Language language);
   static void save_round_settings();
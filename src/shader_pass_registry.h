@@ -35,11 +35,7 @@ struct ShaderPassRegistry {
        }},
       {RenderPriority::Particles},
       {RenderPriority::UI},
-      {RenderPriority::PostProcess,
-       {
-           ShaderType::post_processing,
-           ShaderType::post_processing_tag,
-       }},
+      {RenderPriority::PostProcess},
       {RenderPriority::Debug},
   };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rl.h"
+#include <algorithm>
 #include <string>
 #include <string_view>
 
@@ -21,10 +22,6 @@ enum class ShaderType {
   entity_enhanced,
   entity_test,
 
-  // Post-processing shaders
-  post_processing,
-  post_processing_tag,
-
   // Special effects
   text_mask,
 
@@ -34,21 +31,15 @@ enum class ShaderType {
 // Define all uniform locations as an enum
 enum class UniformLocation {
   // Common uniforms (used by most shaders)
-  Time,        // Used by: Car, CarWinner, PostProcessing, PostProcessingTag
-  Resolution,  // Used by: Car, CarWinner, PostProcessing, PostProcessingTag
-  EntityColor, // Used by: Car, CarWinner, EntityEnhanced, EntityTest
+  Time,        // Used by: Car, CarWinner
+  Resolution,  // Used by: Car, CarWinner
+  EntityColor, // Used by: EntityEnhanced, EntityTest
 
   // Car-specific uniforms
-  Speed,         // Used by: Car
-  WinnerRainbow, // Used by: CarWinner
-
-  // Post-processing uniforms
-  SpotlightEnabled,  // Used by: PostProcessingTag
-  SpotlightPos,      // Used by: PostProcessingTag
-  SpotlightRadius,   // Used by: PostProcessingTag
-  SpotlightSoftness, // Used by: PostProcessingTag
-  DimAmount,         // Used by: PostProcessingTag
-  DesaturateAmount,  // Used by: PostProcessingTag
+  // Car and CarWinner get these from the vertex color instead, see
+  // ShaderUtils::pack_sprite_tint(); only custom shaders still use them
+  Speed,
+  WinnerRainbow,
 
   // UV bounds (used by sprite-based shaders)
   UvMin, // Used by: Car, CarWinner, EntityEnhanced, EntityTest
@@ -64,12 +55,6 @@ constexpr const char *RESOLUTION = "resolution";
 constexpr const char *ENTITY_COLOR = "entityColor";
 constexpr const char *SPEED = "speed";
 constexpr const char *WINNER_RAINBOW = "winnerRainbow";
-constexpr const char *SPOTLIGHT_ENABLED = "spotlightEnabled";
-constexpr const char *SPOTLIGHT_POS = "spotlightPos";
-constexpr const char *SPOTLIGHT_RADIUS = "spotlightRadius";
-constexpr const char *SPOTLIGHT_SOFTNESS = "spotlightSoftness";
-constexpr const char *DIM_AMOUNT = "dimAmount";
-constexpr const char *DESATURATE_AMOUNT = "desaturateAmount";
 constexpr const char *UV_MIN = "uvMin";
 constexpr const char *UV_MAX = "uvMax";
 } // namespace UniformNames
@@ -107,6 +92,24 @@ inline ShaderType from_string(const std::string &name) {
 inline constexpr std::string_view to_string(ShaderType shader) {
   return magic_enum::enum_name(shader);
 }
+
+// Sprite shaders that read the per-entity color, speed and winner flag from
+// the vertex color instead of uniforms, so any number of sprites using them
+// go out in a single draw
+constexpr bool reads_sprite_tint(ShaderType shader) {
+  return shader == ShaderType::car || shader == ShaderType::car_winner;
+}
+
+// The vertex color those shaders expect: rgb is the entity color, alpha is
+// the winner flag in the high bit and speed (0..1) in the low 7 bits
+inline raylib::Color pack_sprite_tint(raylib::Color color, float speed,
+                                      bool winner) {
+  const auto speed_bits =
+      static_cast<unsigned char>(std::clamp(speed, 0.f, 1.f) * 127.f + 0.5f);
+  return raylib::Color{color.r, color.g, color.b,
+                       static_cast<unsigned char>(speed_bits |
+                                                  (winner ? 0x80 : 0))};
+}
 } // namespace ShaderUtils
 
 // Helper functions for uniform enums
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "components.h"
+#include "tags.h"
+#include <afterhours/ah.h>
+#include <afterhours/src/singleton.h>
+
+// Gameplay time, advanced by the fixed-update pass. Anything that compares
+// timestamps for gameplay (boost cooldowns, tag cooldowns) should read this
+// instead of raylib::GetTime() so it behaves the same with no window and
+// when the simulation runs faster or slower than real time.
+//
+// The clock also owns the fixed-step accumulator: begin_frame() takes the
+// real frame time and says how many fixed steps to run, and `alpha` is how
+// far the leftover time reaches into the next step, which renderers use to
+// blend Transform between its previous and current state.
+SINGLETON_FWD(SimulationClock)
+struct SimulationClock {
+  SINGLETON(SimulationClock)
+
+  // Per-tick tuning (Move's damping, velocities in px/tick) was authored
+  // against this rate
+  static constexpr float REFERENCE_HZ = 120.f;
+  // A long hitch (debugger, window drag) would otherwise ask for hundreds of
+  // catch-up steps, each making the next frame longer still
+  static constexpr int MAX_STEPS_PER_FRAME = 8;
+
+  double elapsed = 0.0;
+  float fixed_dt = 1.f / REFERENCE_HZ;
+  float accumulator = 0.f;
+  float alpha = 1.f;
+  long long steps = 0;
+
+  void set_rate(float hz) {
+    if (hz <= 0.f) {
+      log_warn("ignoring tick rate {}hz, keeping {}hz", hz, 1.f / fixed_dt);
+      return;
+    }
+    fixed_dt = 1.f / hz;
+    accumulator = 0.f;
+  }
+
+  [[nodiscard]] int begin_frame(float frame_dt) {
+    accumulator += std::max(0.f, frame_dt);
+    int count = static_cast<int>(accumulator / fixed_dt);
+    if (count > MAX_STEPS_PER_FRAME) {
+      count = MAX_STEPS_PER_FRAME;
+      accumulator = 0.f;
+    } else {
+      accumulator -= static_cast<float>(count) * fixed_dt;
+    }
+    alpha = std::clamp(accumulator / fixed_dt, 0.f, 1.f);
+    return count;
+  }
+
+  // How much a per-tick quantity should be scaled by for a step of dt
+  [[nodiscard]] static float ticks(float dt) { return dt * REFERENCE_HZ; }
+
+  void advance(float dt) {
+    elapsed += static_cast<double>(dt);
+    steps++;
+  }
+  [[nodiscard]] float now() const { return static_cast<float>(elapsed); }
+};
+
+struct AdvanceSimulationClock : afterhours::System<> {
+  virtual void once(float dt) override { SimulationClock::get().advance(dt); }
+};
+
+// First thing each fixed step does, so after the step Transform holds both
+// the state renderers blend from and the one they blend toward.
+struct SnapshotPreviousTransform : afterhours::System<Transform> {
+  virtual void for_each_with(afterhours::Entity &entity, Transform &transform,
+                             float) override {
+    // never moves, so its previous state is still the one it was made with
+    if (entity.hasTag(GameTag::StaticMapLayer))
+      return;
+    transform.snapshot();
+  }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "rl.h"
+#include "world_layer.h"
+#include <afterhours/ah.h>
+#include <afterhours/src/singleton.h>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+// Skid marks are painted into one texture covering the visible world instead
+// of being redrawn from their points every frame. Each segment is drawn once
+// when it appears (StampSkidMarks); after that the marks cost a single
+// textured quad (RenderSkid) no matter how many are on screen.
+//
+// Fading is a full-texture pass that subtracts a little alpha every frame.
+// The texture only has 8 bits of alpha, so the per-frame amount is carried
+// over until it adds up to a whole step.
+SINGLETON_FWD(SkidDecals)
+struct SkidDecals {
+  SINGLETON(SkidDecals)
+
+  WorldLayer layer;
+  bool needs_clear = true;
+  float fade_carry = 0.f;
+  // next TireMarkComponent::added to stamp, per kart
+  std::unordered_map<afterhours::EntityID, size_t> stamped;
+
+  // Does not touch GL, so the simulation can call it (new map, new match)
+  void request_clear() { needs_clear = true; }
+
+  // Follows the visible world and applies a pending clear. Call outside of
+  // any other texture mode.
+  void sync(const raylib::Rectangle &view) {
+    if (layer.fit(view)) {
+      needs_clear = true;
+    }
+    if (needs_clear && layer.ready()) {
+      layer.clear();
+      stamped.clear();
+      fade_carry = 0.f;
+      needs_clear = false;
+    }
+  }
+
+  // Takes dt / lifetime of full alpha off every texel. Call inside
+  // BeginTextureMode(layer.target).
+  void fade(float dt, float lifetime) {
+    fade_carry += 255.f * dt / lifetime;
+    const float step = std::floor(fade_carry);
+    if (step < 1.f)
+      return;
+    fade_carry -= step;
+
+    // rgb stays as is, alpha = dst - src
+    raylib::rlSetBlendFactorsSeparate(RL_ZERO, RL_ONE, RL_ONE, RL_ONE,
+                                      RL_FUNC_ADD, RL_FUNC_REVERSE_SUBTRACT);
+    raylib::BeginBlendMode(raylib::BLEND_CUSTOM_SEPARATE);
+    raylib::DrawRectangle(0, 0, layer.target.texture.width,
+                          layer.target.texture.height,
+                          raylib::Color{0, 0, 0,
+                                        static_cast<unsigned char>(
+                                            std::min(step, 255.f))});
+    raylib::EndBlendMode();
+  }
+};
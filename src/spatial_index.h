@@ -0,0 +1,145 @@
+#pragma once
+
+#include "components.h"
+#include <afterhours/src/singleton.h>
+#include <vector>
+
+// Uniform grid over every Transform::rect(), rebuilt from scratch each fixed
+// tick (and once more before the variable-rate update pass). Cell coordinates
+// wrap modulo the grid size so anything pushed past the screen edge by
+// CanWrapAround still lands in a bucket; every hit is confirmed against the
+// real rect so aliasing only costs a compare.
+//
+// Entries hold raw Entity pointers and are only valid until the next
+// EntityHelper::cleanup(), see InvalidateSpatialIndex.
+SINGLETON_FWD(SpatialIndex)
+struct SpatialIndex {
+  SINGLETON(SpatialIndex)
+
+  static constexpr float CELL_SIZE = 64.f;
+
+  struct Entry {
+    afterhours::Entity *entity;
+    Rectangle rect;
+  };
+
+  bool valid = false;
+  int cols = 1;
+  int rows = 1;
+
+  std::vector<Entry> entries;
+  // cell_start[c]..cell_start[c + 1] indexes into cell_items for cell c
+  std::vector<int> cell_start;
+  std::vector<int> cell_items;
+
+  static bool overlaps(const Rectangle &a, const Rectangle &b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && //
+           a.y < b.y + b.height && b.y < a.y + a.height;
+  }
+
+  [[nodiscard]] int cell_coord(float v) const {
+    return static_cast<int>(std::floor(v / CELL_SIZE));
+  }
+
+  [[nodiscard]] static int wrap(int v, int n) {
+    int m = v % n;
+    return m < 0 ? m + n : m;
+  }
+
+  // Calls fn(cell_index) for every (wrapped) cell the rect touches, each cell
+  // at most once.
+  template <typename Fn>
+  void for_each_cell(const Rectangle &r, Fn &&fn) const {
+    int x0 = cell_coord(r.x);
+    int y0 = cell_coord(r.y);
+    int x1 = std::max(x0, cell_coord(r.x + r.width));
+    int y1 = std::max(y0, cell_coord(r.y + r.height));
+    int nx = std::min(x1 - x0 + 1, cols);
+    int ny = std::min(y1 - y0 + 1, rows);
+    for (int j = 0; j < ny; j++) {
+      int cy = wrap(y0 + j, rows);
+      for (int i = 0; i < nx; i++) {
+        fn((cy * cols) + wrap(x0 + i, cols));
+      }
+    }
+  }
+
+  void rebuild(vec2 world_size) {
+    cols = std::max(1, static_cast<int>(std::ceil(world_size.x / CELL_SIZE)));
+    rows = std::max(1, static_cast<int>(std::ceil(world_size.y / CELL_SIZE)));
+    const size_t num_cells = static_cast<size_t>(cols * rows);
+
+    entries.clear();
+    for (const auto &sp : afterhours::EntityHelper::get_entities()) {
+      if (!sp || sp->cleanup || !sp->has<Transform>())
+        continue;
+      entries.push_back(Entry{sp.get(), sp->get<Transform>().rect()});
+    }
+
+    // counting sort so each bucket is a contiguous slice of cell_items
+    cell_start.assign(num_cells + 1, 0);
+    for (const Entry &e : entries) {
+      for_each_cell(e.rect, [&](int c) { cell_start[c + 1]++; });
+    }
+    for (size_t c = 0; c < num_cells; c++) {
+      cell_start[c + 1] += cell_start[c];
+    }
+    cell_items.resize(static_cast<size_t>(cell_start[num_cells]));
+    std::vector<int> cursor(cell_start.begin(), cell_start.end() - 1);
+    for (int idx = 0; idx < static_cast<int>(entries.size()); idx++) {
+      for_each_cell(entries[idx].rect,
+                    [&](int c) { cell_items[cursor[c]++] = idx; });
+    }
+
+    valid = true;
+  }
+
+  void invalidate() {
+    valid = false;
+    entries.clear();
+  }
+
+  // Calls fn(Entity&) once for every indexed entity whose rect overlaps r.
+  // An entity that spans several cells is only reported from the cell that
+  // holds the top-left corner of the intersection, which keeps this reentrant
+  // (no visited set) while still deduplicating.
+  template <typename Fn> void for_each_overlapping(const Rectangle &r, Fn &&fn) {
+    for_each_cell(r, [&](int c) {
+      const int cx = c % cols;
+      const int cy = c / cols;
+      for (int k = cell_start[c]; k < cell_start[c + 1]; k++) {
+        const Entry &e = entries[static_cast<size_t>(cell_items[k])];
+        if (!overlaps(r, e.rect))
+          continue;
+        const float ref_x = std::max(r.x, e.rect.x);
+        const float ref_y = std::max(r.y, e.rect.y);
+        if (wrap(cell_coord(ref_x), cols) != cx ||
+            wrap(cell_coord(ref_y), rows) != cy)
+          continue;
+        // flagged for cleanup this tick still counts, it is there until
+        // the pass ends; see ContactStream
+        fn(*e.entity);
+      }
+    });
+  }
+};
+
+struct RebuildSpatialIndex : afterhours::System<> {
+  afterhours::window_manager::Resolution resolution;
+
+  virtual void once(float) override {
+    auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
+        afterhours::window_manager::ProvidesCurrentResolution>();
+    if (pcr)
+      resolution = pcr->current_resolution;
+    SpatialIndex::get().rebuild(
+        vec2{(float)resolution.width, (float)resolution.height});
+  }
+};
+
+// Registered last in both the fixed and the per-frame pass;
+// EntityHelper::cleanup() runs right after each and would leave dangling
+// pointers behind. Queries before the next rebuild fall back to a plain scan.
+struct InvalidateSpatialIndex : afterhours::System<> {
+  virtual void once(float) override { SpatialIndex::get().invalidate(); }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "components.h"
+#include "entity_index.h"
+#include "tags.h"
+#include "world_layer.h"
+#include <afterhours/ah.h>
+#include <afterhours/src/singleton.h>
+#include <limits>
+#include <vector>
+
+// Walls, rocks, oil and goo that create_map() places and nothing can push:
+// they are painted into one texture when the map is built and drawn with a
+// single blit (RenderStaticMapLayer) instead of one rectangle each per frame.
+// Tagged GameTag::StaticMapLayer so RenderEntities and the movement systems
+// leave them alone; collisions and affectors still see them as usual.
+SINGLETON_FWD(StaticMapLayer)
+struct StaticMapLayer {
+  SINGLETON(StaticMapLayer)
+
+  WorldLayer layer;
+  bool needs_bake = false;
+  // what the texture currently shows
+  std::vector<EntityIndex::Handle> baked;
+
+  // Tags the map pieces that can never move and schedules a bake. Does not
+  // touch GL, so it is fine headless.
+  void mark_static_entities() {
+    for (afterhours::Entity &entity :
+         afterhours::EntityQuery({.force_merge = true})
+             .whereHasTag(GameTag::MapGenerated)
+             .whereHasComponent<Transform>()
+             .gen()) {
+      if (is_static(entity)) {
+        entity.enableTag(GameTag::StaticMapLayer);
+      }
+    }
+    needs_bake = true;
+  }
+
+  // Infinite mass means collisions never move it, and map pieces are not
+  // driven by anything else. Anything RenderEntities would not draw as a
+  // plain rectangle stays live.
+  [[nodiscard]] static bool is_static(const afterhours::Entity &entity) {
+    if (entity.has<HasShader>() ||
+        entity.has<afterhours::texture_manager::HasSpritesheet>() ||
+        entity.has<afterhours::texture_manager::HasAnimation>())
+      return false;
+    const auto &transform = entity.get<Transform>();
+    return transform.collision_config.mass ==
+               std::numeric_limits<float>::max() &&
+           transform.velocity.x == 0.f && transform.velocity.y == 0.f;
+  }
+
+  // True if something baked in has since been removed
+  [[nodiscard]] bool stale() const {
+    const auto &index = EntityIndex::get();
+    for (const EntityIndex::Handle &handle : baked) {
+      if (!index.resolve(handle))
+        return true;
+    }
+    return false;
+  }
+};
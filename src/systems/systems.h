@@ -6,16 +6,26 @@
 #include "../car_affectors.h"
 #include "../components.h"
 #include "../components_weapons.h"
+#include "../contact_stream.h"
+#include "../dynamic_resolution.h"
+#include "../draw_list.h"
 #include "../game.h"
 #include "../game_state_manager.h"
 #include "../input_mapping.h"
 #include "../makers.h"
 #include "../map_system.h"
+#include "../post_fx.h"
+#include "../pressed_inputs.h"
 #include "../query.h"
+#include "../query_cache.h"
 #include "../round_settings.h"
 #include "../settings.h"
+#include "../sim_clock.h"
+#include "../skid_decals.h"
+#include "../static_map_layer.h"
 #include "../library/shader_library.h"
 #include "../tags.h"
+#include "../visible_set.h"
 #include <afterhours/src/plugins/collision.h>
 #include <afterhours/src/plugins/sound_system.h>
 
@@ -36,10 +46,35 @@ struct PausableSystem : afterhours::System<Components...> {
   }
 };
 
+// The part of the world the camera currently shows, or the whole screen
+// before there is a camera.
+inline raylib::Rectangle
+world_view_rect(const afterhours::window_manager::Resolution &resolution) {
+  const float width = (float)resolution.width;
+  const float height = (float)resolution.height;
+
+  auto *camera_entity = afterhours::EntityHelper::get_singleton_cmp<
+      afterhours::camera::HasCamera>();
+  if (!camera_entity) {
+    return raylib::Rectangle{0, 0, width, height};
+  }
+
+  const auto &camera = camera_entity->camera;
+  const float zoom = camera.zoom;
+  const float world_left = (0 - camera.offset.x) / zoom + camera.target.x;
+  const float world_right = (width - camera.offset.x) / zoom + camera.target.x;
+  const float world_top = (0 - camera.offset.y) / zoom + camera.target.y;
+  const float world_bottom =
+      (height - camera.offset.y) / zoom + camera.target.y;
+  return raylib::Rectangle{world_left, world_top, world_right - world_left,
+                           world_bottom - world_top};
+}
+
 #include "systems_common.h"
 #include "systems_hippo.h"
 #include "systems_kills.h"
 #include "systems_lives.h"
+#include "systems_projectiles.h"
 #include "systems_tagandgo.h"
 
 struct UpdateSpriteTransform
@@ -48,8 +83,9 @@ struct UpdateSpriteTransform
   virtual void for_each_with(Entity &entity, Transform &transform,
                              afterhours::texture_manager::HasSprite &hasSprite,
                              float) override {
-    hasSprite.update_transform(transform.position, transform.size,
-                               transform.angle);
+    const float alpha = SimulationClock::get().alpha;
+    hasSprite.update_transform(transform.render_position(alpha), transform.size,
+                               transform.render_angle(alpha));
 
     if (entity.has_child_of<HasColor>()) {
       hasSprite.update_color(entity.get_with_child<HasColor>().color());
@@ -64,8 +100,9 @@ struct UpdateAnimationTransform
   for_each_with(Entity &, Transform &transform,
                 afterhours::texture_manager::HasAnimation &hasAnimation,
                 float) override {
-    hasAnimation.update_transform(transform.position, transform.size,
-                                  transform.angle);
+    const float alpha = SimulationClock::get().alpha;
+    hasAnimation.update_transform(transform.render_position(alpha),
+                                  transform.size, transform.render_angle(alpha));
   }
 };
 
@@ -78,165 +115,55 @@ struct MarkEntitiesWithShaders : System<HasShader> {
   }
 };
 
-// System to render sprites with per-entity shaders (batched for performance)
+// Queues sprites with per-entity shaders into the DrawList, which groups
+// them by shader.
+//
+// car and car_winner read the entity color, speed and winner flag from the
+// vertex color (ShaderUtils::pack_sprite_tint), so a whole run of karts goes
+// out under one bound shader. Shaders that still take those as uniforms get
+// them set per item, which flushes raylib's batch each time.
 struct RenderSpritesWithShaders
     : System<Transform, afterhours::texture_manager::HasSprite, HasShader,
              HasColor> {
 
-  struct EntityRenderData {
-    const Transform *transform;
-    const afterhours::texture_manager::HasSprite *hasSprite;
-    const HasColor *hasColor;
-    const HasShader *hasShader;
-  };
+  mutable raylib::Texture2D sheet{};
+  mutable bool has_sheet = false;
 
-  // Cache for batching entities by shader type
-  mutable std::unordered_map<ShaderType, std::vector<EntityRenderData>>
-      shader_batches;
-  mutable bool uniforms_updated_this_frame = false;
-  mutable float last_time = 0.0f;
-  mutable vec2 last_resolution = {0, 0};
+  virtual void once(float) const override {
+    auto *spritesheet_component = EntityHelper::get_singleton_cmp<
+        afterhours::texture_manager::HasSpritesheet>();
+    has_sheet = spritesheet_component != nullptr;
+    if (has_sheet) {
+      sheet = spritesheet_component->texture;
+    }
+  }
 
   virtual void
-  for_each_with(const Entity & /* entity */, const Transform &transform,
+  for_each_with(const Entity &entity, const Transform &transform,
                 const afterhours::texture_manager::HasSprite &hasSprite,
                 const HasShader &hasShader, const HasColor &hasColor,
                 float) const override {
-    // Collect entity data for batching instead of rendering immediately
-    if (hasShader.shaders.empty()) {
+    if (!has_sheet || hasShader.shaders.empty()) {
       return;
     }
-
-    ShaderType primary_shader = hasShader.shaders[0];
-    if (!ShaderLibrary::get().contains(primary_shader)) {
+    if (!VisibleSet::get().contains(entity)) {
       return;
     }
 
-    shader_batches[primary_shader].push_back(
-        {&transform, &hasSprite, &hasColor, &hasShader});
-  }
-
-  virtual void once(float) const override {
-    // Render all batches after collecting all entities
-    render_all_batches();
-    shader_batches.clear();
-    uniforms_updated_this_frame = false;
-  }
-
-private:
-  void render_all_batches() const {
-    for (auto &[shader_type, entities] : shader_batches) {
-      if (entities.empty())
-        continue;
-
-      render_shader_batch(shader_type, entities);
-    }
-  }
-
-  void
-  render_shader_batch(ShaderType shader_type,
-                      const std::vector<EntityRenderData> &entities) const {
-    const auto &shader = ShaderLibrary::get().get(shader_type);
-
-    // Get spritesheet once per batch
-    auto *spritesheet_component = EntityHelper::get_singleton_cmp<
-        afterhours::texture_manager::HasSpritesheet>();
-    if (!spritesheet_component) {
+    ShaderType primary_shader = hasShader.shaders[0];
+    if (!ShaderLibrary::get().contains(primary_shader)) {
       return;
     }
 
-    raylib::Texture2D sheet = spritesheet_component->texture;
-    Rectangle source_frame =
+    const Rectangle source_frame =
         afterhours::texture_manager::idx_to_sprite_frame(0, 1);
+    const bool packed = ShaderUtils::reads_sprite_tint(primary_shader);
+    const bool winner = hasShader.has_shader(ShaderType::car_winner);
+    const float speed = speed_percent(transform);
 
-    // Render each entity with its own shader state
-    for (const auto &entity_data : entities) {
-      raylib::BeginShaderMode(shader);
-
-      // Update common uniforms once per entity
-      update_shader_uniforms(shader, shader_type);
-
-      // Render the entity with its specific uniforms
-      render_single_entity(entity_data, sheet, source_frame, shader,
-                           shader_type);
-
-      raylib::EndShaderMode();
-    }
-  }
-
-  void update_shader_uniforms(const raylib::Shader &shader,
-                              ShaderType /* shader_type */) const {
-    float current_time = static_cast<float>(raylib::GetTime());
-
-    // Update time uniform if it changed
-    if (current_time != last_time) {
-      int timeLoc = raylib::GetShaderLocation(shader, "time");
-      if (timeLoc != -1) {
-        raylib::SetShaderValue(shader, timeLoc, &current_time,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-      last_time = current_time;
-    }
-
-    // Update resolution uniform if it changed
-    auto rezCmp = EntityHelper::get_singleton_cmp<
-        window_manager::ProvidesCurrentResolution>();
-    if (rezCmp) {
-      vec2 current_resolution = {
-          static_cast<float>(rezCmp->current_resolution.width),
-          static_cast<float>(rezCmp->current_resolution.height)};
-      if (current_resolution.x != last_resolution.x ||
-          current_resolution.y != last_resolution.y) {
-        int rezLoc = raylib::GetShaderLocation(shader, "resolution");
-        if (rezLoc != -1) {
-          raylib::SetShaderValue(shader, rezLoc, &current_resolution,
-                                 raylib::SHADER_UNIFORM_VEC2);
-        }
-        last_resolution = current_resolution;
-      }
-    }
-
-    // Update UV bounds once per batch (they're the same for all sprites)
-    auto *spritesheet_component = EntityHelper::get_singleton_cmp<
-        afterhours::texture_manager::HasSpritesheet>();
-    if (spritesheet_component) {
-      raylib::Texture2D sheet = spritesheet_component->texture;
-      Rectangle source_frame =
-          afterhours::texture_manager::idx_to_sprite_frame(0, 1);
-
-      float uvMin[2] = {source_frame.x / static_cast<float>(sheet.width),
-                        source_frame.y / static_cast<float>(sheet.height)};
-      float uvMax[2] = {(source_frame.x + source_frame.width) /
-                            static_cast<float>(sheet.width),
-                        (source_frame.y + source_frame.height) /
-                            static_cast<float>(sheet.height)};
-
-      int uvMinLoc = raylib::GetShaderLocation(shader, "uvMin");
-      if (uvMinLoc != -1) {
-        raylib::SetShaderValue(shader, uvMinLoc, uvMin,
-                               raylib::SHADER_UNIFORM_VEC2);
-      }
-      int uvMaxLoc = raylib::GetShaderLocation(shader, "uvMax");
-      if (uvMaxLoc != -1) {
-        raylib::SetShaderValue(shader, uvMaxLoc, uvMax,
-                               raylib::SHADER_UNIFORM_VEC2);
-      }
-    }
-  }
-
-  void render_single_entity(const EntityRenderData &entity_data,
-                            const raylib::Texture2D &sheet,
-                            const Rectangle &source_frame,
-                            const raylib::Shader &shader,
-                            ShaderType shader_type) const {
-    const auto &transform = *entity_data.transform;
-    const auto &hasSprite = *entity_data.hasSprite;
-    const auto &hasColor = *entity_data.hasColor;
-    const auto &hasShader = *entity_data.hasShader;
-
-    // Update per-entity uniforms
-    update_per_entity_uniforms(shader, hasShader, hasColor, transform,
-                               shader_type);
+    const raylib::Color tint =
+        packed ? ShaderUtils::pack_sprite_tint(hasColor.color(), speed, winner)
+               : raylib::WHITE;
 
     // Calculate rendering parameters
     float dest_width = source_frame.width * hasSprite.scale;
@@ -245,63 +172,35 @@ private:
     float offset_x = SPRITE_OFFSET_X;
     float offset_y = SPRITE_OFFSET_Y;
 
-    float rotated_x = offset_x * cosf(transform.angle * M_PI / 180.f) -
-                      offset_y * sinf(transform.angle * M_PI / 180.f);
-    float rotated_y = offset_x * sinf(transform.angle * M_PI / 180.f) +
-                      offset_y * cosf(transform.angle * M_PI / 180.f);
+    const float alpha = SimulationClock::get().alpha;
+    const vec2 position = transform.render_position(alpha);
+    const float angle = transform.render_angle(alpha);
 
-    // Render the sprite
-    raylib::DrawTexturePro(
-        sheet, source_frame,
+    float rotated_x = offset_x * cosf(angle * M_PI / 180.f) -
+                      offset_y * sinf(angle * M_PI / 180.f);
+    float rotated_y = offset_x * sinf(angle * M_PI / 180.f) +
+                      offset_y * cosf(angle * M_PI / 180.f);
+
+    DrawList::Item &item = DrawList::get().push_sprite(
+        DrawList::Layer::Sprites, primary_shader, sheet, source_frame,
         Rectangle{
-            transform.position.x + transform.size.x / 2.f + rotated_x,
-            transform.position.y + transform.size.y / 2.f + rotated_y,
+            position.x + transform.size.x / 2.f + rotated_x,
+            position.y + transform.size.y / 2.f + rotated_y,
             dest_width,
             dest_height,
         },
-        vec2{dest_width / 2.f, dest_height / 2.f}, transform.angle,
-        raylib::WHITE);
-  }
-
-  void update_per_entity_uniforms(const raylib::Shader &shader,
-                                  const HasShader &hasShader,
-                                  const HasColor &hasColor,
-                                  const Transform &transform,
-                                  ShaderType shader_type) const {
-    // Update entity-specific uniforms
-    raylib::Color entityColor = hasColor.color();
-    float entityColorF[4] = {
-        entityColor.r / 255.0f,
-        entityColor.g / 255.0f,
-        entityColor.b / 255.0f,
-        entityColor.a / 255.0f,
-    };
-    int entityColorLoc = raylib::GetShaderLocation(shader, "entityColor");
-    if (entityColorLoc != -1) {
-      raylib::SetShaderValue(shader, entityColorLoc, entityColorF,
-                             raylib::SHADER_UNIFORM_VEC4);
-    } else {
-      log_warn("entityColor uniform location not found in shader!");
-    }
-
-    // Update winner rainbow uniform
-    int rainbowLoc = raylib::GetShaderLocation(shader, "winnerRainbow");
-    if (rainbowLoc != -1) {
-      float rainbowOn =
-          (hasShader.has_shader(ShaderType::car_winner)) ? 1.0f : 0.0f;
-      raylib::SetShaderValue(shader, rainbowLoc, &rainbowOn,
-                             raylib::SHADER_UNIFORM_FLOAT);
+        vec2{dest_width / 2.f, dest_height / 2.f}, angle, tint);
+    if (!packed) {
+      item.entity_uniforms = true;
+      item.entity_color = hasColor.color();
+      item.speed = speed;
+      item.winner = winner;
     }
+  }
 
-    // Update speed uniform for car shaders
-    if (shader_type == ShaderType::car) {
-      float speedPercent = transform.speed() / Config::get().max_speed.data;
-      int speedLocation = raylib::GetShaderLocation(shader, "speed");
-      if (speedLocation != -1) {
-        raylib::SetShaderValue(shader, speedLocation, &speedPercent,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-    }
+private:
+  static float speed_percent(const Transform &transform) {
+    return transform.speed() / Config::get().max_speed.data;
   }
 };
 
@@ -309,10 +208,14 @@ private:
 struct RenderAnimationsWithShaders
     : System<Transform, afterhours::texture_manager::HasAnimation, HasShader,
              HonkState> {
-  virtual void for_each_with(const Entity &, const Transform &transform,
+  virtual void for_each_with(const Entity &entity, const Transform &transform,
                              const afterhours::texture_manager::HasAnimation &,
                              const HasShader &hasShader, const HonkState &,
                              float) const override {
+    if (!VisibleSet::get().contains(entity)) {
+      return;
+    }
+
     if (hasShader.shaders.empty()) {
       log_warn("No shaders found in HasShader component");
       return;
@@ -324,23 +227,19 @@ struct RenderAnimationsWithShaders
       return;
     }
 
-    // Apply shader
-    const auto &shader = ShaderLibrary::get().get(primary_shader);
-    raylib::BeginShaderMode(shader);
-
     // Render animation entities as SKYBLUE for visual distinction
-    raylib::DrawRectanglePro(
+    const float alpha = SimulationClock::get().alpha;
+    const vec2 center = transform.render_center(alpha);
+    DrawList::get().push_rect(
+        DrawList::Layer::Animations, primary_shader,
         Rectangle{
-            transform.center().x,
-            transform.center().y,
+            center.x,
+            center.y,
             transform.size.x,
             transform.size.y,
         },
-        vec2{transform.size.x / 2.f, transform.size.y / 2.f}, transform.angle,
-        raylib::SKYBLUE);
-
-    // End shader
-    raylib::EndShaderMode();
+        vec2{transform.size.x / 2.f, transform.size.y / 2.f},
+        transform.render_angle(alpha), raylib::SKYBLUE);
   }
 };
 
@@ -404,18 +303,30 @@ struct UpdateRenderTexture : System<> {
 
   virtual ~UpdateRenderTexture() {}
 
-  void once(float) {
+  void once(float dt) {
     const window_manager::ProvidesCurrentResolution *pcr =
         EntityHelper::get_singleton_cmp<
             window_manager::ProvidesCurrentResolution>();
     if (pcr->current_resolution != resolution) {
       resolution = pcr->current_resolution;
-      raylib::UnloadRenderTexture(mainRT);
-      mainRT = raylib::LoadRenderTexture(resolution.width, resolution.height);
-      // keep the second render texture in sync
+      // screenRT holds the UI, it always matches the game resolution
       raylib::UnloadRenderTexture(screenRT);
       screenRT = raylib::LoadRenderTexture(resolution.width, resolution.height);
     }
+
+    auto &dynamic = DynamicResolution::get();
+    dynamic.update(dt);
+    const int world_w = dynamic.scaled(resolution.width);
+    const int world_h = dynamic.scaled(resolution.height);
+    if (mainRT.texture.width != world_w || mainRT.texture.height != world_h) {
+      raylib::UnloadRenderTexture(mainRT);
+      mainRT = raylib::LoadRenderTexture(world_w, world_h);
+      // smooth out the upscale in the final PostFx pass
+      if (world_w != resolution.width) {
+        raylib::SetTextureFilter(mainRT.texture,
+                                 raylib::TEXTURE_FILTER_BILINEAR);
+      }
+    }
   }
 };
 
@@ -452,59 +363,9 @@ compute_letterbox_layout(const int window_width, const int window_height,
   return layout;
 }
 
-struct RenderRenderTexture : System<window_manager::ProvidesCurrentResolution> {
-  virtual ~RenderRenderTexture() {}
-  virtual void for_each_with(const Entity &,
-                             const window_manager::ProvidesCurrentResolution &,
-                             float) const override {
-    const int window_w = raylib::GetScreenWidth();
-    const int window_h = raylib::GetScreenHeight();
-    const int content_w = mainRT.texture.width;
-    const int content_h = mainRT.texture.height;
-    const LetterboxLayout layout =
-        compute_letterbox_layout(window_w, window_h, content_w, content_h);
-
-    const raylib::Rectangle src{0.0f, 0.0f, (float)mainRT.texture.width,
-                                -(float)mainRT.texture.height};
-    raylib::DrawTexturePro(mainRT.texture, src, layout.dst, {0.0f, 0.0f}, 0.0f,
-                           raylib::WHITE);
-  }
-};
-
-struct BeginPostProcessingShader : System<> {
-  virtual void once(float) const override {
-    if (!ShaderLibrary::get().contains(ShaderType::post_processing_tag)) {
-      return;
-    }
-    const auto &shader =
-        ShaderLibrary::get().get(ShaderType::post_processing_tag);
-    raylib::BeginShaderMode(shader);
-    // Update common uniforms
-    float t = static_cast<float>(raylib::GetTime());
-    int timeLoc = raylib::GetShaderLocation(shader, "time");
-    if (timeLoc != -1) {
-      raylib::SetShaderValue(shader, timeLoc, &t, raylib::SHADER_UNIFORM_FLOAT);
-    }
-    auto *rez = EntityHelper::get_singleton_cmp<
-        window_manager::ProvidesCurrentResolution>();
-    if (rez) {
-      vec2 r = {static_cast<float>(rez->current_resolution.width),
-                static_cast<float>(rez->current_resolution.height)};
-      int rezLoc = raylib::GetShaderLocation(shader, "resolution");
-      if (rezLoc != -1) {
-        raylib::SetShaderValue(shader, rezLoc, &r, raylib::SHADER_UNIFORM_VEC2);
-      }
-    }
-  }
-};
-
+// Decides whether PostFx compiles the spotlight in this frame, and where
 struct ConfigureTaggerSpotlight : System<> {
   virtual void once(float) const override {
-    if (!ShaderLibrary::get().contains(ShaderType::post_processing_tag)) {
-      return;
-    }
-    // Always update common uniforms
-    set_common_uniforms();
     auto &settings = RoundManager::get().get_active_settings();
     if (RoundManager::get().active_round_type != RoundType::TagAndGo) {
       set_enabled(false);
@@ -514,14 +375,12 @@ struct ConfigureTaggerSpotlight : System<> {
       set_enabled(false);
       return;
     }
-    OptEntity tagger = EntityQuery()
-                           .whereHasComponent<Transform>()
-                           .whereHasComponent<HasTagAndGoTracking>()
-                           .whereLambda([](const Entity &e) {
-                             return e.get<HasTagAndGoTracking>().is_tagger;
-                           })
-                           .gen_first();
-    if (!tagger.valid()) {
+    const auto &karts =
+        QueryCache::get().with<Transform, HasTagAndGoTracking>();
+    auto tagger = std::ranges::find_if(karts, [](const RefEntity &ref) {
+      return ref.get().get<HasTagAndGoTracking>().is_tagger;
+    });
+    if (tagger == karts.end()) {
       set_enabled(false);
       return;
     }
@@ -533,7 +392,7 @@ struct ConfigureTaggerSpotlight : System<> {
     }
     vec2 screen = {static_cast<float>(rez->current_resolution.width),
                    static_cast<float>(rez->current_resolution.height)};
-    vec2 center = tagger->get<Transform>().center();
+    vec2 center = tagger->get().get<Transform>().center();
     // Account for sprite fine-tune offsets used in rendering so spotlight
     // centers correctly
     const float offset_x = SPRITE_OFFSET_X;
@@ -552,96 +411,17 @@ struct ConfigureTaggerSpotlight : System<> {
     set_values(true, uv, radius, softness, dim, desat);
   }
 
-  void set_enabled(bool on) const {
-    const auto &shader =
-        ShaderLibrary::get().get(ShaderType::post_processing_tag);
-    float enabled = on ? 1.0f : 0.0f;
-    int loc = raylib::GetShaderLocation(shader, "spotlightEnabled");
-    if (loc != -1) {
-      raylib::SetShaderValue(shader, loc, &enabled,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-  }
+  void set_enabled(bool on) const { PostFx::get().spotlight.enabled = on; }
 
   void set_values(bool on, vec2 pos, float radius, float softness, float dim,
                   float desat) const {
-    const auto &shader =
-        ShaderLibrary::get().get(ShaderType::post_processing_tag);
-    float enabled = on ? 1.0f : 0.0f;
-    int locEnabled = raylib::GetShaderLocation(shader, "spotlightEnabled");
-    if (locEnabled != -1) {
-      raylib::SetShaderValue(shader, locEnabled, &enabled,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-    int locPos = raylib::GetShaderLocation(shader, "spotlightPos");
-    if (locPos != -1) {
-      raylib::SetShaderValue(shader, locPos, &pos, raylib::SHADER_UNIFORM_VEC2);
-    }
-    int locRad = raylib::GetShaderLocation(shader, "spotlightRadius");
-    if (locRad != -1) {
-      raylib::SetShaderValue(shader, locRad, &radius,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-    int locSoft = raylib::GetShaderLocation(shader, "spotlightSoftness");
-    if (locSoft != -1) {
-      raylib::SetShaderValue(shader, locSoft, &softness,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-    int locDim = raylib::GetShaderLocation(shader, "dimAmount");
-    if (locDim != -1) {
-      raylib::SetShaderValue(shader, locDim, &dim,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-    int locDesat = raylib::GetShaderLocation(shader, "desaturateAmount");
-    if (locDesat != -1) {
-      raylib::SetShaderValue(shader, locDesat, &desat,
-                             raylib::SHADER_UNIFORM_FLOAT);
-    }
-  }
-
-  void set_common_uniforms() const {
-    if (ShaderLibrary::get().contains(ShaderType::post_processing)) {
-      const auto &shader =
-          ShaderLibrary::get().get(ShaderType::post_processing);
-      float t = static_cast<float>(raylib::GetTime());
-      int timeLoc = raylib::GetShaderLocation(shader, "time");
-      if (timeLoc != -1) {
-        raylib::SetShaderValue(shader, timeLoc, &t,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-      auto *rez = EntityHelper::get_singleton_cmp<
-          window_manager::ProvidesCurrentResolution>();
-      if (rez) {
-        vec2 r = {static_cast<float>(rez->current_resolution.width),
-                  static_cast<float>(rez->current_resolution.height)};
-        int rezLoc = raylib::GetShaderLocation(shader, "resolution");
-        if (rezLoc != -1) {
-          raylib::SetShaderValue(shader, rezLoc, &r,
-                                 raylib::SHADER_UNIFORM_VEC2);
-        }
-      }
-    }
-    if (ShaderLibrary::get().contains(ShaderType::post_processing_tag)) {
-      const auto &shader =
-          ShaderLibrary::get().get(ShaderType::post_processing_tag);
-      float t = static_cast<float>(raylib::GetTime());
-      int timeLoc = raylib::GetShaderLocation(shader, "time");
-      if (timeLoc != -1) {
-        raylib::SetShaderValue(shader, timeLoc, &t,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-      auto *rez = EntityHelper::get_singleton_cmp<
-          window_manager::ProvidesCurrentResolution>();
-      if (rez) {
-        vec2 r = {static_cast<float>(rez->current_resolution.width),
-                  static_cast<float>(rez->current_resolution.height)};
-        int rezLoc = raylib::GetShaderLocation(shader, "resolution");
-        if (rezLoc != -1) {
-          raylib::SetShaderValue(shader, rezLoc, &r,
-                                 raylib::SHADER_UNIFORM_VEC2);
-        }
-      }
-    }
+    auto &spotlight = PostFx::get().spotlight;
+    spotlight.enabled = on;
+    spotlight.pos = pos;
+    spotlight.radius = radius;
+    spotlight.softness = softness;
+    spotlight.dim = dim;
+    spotlight.desaturate = desat;
   }
 };
 
@@ -652,8 +432,8 @@ struct RenderLetterboxBars : System<window_manager::ProvidesCurrentResolution> {
                              float) const override {
     const int window_w = raylib::GetScreenWidth();
     const int window_h = raylib::GetScreenHeight();
-    const int content_w = mainRT.texture.width;
-    const int content_h = mainRT.texture.height;
+    const int content_w = screenRT.texture.width;
+    const int content_h = screenRT.texture.height;
     const LetterboxLayout layout =
         compute_letterbox_layout(window_w, window_h, content_w, content_h);
 
@@ -713,92 +493,120 @@ struct RenderDebugGridOverlay
   }
 };
 
+// Paints the StaticMapLayer entities into their texture after a new map was
+// built. Runs before BeginWorldRender since it needs its own texture mode.
+struct BakeStaticMapLayer : System<> {
+  virtual void once(float) const override {
+    auto *pcr = EntityHelper::get_singleton_cmp<
+        window_manager::ProvidesCurrentResolution>();
+    if (!pcr)
+      return;
+    auto &statics = StaticMapLayer::get();
+    if (statics.layer.fit(world_view_rect(pcr->current_resolution))) {
+      statics.needs_bake = true;
+    }
+    if (!statics.layer.ready() || (!statics.needs_bake && !statics.stale()))
+      return;
+
+    statics.baked.clear();
+    raylib::BeginTextureMode(statics.layer.target);
+    raylib::ClearBackground(raylib::BLANK);
+    for (Entity &entity : EntityQuery({.force_merge = true})
+                              .whereHasTag(GameTag::StaticMapLayer)
+                              .gen()) {
+      if (entity.cleanup)
+        continue;
+      const auto &transform = entity.get<Transform>();
+      const vec2 center = statics.layer.to_texture(transform.center());
+      const raylib::Color color =
+          entity.has_child_of<HasColor>()
+              ? entity.get_with_child<HasColor>().color()
+              : raylib::RAYWHITE;
+      raylib::DrawRectanglePro(
+          Rectangle{center.x, center.y, transform.size.x, transform.size.y},
+          vec2{transform.size.x / 2.f, transform.size.y / 2.f},
+          transform.angle, color);
+      statics.baked.push_back(EntityIndex::get().handle_for(entity));
+    }
+    raylib::EndTextureMode();
+    statics.needs_bake = false;
+  }
+};
+
+struct RenderStaticMapLayer : System<> {
+  virtual void once(float) const override {
+    StaticMapLayer::get().layer.draw();
+  }
+};
+
+// Registered at the end of the per-frame update pass, right before
+// InvalidateSpatialIndex, once the camera has settled for the frame.
+struct CollectVisibleSet : System<> {
+  virtual void once(float) override {
+    auto *pcr = EntityHelper::get_singleton_cmp<
+        window_manager::ProvidesCurrentResolution>();
+    if (!pcr)
+      return;
+    VisibleSet::get().collect(world_view_rect(pcr->current_resolution));
+  }
+};
+
 struct RenderEntities : System<Transform> {
 
   virtual void for_each_with(const Entity &entity, const Transform &transform,
                              float) const override {
+    // already in the static map layer
+    if (entity.hasTag(GameTag::StaticMapLayer))
+      return;
+    if (!VisibleSet::get().contains(entity))
+      return;
     if (entity.has<afterhours::texture_manager::HasSpritesheet>())
       return;
     if (entity.has<afterhours::texture_manager::HasAnimation>())
       return;
 
-    // Check if entity has a shader and apply it
-    bool has_shader = entity.has<HasShader>();
-    raylib::Color render_color;
+    const float alpha = SimulationClock::get().alpha;
+    const vec2 center = transform.render_center(alpha);
+    const float angle = transform.render_angle(alpha);
 
-    if (has_shader) {
+    std::optional<ShaderType> shader;
+    raylib::Color render_color = entity.has_child_of<HasColor>()
+                                     ? entity.get_with_child<HasColor>().color()
+                                     : raylib::RAYWHITE;
+
+    if (entity.has<HasShader>()) {
       const auto &shader_component = entity.get<HasShader>();
 
       if (!shader_component.shaders.empty()) {
         ShaderType primary_shader = shader_component.shaders[0];
         if (ShaderLibrary::get().contains(primary_shader)) {
-          const auto &shader = ShaderLibrary::get().get(primary_shader);
-          raylib::BeginShaderMode(shader);
+          shader = primary_shader;
           render_color = raylib::MAGENTA;
         } else {
           log_warn("Shader not found in library: {}",
                    static_cast<int>(primary_shader));
-          has_shader = false;
-          render_color = entity.has_child_of<HasColor>()
-                             ? entity.get_with_child<HasColor>().color()
-                             : raylib::RAYWHITE;
         }
-      } else {
-        render_color = entity.has_child_of<HasColor>()
-                           ? entity.get_with_child<HasColor>().color()
-                           : raylib::RAYWHITE;
-      }
-
-      raylib::DrawRectanglePro(
-          Rectangle{
-              transform.center().x,
-              transform.center().y,
-              transform.size.x,
-              transform.size.y,
-          },
-          vec2{transform.size.x / 2.f, transform.size.y / 2.f}, transform.angle,
-          render_color);
-
-      // End shader mode if we started it
-      if (has_shader) {
-        raylib::EndShaderMode();
       }
-    } else {
-      // Render entities without shaders using their color
-      raylib::Color fallback_color =
-          entity.has_child_of<HasColor>()
-              ? entity.get_with_child<HasColor>().color()
-              : raylib::RAYWHITE;
-
-      raylib::DrawRectanglePro(
-          Rectangle{
-              transform.center().x,
-              transform.center().y,
-              transform.size.x,
-              transform.size.y,
-          },
-          vec2{transform.size.x / 2.f, transform.size.y / 2.f}, transform.angle,
-          fallback_color);
     }
-  };
-};
-
-struct UpdateColorBasedOnEntityID : System<HasEntityIDBasedColor> {
-
-  virtual void for_each_with(Entity &,
-                             HasEntityIDBasedColor &hasEntityIDBasedColor,
-                             float) override {
 
-    const auto parent_is_alive = EQ() //
-                                     .whereID(hasEntityIDBasedColor.id)
-                                     .has_values();
-    if (parent_is_alive)
-      return;
-    hasEntityIDBasedColor.set(hasEntityIDBasedColor.default_);
-  }
+    DrawList::get().push_rect(
+        DrawList::Layer::Entities, shader,
+        Rectangle{
+            center.x,
+            center.y,
+            transform.size.x,
+            transform.size.y,
+        },
+        vec2{transform.size.x / 2.f, transform.size.y / 2.f}, angle,
+        render_color);
+  };
 };
 
 struct MatchKartsToPlayers : System<input::ProvidesMaxGamepadID> {
+  // a replay brings its own roster
+  virtual bool should_run(float) override {
+    return !replay::Player::get().loaded;
+  }
 
   virtual void for_each_with(Entity &,
                              input::ProvidesMaxGamepadID &maxGamepadID,
@@ -837,15 +645,18 @@ struct MatchKartsToPlayers : System<input::ProvidesMaxGamepadID> {
 
 struct RenderWeaponCooldown : System<Transform, CanShoot> {
 
-  virtual void for_each_with(const Entity &, const Transform &transform,
+  virtual void for_each_with(const Entity &entity, const Transform &transform,
                              const CanShoot &canShoot, float) const override {
+    if (!VisibleSet::get().contains(entity))
+      return;
 
+    const float alpha = SimulationClock::get().alpha;
     for (auto it = canShoot.weapons.begin(); it != canShoot.weapons.end();
          ++it) {
       const std::unique_ptr<Weapon> &weapon = it->second;
 
-      vec2 center = transform.center();
-      Rectangle body = transform.rect();
+      vec2 center = transform.render_center(alpha);
+      Rectangle body = transform.render_rect(alpha);
 
       float nw = body.width / 2.f;
       float nh = body.height / 2.f;
@@ -857,9 +668,10 @@ struct RenderWeaponCooldown : System<Transform, CanShoot> {
           nh * (weapon->cooldown / weapon->config.cooldownReset),
       };
 
-      raylib::DrawRectanglePro(arm,
-                               {nw / 2.f, nh / 2.f}, // rotate around center
-                               transform.angle, raylib::RED);
+      DrawList::get().push_rect(DrawList::Layer::WeaponCooldown, std::nullopt,
+                                arm,
+                                {nw / 2.f, nh / 2.f}, // rotate around center
+                                transform.render_angle(alpha), raylib::RED);
     }
   }
 };
@@ -1266,13 +1078,23 @@ struct WeaponRecoilSystem : System<WeaponFired, Transform> {
   }
 };
 
-struct WeaponSoundSystem : System<WeaponFired> {
-  virtual void for_each_with(Entity &, WeaponFired &evt, float) override {
-    if (evt.sound.has_multiple) {
-      sound_system::SoundLibrary::get().play_random_match(evt.sound.name);
+// Fixed step: the audio device belongs to the frame, see WeaponSoundSystem
+struct LatchWeaponSound : System<WeaponFired> {
+  virtual void for_each_with(Entity &entity, WeaponFired &evt,
+                             float) override {
+    entity.addComponentIfMissing<WeaponFiredThisFrame>().sound = evt.sound;
+  }
+};
+
+struct WeaponSoundSystem : System<WeaponFiredThisFrame> {
+  virtual void for_each_with(Entity &entity, WeaponFiredThisFrame &fired,
+                             float) override {
+    if (fired.sound.has_multiple) {
+      sound_system::SoundLibrary::get().play_random_match(fired.sound.name);
     } else {
-      sound_system::SoundLibrary::get().play(evt.sound.name.c_str());
+      sound_system::SoundLibrary::get().play(fired.sound.name.c_str());
     }
+    entity.removeComponent<WeaponFiredThisFrame>();
   }
 };
 
@@ -1283,17 +1105,10 @@ struct WeaponFiredCleanupSystem : System<WeaponFired> {
 };
 
 struct Shoot : PausableSystem<PlayerID, Transform, CanShoot> {
-  input::PossibleInputCollector inpc;
-
-  virtual void once(float) override { inpc = input::get_input_collector(); }
   virtual void for_each_with(Entity &entity, PlayerID &playerID, Transform &,
                              CanShoot &, float) override {
-
-    if (!inpc.has_value()) {
-      return;
-    }
-
-    for (const auto &actions_done : inpc.inputs_pressed()) {
+    // latched for the fixed step, see PressedInputs
+    for (const auto &actions_done : PressedInputs::get().pending) {
       if (actions_done.id != playerID.id)
         continue;
 
@@ -1308,6 +1123,7 @@ struct Shoot : PausableSystem<PlayerID, Transform, CanShoot> {
 struct WrapAroundTransform : System<Transform, CanWrapAround> {
 
   window_manager::Resolution resolution;
+  raylib::Rectangle view{};
 
   virtual void once(float) override {
     resolution =
@@ -1316,63 +1132,14 @@ struct WrapAroundTransform : System<Transform, CanWrapAround> {
             .gen_first_enforce()
             .get<afterhours::window_manager::ProvidesCurrentResolution>()
             .current_resolution;
+    view = world_view_rect(resolution);
   }
 
   virtual void for_each_with(Entity &entity, Transform &transform,
                              CanWrapAround &canWrap, float) override {
-
-    float width = (float)resolution.width;
-    float height = (float)resolution.height;
-
-    // Get camera to calculate proper viewport bounds
-    auto *camera_entity =
-        EntityHelper::get_singleton_cmp<afterhours::camera::HasCamera>();
-    if (!camera_entity) {
-      // Fallback to original behavior if no camera
-      raylib::Rectangle screenRect{0, 0, width, height};
-      const auto overlaps =
-          EQ::WhereOverlaps::overlaps(screenRect, transform.rect());
-      if (overlaps) {
-        return;
-      }
-
-      if (!transform.render_out_of_bounds || transform.cleanup_out_of_bounds) {
-        entity.cleanup = transform.cleanup_out_of_bounds;
-        return;
-      }
-
-      if (transform.rect().x > width + canWrap.padding) {
-        transform.position.x = -canWrap.padding;
-      }
-      if (transform.rect().x < 0 - canWrap.padding) {
-        transform.position.x = width + canWrap.padding;
-      }
-      if (transform.rect().y < 0 - canWrap.padding) {
-        transform.position.y = height + canWrap.padding;
-      }
-      if (transform.rect().y > height + canWrap.padding) {
-        transform.position.y = -canWrap.padding;
-      }
+    if (entity.hasTag(GameTag::StaticMapLayer))
       return;
-    }
-
-    // Calculate camera viewport bounds
-    const auto &camera = camera_entity->camera;
-    float zoom = camera.zoom;
-
-    // Calculate world coordinates of screen edges
-    float world_left = (0 - camera.offset.x) / zoom + camera.target.x;
-    float world_right = (width - camera.offset.x) / zoom + camera.target.x;
-    float world_top = (0 - camera.offset.y) / zoom + camera.target.y;
-    float world_bottom = (height - camera.offset.y) / zoom + camera.target.y;
-
-    // Create world-space screen rectangle
-    raylib::Rectangle worldScreenRect{world_left, world_top,
-                                      world_right - world_left,
-                                      world_bottom - world_top};
-
-    const auto overlaps =
-        EQ::WhereOverlaps::overlaps(worldScreenRect, transform.rect());
+    const auto overlaps = EQ::WhereOverlaps::overlaps(view, transform.rect());
     if (overlaps) {
       return;
     }
@@ -1383,6 +1150,10 @@ struct WrapAroundTransform : System<Transform, CanWrapAround> {
     }
 
     float padding = canWrap.padding;
+    const float world_left = view.x;
+    const float world_right = view.x + view.width;
+    const float world_top = view.y;
+    const float world_bottom = view.y + view.height;
 
     // Wrap around the camera viewport bounds
     if (transform.rect().x > world_right + padding) {
@@ -1402,8 +1173,7 @@ struct WrapAroundTransform : System<Transform, CanWrapAround> {
 
 struct SkidMarks : System<Transform, TireMarkComponent> {
   virtual void for_each_with(Entity &entity, Transform &transform,
-                             TireMarkComponent &tire, float dt) override {
-    tire.pass_time(dt);
+                             TireMarkComponent &tire, float) override {
     if (!should_render_skid(transform)) {
       tire.added_last_frame = false;
       return;
@@ -1442,17 +1212,45 @@ private:
   }
 };
 
-struct RenderSkid : System<Transform, TireMarkComponent> {
-  virtual void for_each_with(const Entity &entity, const Transform &,
-                             const TireMarkComponent &tire,
-                             float) const override {
+// Draws the skid segments added since last frame into SkidDecals and fades
+// the older ones. Runs before BeginWorldRender since it needs its own
+// texture mode.
+struct StampSkidMarks : System<> {
+  virtual void once(float dt) const override {
+    auto *pcr = EntityHelper::get_singleton_cmp<
+        window_manager::ProvidesCurrentResolution>();
+    if (!pcr)
+      return;
+    auto &decals = SkidDecals::get();
+    decals.sync(world_view_rect(pcr->current_resolution));
+    if (!decals.layer.ready())
+      return;
+
+    raylib::BeginTextureMode(decals.layer.target);
+    decals.fade(dt, TireMarkComponent::LIFETIME);
+    for (const auto &ref : QueryCache::get().with<TireMarkComponent>()) {
+      stamp_new_marks(decals, ref.get());
+    }
+    raylib::EndTextureMode();
+  }
+
+  static void stamp_new_marks(SkidDecals &decals, const Entity &entity) {
+    const auto &tire = entity.get<TireMarkComponent>();
     const bool useWinnerColors =
         entity.has<HasShader>() &&
         (entity.get<HasShader>().has_shader(ShaderType::car_winner));
     const float offsetX = 7.f;
     const float offsetY = 4.f;
-    render_single_tire(tire, vec2{offsetX, offsetY}, useWinnerColors);
-    render_single_tire(tire, vec2{-offsetX, -offsetY}, useWinnerColors);
+
+    size_t &next = decals.stamped[entity.id];
+    for (size_t seq = std::max({next, tire.oldest() + 1, size_t{1}});
+         seq < tire.added; seq++) {
+      stamp_segment(decals, tire.at(seq - 1), tire.at(seq),
+                    vec2{offsetX, offsetY}, useWinnerColors);
+      stamp_segment(decals, tire.at(seq - 1), tire.at(seq),
+                    vec2{-offsetX, -offsetY}, useWinnerColors);
+    }
+    next = tire.added;
   }
 
   static raylib::Color rainbow_from_hue(float hue, unsigned char alpha) {
@@ -1464,31 +1262,31 @@ struct RenderSkid : System<Transform, TireMarkComponent> {
                          static_cast<unsigned char>(blue * 255.0f), alpha);
   }
 
-  void render_single_tire(const TireMarkComponent &tire, vec2 offset,
-                          bool useWinnerColors) const {
-    for (size_t i = 1; i < tire.points.size(); i++) {
-      auto mp0 = tire.points[i - 1];
-      auto mp1 = tire.points[i];
-      if (mp0.gap || mp1.gap) {
-        continue;
-      }
-      if (distance_sq(mp0.position, mp1.position) > 100.f) {
-        continue;
-      }
-      float fade = mp0.time / mp0.lifetime;
-      fade = fmaxf(0.0f, fminf(1.0f, fade));
-      if (fade <= 0.0f) {
-        continue;
-      }
-      const unsigned char a = static_cast<unsigned char>(255.0f * fade);
-      raylib::Color col = useWinnerColors ? rainbow_from_hue(mp0.hue, a)
-                                          : raylib::Color(20, 20, 20, a);
-      raylib::DrawSplineSegmentLinear(mp0.position + offset,
-                                      mp1.position + offset, 5.f, col);
+  static void stamp_segment(const SkidDecals &decals,
+                            const TireMarkComponent::MarkPoint &mp0,
+                            const TireMarkComponent::MarkPoint &mp1,
+                            vec2 offset, bool useWinnerColors) {
+    if (mp0.gap || mp1.gap) {
+      return;
+    }
+    // wrapped around the screen
+    if (distance_sq(mp0.position, mp1.position) > 100.f) {
+      return;
     }
+    raylib::Color col = useWinnerColors ? rainbow_from_hue(mp0.hue, 255)
+                                        : raylib::Color(20, 20, 20, 255);
+    raylib::DrawSplineSegmentLinear(
+        decals.layer.to_texture(mp0.position + offset),
+        decals.layer.to_texture(mp1.position + offset), 5.f, col);
   }
 };
 
+// Skid marks are already in SkidDecals; put them under the karts. The layer
+// only ever covers the view, so there is nothing here to cull.
+struct RenderSkid : System<> {
+  virtual void once(float) const override { SkidDecals::get().layer.draw(); }
+};
+
 struct RenderOOB : System<Transform> {
   mutable window_manager::Resolution resolution;
   mutable Rectangle screen;
@@ -1563,11 +1361,11 @@ struct UpdateTrackingEntities : System<Transform, TracksEntity> {
   virtual void for_each_with(Entity &, Transform &transform,
                              TracksEntity &tracker, float) override {
 
-    OptEntity opte = EQ().whereID(tracker.id).gen_first();
-    if (!opte.valid())
+    Entity *target = EntityIndex::get().resolve(tracker.target);
+    if (!target)
       return;
-    transform.position = (opte->get<Transform>().pos() + tracker.offset);
-    transform.angle = opte->get<Transform>().angle;
+    transform.position = (target->get<Transform>().pos() + tracker.offset);
+    transform.angle = target->get<Transform>().angle;
   }
 };
 
@@ -1628,11 +1426,11 @@ struct UpdateCollidingEntities : PausableSystem<Transform> {
   }
 };
 
-struct VelFromInput
-    : PausableSystem<PlayerID, Transform, HonkState, HasShader> {
+struct VelFromInput : PausableSystem<PlayerID, Transform, HonkState, HasShader,
+                                     CarAffectorCache> {
   virtual void for_each_with(Entity &entity, PlayerID &playerID,
                              Transform &transform, HonkState &honk, HasShader &,
-                             float dt) override {
+                             CarAffectorCache &affectors, float dt) override {
     input::PossibleInputCollector inpc = input::get_input_collector();
     if (!inpc.has_value()) {
       return;
@@ -1687,7 +1485,8 @@ struct VelFromInput
       }
     }
 
-    for (auto &actions_done : inpc.inputs_pressed()) {
+    // latched for the fixed step, see PressedInputs
+    for (const auto &actions_done : PressedInputs::get().pending) {
       if (actions_done.id != playerID.id) {
         continue;
       }
@@ -1757,10 +1556,9 @@ struct VelFromInput
     }
     honk.was_down = honk_down;
 
-    float steering_multiplier = affector_steering_multiplier(transform);
-    float steering_sensitivity =
-        Config::get().steering_sensitivity.data +
-        affector_steering_sensitivity_additive(transform);
+    float steering_multiplier = affectors.steering_multiplier;
+    float steering_sensitivity = Config::get().steering_sensitivity.data +
+                                 affectors.steering_sensitivity_additive;
 
     if (transform.speed() > 0.01) {
       const auto minRadius = Config::get().minimum_steering_radius.data;
@@ -1775,7 +1573,7 @@ struct VelFromInput
       transform.angle = std::fmod(transform.angle + 360.f, 360.f);
     }
 
-    float accel_multiplier = affector_acceleration_multiplier(transform);
+    float accel_multiplier = affectors.acceleration_multiplier;
 
     float mvt{0.f};
     if (transform.accel != 0.f) {
@@ -1839,8 +1637,10 @@ struct ProcessBoostRequests : PausableSystem<WantsBoost, Transform> {
 };
 
 struct BoostDecay : PausableSystem<Transform> {
-  virtual void for_each_with(Entity &, Transform &transform,
+  virtual void for_each_with(Entity &entity, Transform &transform,
                              float dt) override {
+    if (entity.hasTag(GameTag::StaticMapLayer))
+      return;
     const auto decayed_accel_mult =
         transform.accel_mult -
         (transform.accel_mult * Config::get().boost_decay_percent.data * dt);
@@ -1850,61 +1650,29 @@ struct BoostDecay : PausableSystem<Transform> {
 
 struct Move : PausableSystem<Transform> {
 
-  virtual void for_each_with(Entity &, Transform &transform, float) override {
-    transform.position += transform.velocity;
-    float damp = transform.accel != 0 ? 0.99f : 0.98f;
-    float speed_mult = affector_speed_multiplier(transform);
-    transform.velocity = transform.velocity * (damp * speed_mult);
-  }
-};
-
-struct DrainLife : System<HasLifetime> {
-
-  virtual void for_each_with(Entity &entity, HasLifetime &hasLifetime,
-                             float dt) override {
-
-    hasLifetime.lifetime -= dt;
-    if (hasLifetime.lifetime <= 0) {
-      entity.cleanup = true;
-    }
-  }
-};
-
-struct ProcessDamage : PausableSystem<Transform, HasHealth> {
-
   virtual void for_each_with(Entity &entity, Transform &transform,
-                             HasHealth &hasHealth, float dt) override {
-
-    hasHealth.pass_time(dt);
-    if (hasHealth.iframes > 0.f) {
+                             float dt) override {
+    if (entity.hasTag(GameTag::StaticMapLayer))
       return;
-    }
-
-    auto can_damage = EQ().whereHasComponent<CanDamage>()
-                          .whereNotID(entity.id)
-                          .whereOverlaps(transform.rect())
-                          .gen();
-
-    for (Entity &damager : can_damage) {
-      const CanDamage &cd = damager.get<CanDamage>();
-      if (cd.source.id == entity.id)
-        continue;
-      hasHealth.amount -= cd.amount;
-      hasHealth.iframes = hasHealth.iframesReset;
-
-      if (auto src = cd.source.resolve()) {
-        hasHealth.last_damaged_by = afterhours::OptEntityHandle::from_entity(src.asE());
-      } else {
-        hasHealth.last_damaged_by = afterhours::OptEntityHandle{};
-      }
-      damager.cleanup = true;
-    }
+    // velocity and damping are per reference tick, stretch them to this step
+    const float ticks = SimulationClock::ticks(dt);
+    transform.position += transform.velocity * ticks;
+    float damp = transform.accel != 0 ? 0.99f : 0.98f;
+    // Cars get this resolved up front, where the last step left them, so a
+    // slick slows a car from its first whole tick on it (1/120s later than
+    // asking again here); not worth a second overlap pass per car per tick.
+    // Everything else (balls, hippos) asks the index.
+    float speed_mult = entity.has<CarAffectorCache>()
+                           ? entity.get<CarAffectorCache>().speed_multiplier
+                           : affector_speed_multiplier(transform);
+    transform.velocity =
+        transform.velocity * std::pow(damp * speed_mult, ticks);
   }
 };
 
 struct ProcessCollisionAbsorption : System<Transform, CollisionAbsorber> {
 
-  virtual void for_each_with(Entity &entity, Transform &transform,
+  virtual void for_each_with(Entity &entity, Transform &,
                              CollisionAbsorber &collision_absorber,
                              float) override {
     // We let the absorbed things (e.g. bullets) manage cleaning themselves
@@ -1928,15 +1696,16 @@ struct ProcessCollisionAbsorption : System<Transform, CollisionAbsorber> {
                  CollisionAbsorber::AbsorberType::Absorber;
         };
 
-    auto collided_with_absorber =
-        EQ().whereHasComponent<CollisionAbsorber>()
-            .whereNotID(entity.id)
-            .whereNotID(collision_absorber.parent_id.value_or(-1))
-            .whereOverlaps(transform.rect())
-            .whereLambda(unrelated_absorber)
-            .gen();
+    const EntityID parent_id = collision_absorber.parent_id.value_or(-1);
+    bool collided_with_absorber = false;
+    ContactStream::get().for_each_touching<CollisionAbsorber>(
+        entity, [&](const Entity &collider) {
+          if (collided_with_absorber || collider.id == parent_id)
+            return;
+          collided_with_absorber = unrelated_absorber(collider);
+        });
 
-    if (!collided_with_absorber.empty()) {
+    if (collided_with_absorber) {
       entity.cleanup = true;
     }
   }
@@ -1985,13 +1754,14 @@ private:
       return;
     }
 
-    auto damager_opt = hasHealth.last_damaged_by.resolve();
-    if (!damager_opt) {
+    Entity *damager_ptr =
+        EntityIndex::get().resolve(hasHealth.last_damaged_by);
+    if (!damager_ptr) {
       log_warn("Player died but damager entity not found");
       return;
     }
 
-    Entity &damager = damager_opt.asE();
+    Entity &damager = *damager_ptr;
 
     if (damager.has<HasKillCountTracker>()) {
       damager.get<HasKillCountTracker>().kills++;
@@ -2003,46 +1773,88 @@ private:
 };
 
 struct RenderLabels : System<Transform, HasLabels> {
-  virtual void for_each_with(const Entity &, const Transform &transform,
-                             const HasLabels &hasLabels, float) const override {
+  static constexpr float SPACING = 1.f;
 
-    const auto get_label_display_for_type = [](const Transform &transform_in,
-                                               const LabelInfo &label_info_in) {
-      switch (label_info_in.label_type) {
-      case LabelInfo::LabelType::StaticText:
-        return label_info_in.label_text;
-      case LabelInfo::LabelType::VelocityText:
-        return (transform_in.is_reversing() ? "-" : "") +
-               std::to_string(transform_in.speed()) + label_info_in.label_text;
-      case LabelInfo::LabelType::AccelerationText:
-        return std::to_string(transform_in.accel * transform_in.accel_mult) +
-               label_info_in.label_text;
-      }
+  mutable raylib::Font font{};
+  mutable bool has_font = false;
 
-      return label_info_in.label_text;
-    };
+  virtual void once(float) const override {
+    auto *font_manager = EntityHelper::get_singleton_cmp<ui::FontManager>();
+    has_font = font_manager != nullptr;
+    if (has_font) {
+      font = font_manager->get_active_font();
+    }
+  }
+
+  virtual void for_each_with(const Entity &entity, const Transform &transform,
+                             const HasLabels &hasLabels, float) const override {
+    if (!has_font)
+      return;
+    if (!VisibleSet::get().contains(entity))
+      return;
 
     const auto width = transform.rect().width;
     const auto height = transform.rect().height;
+    const float font_size = height / 2.f;
 
     // Makes the label percentages scale from top-left of the object rect as
     // (0, 0)
-    const auto base_x_offset = transform.pos().x - width;
-    const auto base_y_offset = transform.pos().y - height;
+    const vec2 pos = transform.render_position(SimulationClock::get().alpha);
+    const auto base_x_offset = pos.x - width;
+    const auto base_y_offset = pos.y - height;
 
     for (const auto &label_info : hasLabels.label_info) {
-      const auto label_to_display =
-          get_label_display_for_type(transform, label_info);
-      const auto label_pos_offset = label_info.label_pos_offset;
+      refresh(label_info, transform, font_size);
 
+      const auto label_pos_offset = label_info.label_pos_offset;
       const auto x_offset = base_x_offset + (width * label_pos_offset.x);
       const auto y_offset = base_y_offset + (height * label_pos_offset.y);
+      label_info.cache.run.draw(font, vec2{x_offset, y_offset},
+                                raylib::RAYWHITE);
+    }
+  }
 
-      draw_text_ex(
-          EntityHelper::get_singleton_cmp<ui::FontManager>()->get_active_font(),
-          label_to_display.c_str(), vec2{x_offset, y_offset},
-          transform.rect().height / 2.f, 1.f, raylib::RAYWHITE);
+private:
+  // Reshapes the label's glyph run if its text (at display precision) or
+  // the font changed since last frame
+  void refresh(const LabelInfo &label_info, const Transform &transform,
+               float font_size) const {
+    LabelCache &cache = label_info.cache;
+    bool negative = false;
+    int64_t value = 0;
+    switch (label_info.label_type) {
+    case LabelInfo::LabelType::StaticText:
+      break;
+    case LabelInfo::LabelType::VelocityText:
+      negative = transform.is_reversing();
+      value = LabelCache::quantize(transform.speed());
+      break;
+    case LabelInfo::LabelType::AccelerationText:
+      value = LabelCache::quantize(transform.accel * transform.accel_mult);
+      break;
+    }
+
+    if (cache.valid && cache.value == value && cache.negative == negative &&
+        cache.run.matches(font, font_size)) {
+      return;
     }
+    cache.valid = true;
+    cache.value = value;
+    cache.negative = negative;
+
+    if (label_info.label_type == LabelInfo::LabelType::StaticText) {
+      cache.run.shape(font, label_info.label_text, font_size, SPACING);
+      return;
+    }
+
+    std::array<char, 64> buffer;
+    const auto result = fmt::format_to_n(
+        buffer.data(), buffer.size(), "{}{:.1f}{}", negative ? "-" : "",
+        static_cast<double>(value) / LabelCache::PRECISION,
+        label_info.label_text);
+    const size_t length = std::min(result.size, buffer.size());
+    cache.run.shape(font, std::string_view(buffer.data(), length), font_size,
+                    SPACING);
   }
 };
 
@@ -2050,6 +1862,11 @@ struct RenderPlayerHUD : System<Transform, HasHealth> {
 
   virtual void for_each_with(const Entity &entity, const Transform &transform,
                              const HasHealth &hasHealth, float) const override {
+    if (!VisibleSet::get().contains(entity))
+      return;
+
+    const vec2 pos = transform.render_position(SimulationClock::get().alpha);
+
     // Always render health bar
     const float scale_x = 2.f;
     const float scale_y = 1.25f;
@@ -2069,9 +1886,9 @@ struct RenderPlayerHUD : System<Transform, HasHealth> {
     // Render the red background bar
     raylib::DrawRectanglePro(
         Rectangle{
-            transform.pos().x - ((transform.size.x * scale_x) / 2.f) +
+            pos.x - ((transform.size.x * scale_x) / 2.f) +
                 health_bar_centering, // Center with scaling
-            transform.pos().y -
+            pos.y -
                 (transform.size.y + health_bar_offset), // Slightly above the entity
             transform.size.x * scale_x,                 // Adjust length
             (transform.size.y / 4.f) * scale_y          // Adjust height
@@ -2081,9 +1898,9 @@ struct RenderPlayerHUD : System<Transform, HasHealth> {
     // Render the green health bar
     raylib::DrawRectanglePro(
         Rectangle{
-            transform.pos().x - ((transform.size.x * scale_x) / 2.f) +
+            pos.x - ((transform.size.x * scale_x) / 2.f) +
                 health_bar_centering, // Start at the same position as red bar
-            transform.pos().y -
+            pos.y -
                 (transform.size.y + health_bar_offset), // Same vertical position as red bar
             (transform.size.x * scale_x) *
                 health_as_percent, // Adjust length based on health percentage
@@ -2094,23 +1911,23 @@ struct RenderPlayerHUD : System<Transform, HasHealth> {
     // Render round-specific information above health bar
     switch (RoundManager::get().active_round_type) {
     case RoundType::Lives:
-      render_lives(entity, transform, color);
+      render_lives(entity, transform, pos, color);
       break;
     case RoundType::Kills:
-      render_kills(entity, transform, color);
+      render_kills(entity, transform, pos, color);
       break;
     case RoundType::Hippo:
       // Hippo round doesn't need special rendering above health bar
       break;
     case RoundType::TagAndGo:
-      render_tagger_indicator(entity, transform, color);
+      render_tagger_indicator(entity, transform, pos, color);
       break;
     }
   }
 
 private:
   void render_lives(const Entity &entity, const Transform &transform,
-                    raylib::Color color) const {
+                    vec2 pos, raylib::Color color) const {
     if (!entity.has<HasMultipleLives>())
       return;
 
@@ -2120,7 +1937,7 @@ private:
     vec2 off{rad * 2 + 2, 0.f};
     for (int i = 0; i < hasMultipleLives.num_lives_remaining; i++) {
       raylib::DrawCircleV(
-          transform.pos() -
+          pos -
               vec2{transform.size.x / 2.f, transform.size.y + y_offset + rad} +
               (off * (float)i),
           rad, color);
@@ -2128,7 +1945,7 @@ private:
   }
 
   void render_kills(const Entity &entity, const Transform &transform,
-                    raylib::Color color) const {
+                    vec2 pos, raylib::Color color) const {
     if (!entity.has<HasKillCountTracker>())
       return;
 
@@ -2140,13 +1957,13 @@ private:
     float y_offset = transform.size.y * 1.25f;
 
     raylib::DrawText(
-        kills_text.c_str(), static_cast<int>(transform.pos().x - x_offset),
-        static_cast<int>(transform.pos().y - y_offset),
+        kills_text.c_str(), static_cast<int>(pos.x - x_offset),
+        static_cast<int>(pos.y - y_offset),
         static_cast<int>(text_size), color);
   }
 
   void render_tagger_indicator(const Entity &entity, const Transform &transform,
-                               raylib::Color) const {
+                               vec2 pos, raylib::Color) const {
     // TODO add color to entity
     if (!entity.has<HasTagAndGoTracking>())
       return;
@@ -2160,7 +1977,7 @@ private:
       const float crown_y_offset = transform.size.y * 2.0f;
 
       // Crown position (centered above the player)
-      vec2 crown_pos = transform.pos() - vec2{crown_size / 2.f, crown_y_offset};
+      vec2 crown_pos = pos - vec2{crown_size / 2.f, crown_y_offset};
 
       // Draw crown using simple shapes
       raylib::Color crown_color = raylib::GOLD;
@@ -2188,7 +2005,7 @@ private:
     }
 
     // Draw shield for players in cooldown (safe period)
-    float current_time = static_cast<float>(raylib::GetTime());
+    float current_time = SimulationClock::get().now();
     auto &tag_settings =
         RoundManager::get().get_active_rt<RoundTagAndGoSettings>();
     if (current_time - taggerTracking.last_tag_time <
@@ -2201,7 +2018,7 @@ private:
 
       // Shield position (centered above the player)
       vec2 shield_pos =
-          transform.pos() - vec2{shield_size / 2.f, shield_y_offset};
+          pos - vec2{shield_size / 2.f, shield_y_offset};
 
       // Draw shield using simple shapes
       raylib::Color shield_color = raylib::SKYBLUE;
@@ -2243,6 +2060,20 @@ struct BeginWorldRender : System<> {
   virtual void once(float) const override {
     raylib::BeginTextureMode(mainRT);
     raylib::ClearBackground(raylib::DARKGRAY);
+
+    // mainRT may be smaller than the game resolution (DynamicResolution);
+    // keep drawing in game coordinates and let the projection shrink them
+    auto *pcr = EntityHelper::get_singleton_cmp<
+        window_manager::ProvidesCurrentResolution>();
+    if (pcr && (pcr->current_resolution.width != mainRT.texture.width ||
+                pcr->current_resolution.height != mainRT.texture.height)) {
+      raylib::rlMatrixMode(RL_PROJECTION);
+      raylib::rlLoadIdentity();
+      raylib::rlOrtho(0, pcr->current_resolution.width,
+                      pcr->current_resolution.height, 0, 0.0, 1.0);
+      raylib::rlMatrixMode(RL_MODELVIEW);
+      raylib::rlLoadIdentity();
+    }
   }
 };
 
@@ -2250,86 +2081,35 @@ struct EndWorldRender : System<> {
   virtual void once(float) const override { raylib::EndTextureMode(); }
 };
 
-struct BeginTagShaderRender : System<> {
+// The UI goes into its own target over a transparent clear; PostFx lays it
+// over the world when it draws to the window. Alpha is accumulated
+// separately so the target ends up premultiplied: color = sum of color *
+// alpha, alpha = coverage.
+struct BeginUIRender : System<> {
   virtual void once(float) const override {
     raylib::BeginTextureMode(screenRT);
     raylib::ClearBackground(raylib::BLANK);
-
-    bool useTagShader =
-        ShaderLibrary::get().contains(ShaderType::post_processing_tag);
-    if (useTagShader) {
-      const auto &shader =
-          ShaderLibrary::get().get(ShaderType::post_processing_tag);
-      raylib::BeginShaderMode(shader);
-      float t = static_cast<float>(raylib::GetTime());
-      int timeLoc = raylib::GetShaderLocation(shader, "time");
-      if (timeLoc != -1) {
-        raylib::SetShaderValue(shader, timeLoc, &t,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-      auto *rez = EntityHelper::get_singleton_cmp<
-          window_manager::ProvidesCurrentResolution>();
-      if (rez) {
-        vec2 r = {static_cast<float>(rez->current_resolution.width),
-                  static_cast<float>(rez->current_resolution.height)};
-        int rezLoc = raylib::GetShaderLocation(shader, "resolution");
-        if (rezLoc != -1) {
-          raylib::SetShaderValue(shader, rezLoc, &r,
-                                 raylib::SHADER_UNIFORM_VEC2);
-        }
-      }
-    }
-
-    const raylib::Rectangle src{0.0f, 0.0f, (float)mainRT.texture.width,
-                                -(float)mainRT.texture.height};
-    const raylib::Rectangle dst{0.0f, 0.0f, (float)screenRT.texture.width,
-                                (float)screenRT.texture.height};
-    raylib::DrawTexturePro(mainRT.texture, src, dst, {0.0f, 0.0f}, 0.0f,
-                           raylib::WHITE);
-
-    if (useTagShader) {
-      raylib::EndShaderMode();
-    }
+    raylib::rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA,
+                                      RL_ONE, RL_ONE_MINUS_SRC_ALPHA,
+                                      RL_FUNC_ADD, RL_FUNC_ADD);
+    raylib::BeginBlendMode(raylib::BLEND_CUSTOM_SEPARATE);
   }
 };
 
-struct EndTagShaderRender : System<> {
-  virtual void once(float) const override { raylib::EndTextureMode(); }
+struct EndUIRender : System<> {
+  virtual void once(float) const override {
+    raylib::EndBlendMode();
+    raylib::EndTextureMode();
+  }
 };
 
 struct BeginPostProcessingRender : System<> {
   virtual void once(float) const override { raylib::BeginDrawing(); }
 };
 
-struct SetupPostProcessingShader : System<> {
-  virtual void once(float) const override {
-    if (Settings::get_post_processing_enabled() &&
-        ShaderLibrary::get().contains(ShaderType::post_processing)) {
-      const auto &shader =
-          ShaderLibrary::get().get(ShaderType::post_processing);
-      raylib::BeginShaderMode(shader);
-      float t = static_cast<float>(raylib::GetTime());
-      int timeLoc = raylib::GetShaderLocation(shader, "time");
-      if (timeLoc != -1) {
-        raylib::SetShaderValue(shader, timeLoc, &t,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-      auto *rez = EntityHelper::get_singleton_cmp<
-          window_manager::ProvidesCurrentResolution>();
-      if (rez) {
-        vec2 r = {static_cast<float>(rez->current_resolution.width),
-                  static_cast<float>(rez->current_resolution.height)};
-        int rezLoc = raylib::GetShaderLocation(shader, "resolution");
-        if (rezLoc != -1) {
-          raylib::SetShaderValue(shader, rezLoc, &r,
-                                 raylib::SHADER_UNIFORM_VEC2);
-        }
-      }
-    }
-  }
-};
-
-struct RenderScreenToWindow : System<> {
+// The one full-screen pass: world and UI to the window through whichever
+// PostFx variant matches the effects that are on.
+struct RenderPostFxToWindow : System<> {
   virtual void once(float) const override {
     const int window_w = raylib::GetScreenWidth();
     const int window_h = raylib::GetScreenHeight();
@@ -2337,19 +2117,12 @@ struct RenderScreenToWindow : System<> {
     const int content_h = screenRT.texture.height;
     const LetterboxLayout layout =
         compute_letterbox_layout(window_w, window_h, content_w, content_h);
-    const raylib::Rectangle src{0.0f, 0.0f, (float)screenRT.texture.width,
-                                -(float)screenRT.texture.height};
-    raylib::DrawTexturePro(screenRT.texture, src, layout.dst, {0.0f, 0.0f},
-                           0.0f, raylib::WHITE);
-  }
-};
 
-struct EndPostProcessingShader : System<> {
-  virtual void once(float) const override {
-    if (Settings::get_post_processing_enabled() &&
-        ShaderLibrary::get().contains(ShaderType::post_processing)) {
-      raylib::EndShaderMode();
-    }
+    auto &post_fx = PostFx::get();
+    post_fx.compose(
+        mainRT.texture, screenRT.texture, layout.dst,
+        post_fx.effects(Settings::get_post_processing_enabled()),
+        vec2{static_cast<float>(content_w), static_cast<float>(content_h)});
   }
 };
 
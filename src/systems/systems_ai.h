@@ -1,502 +1,321 @@
 #pragma once
 
+#include "../ai_decisions.h"
+#include "../ai_scheduler.h"
+#include "../ai_snapshot.h"
 #include "../car_affectors.h"
 #include "../components.h"
 #include "../game_state_manager.h"
+#include "../job_pool.h"
+#include "../kart_distance_matrix.h"
 #include "../makers.h"
 #include "../map_system.h"
+#include "../nav_grid.h"
 #include "../query.h"
+#include "../query_cache.h"
 #include "../round_settings.h"
+#include "../sim_clock.h"
 #include "../library/shader_library.h"
 #include "../weapons.h"
 #include <afterhours/ah.h>
 #include <algorithm>
-
-// TODO feels like we will need pathfinding at some point
-struct AITargetSelection : PausableSystem<AIControlled, Transform, AIParams> {
-
-  virtual void for_each_with(Entity &entity, AIControlled &ai,
-                             Transform &transform, AIParams &params,
-                             float dt) override {
-    (void)dt;
-
-    auto round_type = RoundManager::get().active_round_type;
-    auto &round_settings = RoundManager::get().get_active_settings();
-
-    if (round_settings.state != RoundSettings::GameState::InGame) {
-      pre_round_ai_target(entity, ai, transform, params);
-      return;
-    }
-
-    RoundType active_mode = round_type;
-    if (entity.has<AIMode>()) {
-      const auto &aim = entity.get<AIMode>();
-      active_mode = aim.follow_round_type ? round_type : aim.mode;
-    }
-
-    switch (active_mode) {
-    case RoundType::Lives:
-      lives_ai_target(entity, ai, transform, params);
-      break;
-    case RoundType::Kills:
-      kills_ai_target(entity, ai, transform, params);
-      break;
-    case RoundType::Hippo:
-      hippo_ai_target(entity, ai, transform, params);
-      break;
-    case RoundType::TagAndGo:
-      tag_and_go_ai_target(entity, ai, transform, params);
-      break;
-    }
-  }
-
-private:
-  void pre_round_ai_target(Entity &entity, AIControlled &ai,
-                           Transform &transform, const AIParams &params) {
-    (void)entity;
-    const bool has_no_target = (ai.target.x == 0.0f && ai.target.y == 0.0f);
-    float distance_to_target = distance_sq(transform.pos(), ai.target);
-    const float retarget_radius_sq =
-        params.retarget_radius * params.retarget_radius;
-    if (has_no_target || distance_to_target < retarget_radius_sq) {
-      float screen_width = raylib::GetScreenWidth();
-      float screen_height = raylib::GetScreenHeight();
-      ai.target = vec_rand_in_box(Rectangle{0, 0, screen_width, screen_height});
-    }
-  }
-
-  void default_ai_target(Entity &entity, AIControlled &ai, Transform &transform,
-                         const AIParams &params) {
-    (void)entity;
-    // Check if we're close enough to current target to pick a new one
-    float distance_to_target = distance_sq(transform.pos(), ai.target);
-    const float retarget_radius_sq =
-        params.retarget_radius * params.retarget_radius;
-    if (distance_to_target > retarget_radius_sq) {
-      return;
-    }
-
-    auto opt_entity = EQ().whereHasComponent<PlayerID>().gen_first();
-    if (opt_entity.valid()) {
-      ai.target = opt_entity->get<Transform>().pos();
-    } else {
-      float screen_width = raylib::GetScreenWidth();
-      float screen_height = raylib::GetScreenHeight();
-      ai.target = vec_rand_in_box(Rectangle{0, 0, screen_width, screen_height});
-    }
+#include <functional>
+
+inline float decision_period(const AIParams &params) {
+  return 1.0f / std::max(params.decision_hz, 1.0f);
+}
+
+inline float difficulty_speed(AIDifficulty::Difficulty difficulty) {
+  switch (difficulty) {
+  case AIDifficulty::Difficulty::Easy:
+    return 0.7f; // Slower for easy AI
+  case AIDifficulty::Difficulty::Medium:
+    return 0.85f; // Slightly slower for medium AI
+  case AIDifficulty::Difficulty::Hard:
+  case AIDifficulty::Difficulty::Expert:
+    return 1.0f;
   }
-
-  void kills_ai_target(Entity &entity, AIControlled &ai, Transform &transform,
-                       const AIParams &params) {
-    (void)params;
-    auto players = EntityQuery({.force_merge = true})
-                       .whereHasComponent<PlayerID>()
-                       .whereHasComponent<Transform>()
-                       .gen();
-    if (players.empty()) {
-      default_ai_target(entity, ai, transform, params);
-      return;
-    }
-    vec2 closest_pos = players[0].get().get<Transform>().pos();
-    float closest_dist = distance_sq(transform.pos(), closest_pos);
-    for (const auto &ref : players) {
-      const auto &p = ref.get();
-      vec2 ppos = p.get<Transform>().pos();
-      float d = distance_sq(transform.pos(), ppos);
-      if (d < closest_dist) {
-        closest_dist = d;
-        closest_pos = ppos;
+  return 1.0f;
+}
+
+// Hands out this tick's AI decisions (see AIScheduler). Runs before
+// CaptureAISnapshot, which copies AIDecisionClock::decide into the agents.
+struct ScheduleAIDecisions : PausableSystem<> {
+  std::vector<AIScheduler::Due> candidates;
+
+  virtual void once(float) override {
+    const auto &sim = SimulationClock::get();
+    const float now = sim.now();
+    candidates.clear();
+    float demand_hz = 0.f;
+    for (const auto &ref : QueryCache::get().with<AIControlled, AIParams>()) {
+      Entity &entity = ref.get();
+      const float period = decision_period(entity.get<AIParams>());
+      demand_hz += 1.f / period;
+      auto &clock = entity.addComponentIfMissing<AIDecisionClock>();
+      if (clock.next_decision < 0.f) {
+        clock.next_decision =
+            AIScheduler::first_decision(entity.id, now, period);
       }
+      candidates.push_back(AIScheduler::Due{clock.next_decision, &clock});
     }
-    ai.target = closest_pos;
+    AIScheduler::get().schedule(
+        now, candidates, AIScheduler::cap_for(demand_hz, sim.fixed_dt));
   }
+};
 
-  void lives_ai_target(Entity &entity, AIControlled &ai, Transform &transform,
-                       const AIParams &params) {
-    // Find all other players (both human and AI)
-    auto all_players = EntityQuery({.force_merge = true})
-                           .whereHasComponent<Transform>()
-                           .whereLambda([](const Entity &e) {
-                             return e.has<PlayerID>() || e.has<AIControlled>();
-                           })
-                           .whereNotID(entity.id)
-                           .gen();
-
-    if (all_players.empty()) {
-      default_ai_target(entity, ai, transform, params);
-      return;
-    }
-
-    vec2 my_pos = transform.pos();
-    vec2 target_pos = vec2{0, 0};
-    float best_score = -std::numeric_limits<float>::max();
-
-    // Find the best target considering both distance and avoidance
-    for (const auto &ref : all_players) {
-      const auto &player = ref.get();
-      vec2 player_pos = player.get<Transform>().pos();
-      float distance_to_player = distance_sq(my_pos, player_pos);
-
-      // Calculate avoidance score - prefer targets that are further from other
-      // players
-      float avoidance_score = 0.0f;
-      for (const auto &other_ref : all_players) {
-        if (other_ref.get().id == player.id)
-          continue;
-
-        vec2 other_pos = other_ref.get().get<Transform>().pos();
-        float distance_between = distance_sq(player_pos, other_pos);
-
-        // Higher score for targets that are further from other players
-        avoidance_score += std::min(distance_between / 10000.0f, 1.0f);
-      }
-
-      // Combine distance preference (closer is better) with avoidance (further
-      // from others is better)
-      float distance_score = 1.0f / (1.0f + distance_to_player / 10000.0f);
-      float combined_score = distance_score * 0.6f + avoidance_score * 0.4f;
-
-      if (combined_score > best_score) {
-        best_score = combined_score;
-        target_pos = player_pos;
+// Copies what the AI reads out of the ECS into AIFrame (see ai_snapshot.h),
+// and builds the KartDistanceMatrix from the same karts in the same order
+struct CaptureAISnapshot : PausableSystem<> {
+  virtual void once(float dt) override {
+    auto &frame = AIFrame::get();
+    AISnapshot &snapshot = frame.snapshot;
+
+    auto &round = RoundManager::get();
+    snapshot.round_type = round.active_round_type;
+    snapshot.in_game = round.get_active_settings().state ==
+                       RoundSettings::GameState::InGame;
+    snapshot.tag_speed_multiplier =
+        snapshot.round_type == RoundType::TagAndGo
+            ? round.get_active_rt<RoundTagAndGoSettings>().speed_multiplier
+            : 1.0f;
+    auto *pcr = EntityHelper::get_singleton_cmp<
+        window_manager::ProvidesCurrentResolution>();
+    snapshot.arena =
+        Rectangle{0, 0, (float)pcr->width(), (float)pcr->height()};
+    snapshot.now = SimulationClock::get().now();
+    snapshot.dt = dt;
+    snapshot.min_steering_radius = Config::get().minimum_steering_radius.data;
+    snapshot.max_steering_radius = Config::get().maximum_steering_radius.data;
+    snapshot.steering_sensitivity = Config::get().steering_sensitivity.data;
+    snapshot.max_speed = Config::get().max_speed.data;
+
+    const auto &karts =
+        QueryCache::get().with_any<Transform, PlayerID, AIControlled>();
+    snapshot.karts.clear();
+    for (const auto &ref : karts) {
+      const Entity &kart = ref.get();
+      AIKart &k = snapshot.karts.emplace_back();
+      k.id = kart.id;
+      k.pos = kart.get<Transform>().pos();
+      k.human = kart.has<PlayerID>();
+      if (kart.has<HasTagAndGoTracking>()) {
+        k.tag_tracked = true;
+        k.is_tagger = kart.get<HasTagAndGoTracking>().is_tagger;
       }
     }
+    KartDistanceMatrix::get().build(snapshot.karts);
 
-    ai.target = target_pos;
-  }
-
-  void hippo_ai_target(Entity &entity, AIControlled &ai, Transform &transform,
-                       const AIParams &params) {
-    // Find all hippo items that haven't been collected
-    auto hippo_items = EQ().whereHasComponent<HippoItem>()
-                           .whereLambda([](const Entity &e) {
-                             return !e.get<HippoItem>().collected;
-                           })
-                           .gen();
-
-    if (hippo_items.empty()) {
-      // No hippos available, use default targeting
-      default_ai_target(entity, ai, transform, params);
-      return;
-    }
-
-    // Find the closest hippo item
-    vec2 closest_hippo_pos =
-        hippo_items[0].get().template get<Transform>().pos();
-    float closest_distance = distance_sq(transform.pos(), closest_hippo_pos);
-
-    for (const auto &hippo_ref : hippo_items) {
-      const auto &hippo = hippo_ref.get();
-      vec2 hippo_pos = hippo.template get<Transform>().pos();
-      float distance = distance_sq(transform.pos(), hippo_pos);
-
-      if (distance < closest_distance) {
-        closest_distance = distance;
-        closest_hippo_pos = hippo_pos;
+    snapshot.hippos.clear();
+    for (const auto &ref : QueryCache::get().with<HippoItem, Transform>()) {
+      const Entity &hippo = ref.get();
+      if (!hippo.get<HippoItem>().collected) {
+        snapshot.hippos.push_back(hippo.get<Transform>().pos());
       }
     }
 
-    float offset_range = params.hippo_target_jitter;
-
-    float distance_to_hippo =
-        sqrt(distance_sq(transform.pos(), closest_hippo_pos));
-    float distance_factor =
-        std::min(1.0f, distance_to_hippo / params.hippo_jitter_distance_scale);
-    float actual_offset_range = offset_range * distance_factor;
-
-    vec2 target_pos = closest_hippo_pos;
-    if (actual_offset_range > 0.0f) {
-      // TODO: Extract rng seeding and random float helpers into a shared util
-      unsigned int seed =
-          entity.id + static_cast<unsigned int>(closest_hippo_pos.x * 1000) +
-          static_cast<unsigned int>(closest_hippo_pos.y * 1000);
-
-      seed = seed * 1103515245 + 12345;
-      float rand_x = (static_cast<float>(seed & 0x7FFF) / 32767.0f - 0.5f) *
-                     actual_offset_range;
-
-      seed = seed * 1103515245 + 12345;
-      float rand_y = (static_cast<float>(seed & 0x7FFF) / 32767.0f - 0.5f) *
-                     actual_offset_range;
-
-      target_pos += vec2{rand_x, rand_y};
+    snapshot.agents.clear();
+    frame.entities.clear();
+    for (size_t i = 0; i < karts.size(); i++) {
+      Entity &entity = karts[i].get();
+      if (!entity.has<AIControlled>() || !entity.has<AIParams>())
+        continue;
+      snapshot.agents.push_back(agent_of(entity, i, snapshot.round_type));
+      frame.entities.push_back(karts[i]);
     }
-
-    ai.target = target_pos;
   }
 
-  void tag_and_go_ai_target(Entity &entity, AIControlled &ai,
-                            Transform &transform, const AIParams &params) {
-    if (!entity.has<HasTagAndGoTracking>()) {
-      default_ai_target(entity, ai, transform, params);
-      return;
+private:
+  static AIAgent agent_of(const Entity &entity, size_t kart,
+                          RoundType round_type) {
+    AIAgent agent;
+    agent.id = entity.id;
+    agent.kart = kart;
+    agent.mode = round_type;
+    if (entity.has<AIMode>()) {
+      const auto &aim = entity.get<AIMode>();
+      agent.mode = aim.follow_round_type ? round_type : aim.mode;
+    }
+    if (entity.has<AIDecisionClock>()) {
+      const auto &clock = entity.get<AIDecisionClock>();
+      agent.decide = clock.decide;
+      agent.next_decision = clock.next_decision;
+    }
+    agent.can_shoot = entity.has<CanShoot>();
+    agent.target = entity.get<AIControlled>().target;
+
+    const auto &params = entity.get<AIParams>();
+    agent.retarget_radius = params.retarget_radius;
+    agent.runner_evade_lookahead_distance =
+        params.runner_evade_lookahead_distance;
+    agent.hippo_target_jitter = params.hippo_target_jitter;
+    agent.hippo_jitter_distance_scale = params.hippo_jitter_distance_scale;
+    agent.shooting_alignment_angle_deg = params.shooting_alignment_angle_deg;
+    agent.boost_min_distance_sq = params.boost_min_distance_sq;
+    agent.boost_ahead_alignment_deg = params.boost_ahead_alignment_deg;
+    agent.boost_cooldown_seconds = params.boost_cooldown_seconds;
+
+    const auto &transform = entity.get<Transform>();
+    agent.velocity = transform.velocity;
+    agent.angle = transform.angle;
+    agent.accel_mult = transform.accel_mult;
+    agent.reversing = transform.is_reversing();
+
+    if (entity.has<CarAffectorCache>()) {
+      const auto &affectors = entity.get<CarAffectorCache>();
+      agent.steering_multiplier = affectors.steering_multiplier;
+      agent.acceleration_multiplier = affectors.acceleration_multiplier;
+      agent.speed_multiplier = affectors.speed_multiplier;
     }
 
-    auto &tag_settings =
-        RoundManager::get().get_active_rt<RoundTagAndGoSettings>();
-    if (tag_settings.state != RoundTagAndGoSettings::GameState::InGame) {
-      default_ai_target(entity, ai, transform, params);
-      return;
+    if (entity.has<AIDifficulty>()) {
+      agent.difficulty_speed =
+          difficulty_speed(entity.get<AIDifficulty>().difficulty);
     }
 
-    auto &tag_tracking = entity.get<HasTagAndGoTracking>();
-
-    if (tag_tracking.is_tagger) {
-      tagger_targeting(ai, transform);
-    } else {
-      runner_targeting(ai, transform, params);
+    if (entity.has<AIBoostCooldown>()) {
+      const auto &bc = entity.get<AIBoostCooldown>();
+      agent.boost_next_allowed = bc.next_allowed_time;
+      agent.boost_cooldown = bc.cooldown_seconds;
     }
+    return agent;
   }
+};
 
-  void tagger_targeting(AIControlled &ai, Transform &transform) {
-    auto runners = EntityQuery()
-                       .whereHasComponent<Transform>()
-                       .whereHasComponent<HasTagAndGoTracking>()
-                       .whereLambda([](const Entity &e) {
-                         return !e.get<HasTagAndGoTracking>().is_tagger;
-                       })
-                       .gen();
-
-    if (runners.empty()) {
-      log_warn("No runners found for tagger AI");
-      return;
-    }
-
-    vec2 closest_runner_pos = runners[0].get().get<Transform>().pos();
-    float closest_distance = distance_sq(transform.pos(), closest_runner_pos);
-
-    for (const auto &runner_ref : runners) {
-      const auto &runner = runner_ref.get();
-      vec2 runner_pos = runner.get<Transform>().pos();
-      float distance = distance_sq(transform.pos(), runner_pos);
-
-      if (distance < closest_distance) {
-        closest_distance = distance;
-        closest_runner_pos = runner_pos;
-      }
-    }
-
-    ai.target = closest_runner_pos;
+// Runs the AI over this frame's snapshot on the JobPool: the decisions
+// AIScheduler let through, then steering and shots for every AI. Between the
+// two, back on the main thread, it does what can't run on a worker: random
+// retargets (rand()) and building flow fields.
+struct EvaluateAI : PausableSystem<> {
+  // Under this many, handing out the work costs more than it saves. A
+  // decision scores every kart, so two are already worth splitting; steering
+  // one AI is a few vector ops.
+  static constexpr size_t DECIDE_PARALLEL_MIN = 2;
+  static constexpr size_t STEER_PARALLEL_MIN = 16;
+
+  // off runs everything on the calling thread, for the benchmark to compare
+  bool pooled = true;
+
+  std::vector<size_t> deciding;
+
+  virtual void once(float) override {
+    auto &frame = AIFrame::get();
+    const AISnapshot &snapshot = frame.snapshot;
+    auto &nav = NavGrid::get();
+    const ai::Inputs in{snapshot, KartDistanceMatrix::get(), nav};
+    frame.commands.assign(snapshot.agents.size(), AICommand{});
+
+    deciding.clear();
+    for (size_t i = 0; i < snapshot.agents.size(); i++) {
+      if (snapshot.agents[i].decide)
+        deciding.push_back(i);
+    }
+    // the set was fixed by AIScheduler on the main thread; every one of
+    // them decides, whatever the thread count
+    {
+      const AIScheduler::Timed timed;
+      run(deciding.size(), DECIDE_PARALLEL_MIN, [&](size_t n) {
+        const size_t i = deciding[n];
+        ai::decide_target(in, snapshot.agents[i], frame.commands[i]);
+      });
+      resolve(frame, nav);
+    }
+
+    run(snapshot.agents.size(), STEER_PARALLEL_MIN, [&](size_t i) {
+      const AIAgent &agent = snapshot.agents[i];
+      AICommand &cmd = frame.commands[i];
+      ai::steer(in, agent, target_of(agent, cmd), cmd);
+      ai::decide_fire(in, agent, cmd);
+    });
   }
 
-  void runner_targeting(AIControlled &ai, Transform &transform,
-                        const AIParams &params) {
-    auto taggers = EntityQuery()
-                       .whereHasComponent<Transform>()
-                       .whereHasComponent<HasTagAndGoTracking>()
-                       .whereLambda([](const Entity &e) {
-                         return e.get<HasTagAndGoTracking>().is_tagger;
-                       })
-                       .gen();
-
-    if (taggers.empty()) {
-      log_warn("No taggers found for runner AI");
+private:
+  void run(size_t count, size_t parallel_min,
+           const std::function<void(size_t)> &fn) const {
+    if (!pooled || count < parallel_min) {
+      for (size_t i = 0; i < count; i++) {
+        fn(i);
+      }
       return;
     }
+    JobPool::get().parallel_for(count, fn);
+  }
 
-    vec2 closest_tagger_pos = taggers[0].get().get<Transform>().pos();
-    float closest_distance = distance_sq(transform.pos(), closest_tagger_pos);
-
-    for (const auto &tagger_ref : taggers) {
-      const auto &tagger = tagger_ref.get();
-      vec2 tagger_pos = tagger.get<Transform>().pos();
-      float distance = distance_sq(transform.pos(), tagger_pos);
+  static vec2 target_of(const AIAgent &agent, const AICommand &cmd) {
+    return cmd.retarget == AICommand::Retarget::Keep ? agent.target
+                                                     : cmd.target;
+  }
 
-      if (distance < closest_distance) {
-        closest_distance = distance;
-        closest_tagger_pos = tagger_pos;
+  // Main thread, in agent order, so the rand() calls and which fields get
+  // built under NavGrid's per-tick cap come out the same every run
+  void resolve(AIFrame &frame, NavGrid &nav) {
+    const AISnapshot &snapshot = frame.snapshot;
+    for (size_t i = 0; i < snapshot.agents.size(); i++) {
+      AICommand &cmd = frame.commands[i];
+      if (cmd.retarget == AICommand::Retarget::Random) {
+        cmd.retarget = AICommand::Retarget::Set;
+        cmd.target = vec_rand_in_box(snapshot.arena);
+      }
+      switch (cmd.missing) {
+      case AICommand::Missing::None:
+        break;
+      case AICommand::Missing::Runner:
+        log_warn("No runners found for tagger AI");
+        break;
+      case AICommand::Missing::Tagger:
+        log_warn("No taggers found for runner AI");
+        break;
+      }
+      if (cmd.threat) {
+        nav.field_to(*cmd.threat);
       }
-    }
-
-    vec2 away_from_tagger = transform.pos() - closest_tagger_pos;
-    if (vec_mag(away_from_tagger) < 0.1f) {
-      away_from_tagger = vec2(1.0f, 0.0f);
-    }
-    away_from_tagger = vec_norm(away_from_tagger);
 
-    vec2 move_direction = away_from_tagger;
-    if (vec_mag(transform.velocity) > 1.0f) {
-      move_direction = vec_norm(transform.velocity);
+      // Following a field is cheap; building a new one only happens when
+      // this AI is deciding anyway
+      const vec2 target = target_of(snapshot.agents[i], cmd);
+      if (target.x != 0 || target.y != 0) {
+        nav.field_to(target, cmd.decided);
+      }
     }
-
-    vec2 target_pos = transform.pos() +
-                      move_direction * params.runner_evade_lookahead_distance;
-
-    ai.target = target_pos;
   }
 };
 
-struct AIVelocity : PausableSystem<AIControlled, Transform, AIParams> {
-
-  virtual void for_each_with(Entity &entity, AIControlled &ai,
-                             Transform &transform, AIParams &params,
-                             float dt) override {
-    const auto &round_settings = RoundManager::get().get_active_settings();
-    const bool is_in_game =
-        round_settings.state == RoundSettings::GameState::InGame;
-    if (!is_in_game) {
-      transform.accel_mult = 1.0f;
-    }
-
-    if (ai.target.x == 0 && ai.target.y == 0) {
-      return;
-    }
-
-    vec2 dir = vec_norm(transform.pos() - ai.target);
-    float target_ang = to_degrees(atan2(dir.y, dir.x)) - 90;
-
-    float steer = 0.f;
-    float accel = 5.f;
-
-    // Calculate angle difference and determine steering direction
-    float angle_diff = target_ang - transform.angle;
-
-    // Normalize angle difference to [-180, 180]
-    while (angle_diff > 180.0f)
-      angle_diff -= 360.0f;
-    while (angle_diff < -180.0f)
-      angle_diff += 360.0f;
-
-    if (angle_diff < -1.0f) {
-      steer = -1.f;
-    } else if (angle_diff > 1.0f) {
-      steer = 1.f;
-    }
-
-    float steering_multiplier = affector_steering_multiplier(transform);
-
-    if (transform.speed() > 0.01) {
-      const auto minRadius = Config::get().minimum_steering_radius.data;
-      const auto maxRadius = Config::get().maximum_steering_radius.data;
-      const auto speed_percentage =
-          transform.speed() / Config::get().max_speed.data;
-
-      const auto rad = std::lerp(minRadius, maxRadius, speed_percentage);
+// Writes the AI commands back to the karts, in agent order
+struct ApplyAICommands : PausableSystem<> {
+  virtual void once(float) override {
+    auto &frame = AIFrame::get();
+    auto &scheduler = AIScheduler::get();
+    const float now = frame.snapshot.now;
+    for (size_t i = 0; i < frame.entities.size(); i++) {
+      Entity &entity = frame.entities[i].get();
+      const AICommand &cmd = frame.commands[i];
+
+      if (cmd.retarget != AICommand::Retarget::Keep) {
+        entity.get<AIControlled>().target = cmd.target;
+      }
 
-      transform.angle += steer * Config::get().steering_sensitivity.data * dt *
-                         rad * steering_multiplier;
-      transform.angle = std::fmod(transform.angle + 360.f, 360.f);
-    }
+      auto &transform = entity.get<Transform>();
+      transform.angle = cmd.angle;
+      transform.velocity = cmd.velocity;
+      transform.accel_mult = cmd.accel_mult;
 
-    float distance_to_target_sq = distance_sq(transform.pos(), ai.target);
-
-    vec2 to_target_dir = vec_norm(ai.target - transform.pos());
-    vec2 forward_dir{
-        std::sin(transform.as_rad()),
-        -std::cos(transform.as_rad()),
-    };
-    float ahead_dot =
-        (forward_dir.x * to_target_dir.x) + (forward_dir.y * to_target_dir.y);
-
-    const float ahead_threshold =
-        std::cos(params.boost_ahead_alignment_deg * (M_PI / 180.0f));
-    if (ahead_dot > ahead_threshold &&
-        distance_to_target_sq > params.boost_min_distance_sq &&
-        !transform.is_reversing() && transform.accel_mult <= 1.f) {
-      float now = static_cast<float>(raylib::GetTime());
-      auto &bc = entity.addComponentIfMissing<AIBoostCooldown>();
-      if (params.boost_cooldown_seconds > 0.0f) {
-        bc.cooldown_seconds = params.boost_cooldown_seconds;
+      if (cmd.touch_boost_cooldown) {
+        auto &bc = entity.addComponentIfMissing<AIBoostCooldown>();
+        bc.cooldown_seconds = cmd.boost_cooldown;
+        bc.next_allowed_time = cmd.boost_next_allowed;
       }
-      if (now >= bc.next_allowed_time) {
+      if (cmd.boost) {
         entity.addComponentIfMissing<WantsBoost>();
-        bc.next_allowed_time = now + bc.cooldown_seconds;
       }
-    }
-
-    auto max_movement_limit = (transform.accel_mult > 1.f)
-                                  ? (Config::get().max_speed.data * 2.f)
-                                  : Config::get().max_speed.data;
-
-    float accel_multiplier = affector_acceleration_multiplier(transform);
-
-    float mvt =
-        std::max(-max_movement_limit,
-                 std::min(max_movement_limit,
-                          transform.speed() + (accel * transform.accel_mult *
-                                               accel_multiplier)));
-
-    // Apply difficulty-based speed multiplier
-    float difficulty_multiplier = 1.0f;
-    if (entity.has<AIDifficulty>()) {
-      auto difficulty = entity.get<AIDifficulty>().difficulty;
-      switch (difficulty) {
-      case AIDifficulty::Difficulty::Easy:
-        difficulty_multiplier = 0.7f; // Slower for easy AI
-        break;
-      case AIDifficulty::Difficulty::Medium:
-        difficulty_multiplier = 0.85f; // Slightly slower for medium AI
-        break;
-      case AIDifficulty::Difficulty::Hard:
-      case AIDifficulty::Difficulty::Expert:
-        difficulty_multiplier = 1.0f;
-        break;
+      if (cmd.fire) {
+        entity.addComponentIfMissing<WantsWeaponFire>(InputAction::ShootLeft);
+        entity.addComponentIfMissing<WantsWeaponFire>(InputAction::ShootRight);
       }
-    }
-    mvt *= difficulty_multiplier;
 
-    // Apply speed multiplier for TagAndGo mode
-    if (RoundManager::get().active_round_type == RoundType::TagAndGo) {
-      auto &tag_settings =
-          RoundManager::get().get_active_rt<RoundTagAndGoSettings>();
-      mvt *= tag_settings.speed_multiplier;
-    }
-
-    transform.velocity += vec2{
-        std::sin(transform.as_rad()) * mvt * dt,
-        -std::cos(transform.as_rad()) * mvt * dt,
-    };
-
-    transform.velocity =
-        transform.velocity * affector_speed_multiplier(transform);
-  }
-};
-
-struct AIShoot : PausableSystem<AIControlled, Transform, AIParams, CanShoot> {
-  virtual void for_each_with(Entity &entity, AIControlled &,
-                             Transform &transform, AIParams &params, CanShoot &,
-                             float) override {
-    const auto &settings = RoundManager::get().get_active_settings();
-    if (settings.state != RoundSettings::GameState::InGame) {
-      return;
-    }
-    if (RoundManager::get().active_round_type != RoundType::Kills &&
-        RoundManager::get().active_round_type != RoundType::Lives) {
-      return;
-    }
-    vec2 forward_dir{std::sin(transform.as_rad()),
-                     -std::cos(transform.as_rad())};
-
-    // TODO better filter for targetable
-    // In Lives mode, target all players (human and AI), in Kills mode only
-    // target human players
-    auto players = EntityQuery({.force_merge = true})
-                       .whereHasComponent<Transform>()
-                       .whereLambda([&](const Entity &e) {
-                         return e.has<PlayerID>() || e.has<AIControlled>();
-                       })
-                       .gen();
-    if (players.empty()) {
-      return;
-    }
-    float best_alignment = -2.0f;
-    for (const auto &ref : players) {
-      const auto &p = ref.get();
-      if (p.id == entity.id)
-        continue;
-      vec2 to_p = p.get<Transform>().pos() - transform.pos();
-      if (vec_mag(to_p) < 0.001f)
-        continue;
-      vec2 dir_to_p = vec_norm(to_p);
-      float dot = forward_dir.x * dir_to_p.x + forward_dir.y * dir_to_p.y;
-      if (dot > best_alignment)
-        best_alignment = dot;
-    }
-    const float fire_threshold =
-        std::cos(params.shooting_alignment_angle_deg * (M_PI / 180.0f));
-    if (best_alignment >= fire_threshold) {
-      entity.addComponentIfMissing<WantsWeaponFire>(InputAction::ShootLeft);
-      entity.addComponentIfMissing<WantsWeaponFire>(InputAction::ShootRight);
+      if (cmd.decided) {
+        scheduler.decided_one(entity.get<AIDecisionClock>(), now,
+                              decision_period(entity.get<AIParams>()));
+      }
     }
   }
 };
@@ -525,22 +344,29 @@ struct AIUpdateAIParamsSystem : System<AIParams, AIDifficulty> {
       const auto &aim = entity.get<AIMode>();
       active_mode = aim.follow_round_type ? active_mode : aim.mode;
     }
+    apply(params, active_mode, diff.difficulty);
+  }
 
-    switch (active_mode) {
+  // The tables themselves; tools/tournament.cpp tunes these
+  static void apply(AIParams &params, RoundType mode,
+                    AIDifficulty::Difficulty difficulty) {
+    switch (mode) {
     case RoundType::Lives:
-      update_for_lives(params, diff.difficulty);
+      update_for_lives(params, difficulty);
       break;
     case RoundType::Kills:
-      update_for_kills(params, diff.difficulty);
+      update_for_kills(params, difficulty);
       break;
     case RoundType::Hippo:
-      update_for_hippo(params, diff.difficulty);
+      update_for_hippo(params, difficulty);
       break;
     case RoundType::TagAndGo:
-      update_for_tag_and_go(params, diff.difficulty);
+      update_for_tag_and_go(params, difficulty);
       break;
     }
 
+    params.decision_hz = decision_hz_for(difficulty);
+
     // Ensure boost gating defaults make sense
     params.boost_min_distance_sq = std::max(params.boost_min_distance_sq, 0.0f);
     params.boost_ahead_alignment_deg =
@@ -548,6 +374,21 @@ struct AIUpdateAIParamsSystem : System<AIParams, AIDifficulty> {
   }
 
 private:
+  // Easier AIs react slower; that is most of what makes them easier
+  static float decision_hz_for(AIDifficulty::Difficulty difficulty) {
+    switch (difficulty) {
+    case AIDifficulty::Difficulty::Easy:
+      return 10.0f;
+    case AIDifficulty::Difficulty::Medium:
+      return 20.0f;
+    case AIDifficulty::Difficulty::Hard:
+      return 30.0f;
+    case AIDifficulty::Difficulty::Expert:
+      return 60.0f;
+    }
+    return 20.0f;
+  }
+
   static void update_for_lives(AIParams &params,
                                AIDifficulty::Difficulty difficulty) {
     // Lives behaves similar to Kills for generic difficulty tuning
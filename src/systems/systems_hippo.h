@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../components.h"
+#include "../contact_stream.h"
 #include "../game_state_manager.h"
 #include "../makers.h"
 #include "../query.h"
@@ -8,24 +9,21 @@
 #include <afterhours/ah.h>
 
 struct ProcessHippoCollection : afterhours::System<Transform, HasHippoCollection> {
-  virtual void for_each_with(afterhours::Entity &, Transform &transform,
+  virtual void for_each_with(afterhours::Entity &entity, Transform &,
                              HasHippoCollection &hippo_collection,
                              float) override {
     if (RoundManager::get().active_round_type != RoundType::Hippo) {
       return;
     }
-    auto hippo_items = EQ().whereHasComponent<HippoItem>()
-                           .whereOverlaps(transform.rect())
-                           .gen();
-    for (const auto &item_ref : hippo_items) {
-      afterhours::Entity &item = item_ref.get();
-      HippoItem &hippo_item = item.get<HippoItem>();
-      if (hippo_item.collected)
-        continue;
-      hippo_item.collected = true;
-      hippo_collection.collect_hippo();
-      item.cleanup = true;
-    }
+    ContactStream::get().for_each_touching<HippoItem>(
+        entity, [&](afterhours::Entity &item) {
+          HippoItem &hippo_item = item.get<HippoItem>();
+          if (hippo_item.collected)
+            return;
+          hippo_item.collected = true;
+          hippo_collection.collect_hippo();
+          item.cleanup = true;
+        });
   }
 };
 
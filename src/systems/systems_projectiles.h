@@ -0,0 +1,191 @@
+#pragma once
+
+#include "../car_affectors.h"
+#include "../components.h"
+#include "../contact_stream.h"
+#include "../draw_list.h"
+#include "../projectile_pool.h"
+#include "../query.h"
+#include "../sim_clock.h"
+#include "../visible_set.h"
+#include <afterhours/ah.h>
+
+// Fixed pass: moves, damps and ages every bullet.
+struct UpdateProjectiles : PausableSystem<> {
+  virtual void once(float dt) override {
+    auto &pool = ProjectilePool::get();
+    const float ticks = SimulationClock::ticks(dt);
+    pool.for_each_live([&](size_t i) {
+      pool.prev_x[i] = pool.x[i];
+      pool.prev_y[i] = pool.y[i];
+      pool.x[i] += pool.vx[i] * ticks;
+      pool.y[i] += pool.vy[i] * ticks;
+
+      const float damp = pool.accel[i] != 0.f ? 0.99f : 0.98f;
+      const float speed_mult =
+          std::pow(damp * affector_speed_multiplier(pool.rect(i)), ticks);
+      pool.vx[i] *= speed_mult;
+      pool.vy[i] *= speed_mult;
+
+      pool.lifetime[i] -= dt;
+      if (pool.lifetime[i] <= 0.f) {
+        pool.kill(i);
+      }
+    });
+  }
+};
+
+// Same rules WrapAroundTransform applies to entities: bullets that can't
+// wrap die once they leave the view, the rest only wrap if they are allowed
+// to render out of bounds and otherwise fly on until their lifetime ends.
+struct WrapProjectiles : afterhours::System<> {
+  virtual void once(float) override {
+    auto *pcr = afterhours::EntityHelper::get_singleton_cmp<
+        afterhours::window_manager::ProvidesCurrentResolution>();
+    if (!pcr)
+      return;
+    const raylib::Rectangle view = world_view_rect(pcr->current_resolution);
+    const float right = view.x + view.width;
+    const float bottom = view.y + view.height;
+
+    auto &pool = ProjectilePool::get();
+    pool.for_each_live([&](size_t i) {
+      if (EQ::WhereOverlaps::overlaps(view, pool.rect(i)))
+        return;
+      if (!pool.can_wrap[i]) {
+        pool.kill(i);
+        return;
+      }
+      if (!pool.render_out_of_bounds[i])
+        return;
+
+      if (pool.x[i] > right) {
+        pool.x[i] = view.x;
+      }
+      if (pool.x[i] < view.x) {
+        pool.x[i] = right;
+      }
+      if (pool.y[i] < view.y) {
+        pool.y[i] = bottom;
+      }
+      if (pool.y[i] > bottom) {
+        pool.y[i] = view.y;
+      }
+    });
+  }
+};
+
+// Bullets against anything with health, from the bullet overlaps
+// DetectContacts already found, so the cost follows the bullets rather than
+// cars x bullets.
+//
+// A hit also hands the bullet's momentum to whatever it hit, the way the
+// collision plugin did when bullets were entities with COLLISION.
+struct ProcessProjectileDamage : PausableSystem<> {
+  virtual void once(float dt) override {
+    for (HasHealth &health : EQ().whereHasComponent<HasHealth>()
+                                 .gen_as<HasHealth>()) {
+      health.pass_time(dt);
+    }
+
+    auto &pool = ProjectilePool::get();
+    ContactStream::get().for_each_projectile_contact<Transform, HasHealth>(
+        [&](size_t i, afterhours::Entity &entity) {
+          HasHealth &hasHealth = entity.get<HasHealth>();
+          if (hasHealth.iframes > 0.f)
+            return;
+
+          hasHealth.amount -= pool.damage[i];
+          hasHealth.iframes = hasHealth.iframesReset;
+          hasHealth.last_damaged_by = pool.source[i];
+          push(pool, i, entity.get<Transform>());
+          pool.kill(i);
+        });
+  }
+
+  static void push(const ProjectilePool &pool, size_t i, Transform &target) {
+    const float mass = ProjectilePool::COLLISION.mass;
+    const float target_mass = target.collision_config.mass;
+    if (target_mass == std::numeric_limits<float>::max())
+      return;
+    const float share = (1.f + ProjectilePool::COLLISION.restitution) * mass /
+                        (mass + target_mass);
+    target.velocity += (vec2{pool.vx[i], pool.vy[i]} - target.velocity) * share;
+  }
+};
+
+// Bullets are CollisionAbsorber::Absorbed with their shooter as parent; this
+// is ProcessCollisionAbsorption for them, over the same bullet overlaps.
+struct ProcessProjectileAbsorption : afterhours::System<> {
+  virtual void once(float) override {
+    auto &pool = ProjectilePool::get();
+    ContactStream::get().for_each_projectile_contact<CollisionAbsorber>(
+        [&](size_t i, const afterhours::Entity &collider) {
+          const auto &other = collider.get<CollisionAbsorber>();
+          if (other.parent_id.value_or(-2) == pool.source_id[i])
+            return;
+          if (other.absorber_type ==
+              CollisionAbsorber::AbsorberType::Absorber) {
+            pool.kill(i);
+          }
+        });
+  }
+};
+
+// Every live bullet as one run of quads on the default white texture, so
+// raylib can put them all in a single batch. Pushed into the DrawList as one
+// item, so it keeps its place between the map and the karts.
+struct RenderProjectiles : afterhours::System<> {
+  virtual void once(float) const override {
+    if (ProjectilePool::get().live == 0)
+      return;
+    DrawList::get().push_custom(DrawList::Layer::Projectiles,
+                                raylib::rlGetTextureIdDefault(), &draw_all);
+  }
+
+  static void draw_all() {
+    const auto &pool = ProjectilePool::get();
+    const float alpha = SimulationClock::get().alpha;
+    const auto &index = EntityIndex::get();
+    const auto &visible = VisibleSet::get();
+
+    raylib::rlSetTexture(raylib::rlGetTextureIdDefault());
+    raylib::rlBegin(RL_QUADS);
+    raylib::rlNormal3f(0.f, 0.f, 1.f);
+    pool.for_each_live([&](size_t i) {
+      if (!visible.overlaps(pool.rect(i)))
+        return;
+      // bullets whose shooter is gone turn red
+      const raylib::Color c =
+          index.resolve(pool.source[i]) ? pool.color[i] : raylib::RED;
+
+      const vec2 pos = pool.render_position(i, alpha);
+      const float hw = pool.w[i] / 2.f;
+      const float hh = pool.h[i] / 2.f;
+      const vec2 center{pos.x + hw, pos.y + hh};
+      const float rad = to_radians(pool.angle[i]);
+      const float cs = std::cos(rad);
+      const float sn = std::sin(rad);
+      const auto corner = [&](float dx, float dy) {
+        return vec2{center.x + (dx * cs) - (dy * sn),
+                    center.y + (dx * sn) + (dy * cs)};
+      };
+      const vec2 tl = corner(-hw, -hh);
+      const vec2 bl = corner(-hw, hh);
+      const vec2 br = corner(hw, hh);
+      const vec2 tr = corner(hw, -hh);
+
+      raylib::rlColor4ub(c.r, c.g, c.b, c.a);
+      raylib::rlTexCoord2f(0.f, 0.f);
+      raylib::rlVertex2f(tl.x, tl.y);
+      raylib::rlTexCoord2f(0.f, 1.f);
+      raylib::rlVertex2f(bl.x, bl.y);
+      raylib::rlTexCoord2f(1.f, 1.f);
+      raylib::rlVertex2f(br.x, br.y);
+      raylib::rlTexCoord2f(1.f, 0.f);
+      raylib::rlVertex2f(tr.x, tr.y);
+    });
+    raylib::rlEnd();
+    raylib::rlSetTexture(0);
+  }
+};
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "../components.h"
+#include "../contact_stream.h"
 #include "../game_state_manager.h"
 #include "../query.h"
 #include "../round_settings.h"
+#include "../sim_clock.h"
 #include <afterhours/ah.h>
 
 using namespace afterhours;
@@ -25,7 +27,7 @@ struct UpdateTagAndGoTimers : PausableSystem<HasTagAndGoTracking> {
 };
 
 struct HandleTagAndGoTagTransfer : System<Transform, HasTagAndGoTracking> {
-  virtual void for_each_with(Entity &, Transform &transform,
+  virtual void for_each_with(Entity &entity, Transform &,
                              HasTagAndGoTracking &taggerTracking,
                              float) override {
     if (!GameStateManager::get().is_game_active()) {
@@ -34,35 +36,28 @@ struct HandleTagAndGoTagTransfer : System<Transform, HasTagAndGoTracking> {
     if (!taggerTracking.is_tagger) {
       return;
     }
-    auto runners = EntityQuery()
-                       .whereHasComponent<Transform>()
-                       .whereHasComponent<HasTagAndGoTracking>()
-                       .whereLambda([](const Entity &e) {
-                         return !e.get<HasTagAndGoTracking>().is_tagger;
-                       })
-                       .gen();
     auto &tag_settings =
         RoundManager::get().get_active_rt<RoundTagAndGoSettings>();
-    float current_time = static_cast<float>(raylib::GetTime());
-    auto colliding_runner_it = std::ranges::find_if(
-        runners, [&](const afterhours::RefEntity &runner_ref) {
-          const Entity &runner = runner_ref.get();
-          const Transform &runnerTransform = runner.get<Transform>();
+    float current_time = SimulationClock::get().now();
+    Entity *colliding_runner = nullptr;
+    ContactStream::get().for_each_touching<HasTagAndGoTracking>(
+        entity, [&](Entity &runner) {
+          if (colliding_runner)
+            return;
           const HasTagAndGoTracking &runnerTracking =
               runner.get<HasTagAndGoTracking>();
+          if (runnerTracking.is_tagger)
+            return;
           float effective_cooldown = tag_settings.get_tag_cooldown();
-          if (!raylib::CheckCollisionRecs(transform.rect(),
-                                          runnerTransform.rect()))
-            return false;
           if (current_time - runnerTracking.last_tag_time < effective_cooldown)
-            return false;
-          return true;
+            return;
+          colliding_runner = &runner;
         });
-    if (colliding_runner_it == runners.end()) {
+    if (!colliding_runner) {
       return;
     }
-    Entity &runner = colliding_runner_it->get();
-    HasTagAndGoTracking &runnerTracking = runner.get<HasTagAndGoTracking>();
+    HasTagAndGoTracking &runnerTracking =
+        colliding_runner->get<HasTagAndGoTracking>();
     taggerTracking.is_tagger = false;
     runnerTracking.is_tagger = true;
     taggerTracking.last_tag_time = current_time;
@@ -7,4 +7,6 @@ enum struct GameTag : uint8_t {
   FloorOverlay = 1,
   SkipTextureRendering = 2,
   IsLastRoundsWinner = 3,
+  // map piece that can never move, drawn from StaticMapLayer
+  StaticMapLayer = 4,
 };
@@ -1336,19 +1336,17 @@ void ScheduleMainMenuUI::render_map_preview(
                  .with_opacity(fade_v)
                  .with_debug_name("map_title"));
 
-    if (MapManager::get().preview_textures_initialized) {
-      int abs_idx = animated_pair.first;
-      const auto &rt = MapManager::get().get_preview_texture(abs_idx);
-      imm::image(
-          context, mk(preview_box),
-          ComponentConfig{}
-              .with_size(ComponentSize{percent(1.f), percent(0.7f, 0.1f)})
-              .with_opacity(fade_v)
-              .with_debug_name("map_preview")
-              .with_texture(
-                  rt.texture,
-                  afterhours::texture_manager::HasTexture::Alignment::Center));
-    }
+    int abs_idx = animated_pair.first;
+    const auto &preview = MapManager::get().get_preview_texture(abs_idx);
+    imm::image(
+        context, mk(preview_box),
+        ComponentConfig{}
+            .with_size(ComponentSize{percent(1.f), percent(0.7f, 0.1f)})
+            .with_opacity(fade_v)
+            .with_debug_name("map_preview")
+            .with_texture(
+                preview,
+                afterhours::texture_manager::HasTexture::Alignment::Center));
 
     return;
   }
@@ -1380,23 +1378,19 @@ void ScheduleMainMenuUI::render_map_preview(
                .with_opacity(fade_v)
                .with_debug_name("map_title"));
 
-  if (!MapManager::get().preview_textures_initialized) {
-    return;
-  }
-
   // fade_v computed above
 
   if (!overriding_preview && prev_preview_index >= 0 &&
       prev_preview_index != selected_map_index && fade_v < 1.0f) {
-    const auto &rt_prev =
+    const auto &prev_texture =
         MapManager::get().get_preview_texture(prev_preview_index);
     afterhours::texture_manager::Rectangle full_src_prev{
         .x = 0,
         .y = 0,
-        .width = (float)rt_prev.texture.width,
-        .height = (float)rt_prev.texture.height,
+        .width = (float)prev_texture.width,
+        .height = (float)prev_texture.height,
     };
-    imm::sprite(context, mk(preview_box), rt_prev.texture, full_src_prev,
+    imm::sprite(context, mk(preview_box), prev_texture, full_src_prev,
                 ComponentConfig{}
                     .with_size(ComponentSize{percent(1.f), percent(1.0f)})
                     .with_debug_name("map_preview_prev")
@@ -1404,14 +1398,14 @@ void ScheduleMainMenuUI::render_map_preview(
                     .with_render_layer(0));
   }
 
-  const auto &rt_cur =
+  const auto &cur_texture =
       MapManager::get().get_preview_texture(effective_preview_index);
-  imm::sprite(context, mk(preview_box), rt_cur.texture,
+  imm::sprite(context, mk(preview_box), cur_texture,
               afterhours::texture_manager::Rectangle{
                   .x = 0,
                   .y = 0,
-                  .width = (float)rt_cur.texture.width,
-                  .height = (float)rt_cur.texture.height,
+                  .width = (float)cur_texture.width,
+                  .height = (float)cur_texture.height,
               },
               ComponentConfig{}
                   .with_size(ComponentSize{percent(1.f), percent(0.5f)})
@@ -1428,6 +1422,11 @@ void ScheduleMainMenuUI::for_each_with(Entity &entity,
   // Apply any queued screen changes at the start of the frame
   GameStateManager::get().update_screen();
 
+  // previews are drawn on demand; drop them once nobody is looking
+  if (get_active_screen() != Screen::MapSelection) {
+    MapManager::get().release_previews();
+  }
+
   switch (get_active_screen()) {
   case Screen::None:
     break;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "spatial_index.h"
+#include <afterhours/src/singleton.h>
+#include <unordered_set>
+
+// Entities the camera can see this frame. Collected once at the end of the
+// per-frame update pass, while the SpatialIndex is still valid, so the world
+// render systems can skip anything off screen without each of them working
+// out the view again.
+//
+// Entities created after the set was collected (later in the same update
+// pass) were never indexed. Ids only go up, so anything newer than the last
+// indexed id counts as visible until the next frame rather than popping in
+// one frame late.
+SINGLETON_FWD(VisibleSet)
+struct VisibleSet {
+  SINGLETON(VisibleSet)
+
+  // Health bars and labels are drawn above the kart, and the index rects are
+  // from the start of the update pass (before WrapAroundTransform and
+  // friends moved things); pad the view so neither gets cut off at the edge.
+  static constexpr float MARGIN = 64.f;
+
+  // false until the first collect (and whenever the index was not valid),
+  // in which case everything is treated as visible
+  bool built = false;
+  raylib::Rectangle view{};
+  std::unordered_set<afterhours::EntityID> ids;
+  afterhours::EntityID newest_indexed = -1;
+
+  // for the profiler overlay
+  size_t drawn = 0;
+  size_t culled = 0;
+
+  void collect(const raylib::Rectangle &camera_view) {
+    view = raylib::Rectangle{camera_view.x - MARGIN, camera_view.y - MARGIN,
+                             camera_view.width + (2.f * MARGIN),
+                             camera_view.height + (2.f * MARGIN)};
+    ids.clear();
+
+    auto &index = SpatialIndex::get();
+    built = index.valid;
+    if (!built) {
+      drawn = 0;
+      culled = 0;
+      return;
+    }
+
+    newest_indexed = -1;
+    for (const SpatialIndex::Entry &e : index.entries) {
+      newest_indexed = std::max(newest_indexed, e.entity->id);
+    }
+    index.for_each_overlapping(
+        view, [&](afterhours::Entity &entity) { ids.insert(entity.id); });
+
+    drawn = ids.size();
+    culled = index.entries.size() - drawn;
+  }
+
+  [[nodiscard]] bool contains(const afterhours::Entity &entity) const {
+    return !built || entity.id > newest_indexed || ids.contains(entity.id);
+  }
+
+  // For things that are not entities (pooled projectiles)
+  [[nodiscard]] bool overlaps(const raylib::Rectangle &rect) const {
+    return !built || SpatialIndex::overlaps(view, rect);
+  }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "rl.h"
+#include <cmath>
+
+// A render texture over the part of the world the camera shows, one texel
+// per world unit. Things that rarely change get painted into one of these
+// and then cost a single textured quad per frame.
+struct WorldLayer {
+  raylib::RenderTexture2D target{};
+  // world rect the texture covers
+  raylib::Rectangle area{};
+
+  [[nodiscard]] bool ready() const { return target.id != 0; }
+
+  // (Re)creates the texture if `view` moved or changed size. Returns true
+  // when it did; the new texture is blank and whatever was painted into the
+  // old one is gone. Call outside of any other texture mode.
+  bool fit(const raylib::Rectangle &view) {
+    const int w = static_cast<int>(std::ceil(view.width));
+    const int h = static_cast<int>(std::ceil(view.height));
+    if (w <= 0 || h <= 0)
+      return false;
+    if (ready() && target.texture.width == w && target.texture.height == h &&
+        view.x == area.x && view.y == area.y)
+      return false;
+
+    if (ready()) {
+      raylib::UnloadRenderTexture(target);
+    }
+    target = raylib::LoadRenderTexture(w, h);
+    area = view;
+    clear();
+    return true;
+  }
+
+  void clear() const {
+    raylib::BeginTextureMode(target);
+    raylib::ClearBackground(raylib::BLANK);
+    raylib::EndTextureMode();
+  }
+
+  [[nodiscard]] vec2 to_texture(vec2 world) const {
+    return vec2{world.x - area.x, world.y - area.y};
+  }
+
+  // Call inside the world camera
+  void draw() const {
+    if (!ready())
+      return;
+    const auto &texture = target.texture;
+    // render textures are stored upside down
+    raylib::DrawTexturePro(
+        texture,
+        raylib::Rectangle{0.f, 0.f, (float)texture.width,
+                          -(float)texture.height},
+        raylib::Rectangle{area.x, area.y, (float)texture.width,
+                          (float)texture.height},
+        vec2{0.f, 0.f}, 0.f, raylib::WHITE);
+  }
+};
@@ -0,0 +1,503 @@
+// Headless AI-vs-AI tournament that tunes the AIParams difficulty tables
+// (AIUpdateAIParamsSystem).
+//
+// Every match is a real one: the systems register_simulation_systems() adds
+// for --headless, on the game's maps, started and torn down the way
+// run_headless() does it. For each mode and difficulty it seats one kart on
+// that difficulty's table against a field of Medium karts, then hill-climbs
+// the parameters that matter in the mode toward the win rate the difficulty
+// is meant to have (below an even share for Easy, well above for Expert).
+// The tuned values go to JSON, next to the win rates before and after.
+//
+// EntityHelper and the game singletons are process-wide, so one match needs
+// one process. The matches are handed out to --workers forked copies of
+// this tool, each with its own world, which amounts to a world per core.
+// Forking happens before anything starts a thread (JobPool::worker_limit is
+// 0, every core already has a match). Without fork (Windows) everything
+// runs in this process. Matches are seeded, so a run repeats for the same
+// --seed and --workers.
+
+#include "../src/game.h"
+#include "../src/headless.h"
+#include "../src/job_pool.h"
+#include "../src/makers.h"
+#include "../src/map_system.h"
+#include "../src/preload.h"
+#include "../src/replay.h"
+#include "../src/settings.h"
+#include "../src/systems/systems.h"
+#include "../src/systems/systems_ai.h"
+#include "argh.h"
+#include <afterhours/src/plugins/files.h>
+#include <afterhours/src/plugins/settings.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <magic_enum/magic_enum.hpp>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <random>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// game.h's globals belong to main.cpp, which this tool doesn't link
+bool running = true;
+raylib::RenderTexture2D mainRT;
+raylib::RenderTexture2D screenRT;
+
+namespace {
+
+using namespace afterhours;
+using Difficulty = AIDifficulty::Difficulty;
+using Clock = std::chrono::high_resolution_clock;
+
+// Lives has no timer, the other modes end on theirs well before this; no
+// winner by then is a draw (run_headless gives up at 300s)
+constexpr float MATCH_TIMEOUT_SECONDS = 180.f;
+
+// Win rate each difficulty is meant to reach against a Medium field, as a
+// multiple of an even share (1 / karts); indexed by Difficulty
+constexpr std::array<float, 4> TARGET_SHARE = {0.5f, 1.0f, 1.5f, 2.0f};
+
+float elapsed_seconds(Clock::time_point start) {
+  return std::chrono::duration<float>(Clock::now() - start).count();
+}
+
+struct Seat {
+  Difficulty difficulty = Difficulty::Medium;
+  // replaces the difficulty's table when set
+  std::optional<AIParams> params;
+};
+
+struct MatchSpec {
+  RoundType mode = RoundType::Lives;
+  int map = 0;
+  uint64_t seed = 0;
+  std::vector<Seat> seats;
+};
+
+struct MatchResult {
+  // seat index, -1 for a draw
+  int32_t winner = -1;
+  int32_t ticks = 0;
+};
+
+// The systems of one headless run; a process has one world, so it has one
+// of these
+struct Headless {
+  SystemManager fixed_systems;
+  SystemManager systems;
+
+  Headless() { register_headless_systems(fixed_systems, systems, false); }
+
+  MatchResult play(const MatchSpec &spec) {
+    const float dt = SimulationClock::get().fixed_dt;
+    // make_car places karts before create_map seeds the match
+    seed_sim_rng(spec.seed);
+    RoundManager::get().active_round_type = spec.mode;
+    for (size_t i = 0; i < spec.seats.size(); i++) {
+      make_ai();
+    }
+    // karts come back in creation order, which is seat order
+    const auto karts = [] {
+      return EntityQuery({.force_merge = true})
+          .whereHasComponent<AIControlled>()
+          .gen();
+    };
+    std::vector<EntityID> seats;
+    for (Entity &kart : karts()) {
+      kart.get<AIDifficulty>().difficulty =
+          spec.seats[seats.size()].difficulty;
+      seats.push_back(kart.id);
+    }
+
+    apply_ai_tables(fixed_systems, dt);
+    const auto seated = karts();
+    for (size_t i = 0; i < seated.size(); i++) {
+      if (spec.seats[i].params)
+        seated[i].get().get<AIParams>() = *spec.seats[i].params;
+    }
+
+    replay::set_next_seed(spec.seed);
+    start_headless_round(spec.map);
+    MatchResult result;
+    while (GameStateManager::get().is_game_active() &&
+           (float)result.ticks * dt < MATCH_TIMEOUT_SECONDS) {
+      fixed_systems.run(dt);
+      systems.run(dt);
+      result.ticks++;
+    }
+
+    // more than one (a team, a shared lead) is a draw too
+    const auto winners = EntityQuery({.force_merge = true})
+                             .whereHasTag(GameTag::IsLastRoundsWinner)
+                             .gen();
+    if (!GameStateManager::get().is_game_active() && winners.size() == 1) {
+      const auto it = std::ranges::find(seats, winners[0].get().id);
+      if (it != seats.end())
+        result.winner = static_cast<int32_t>(it - seats.begin());
+    }
+    end_headless_match();
+    return result;
+  }
+};
+
+#ifndef _WIN32
+bool write_all(int fd, const void *data, size_t size) {
+  const auto *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    const ssize_t n = write(fd, bytes, size);
+    if (n <= 0)
+      return false;
+    bytes += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool read_all(int fd, void *data, size_t size) {
+  auto *bytes = static_cast<char *>(data);
+  while (size > 0) {
+    const ssize_t n = read(fd, bytes, size);
+    if (n <= 0)
+      return false;
+    bytes += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+#endif
+
+// Plays every match in `specs`, over `workers` processes when there is more
+// than one. Worker w plays matches w, w + workers, ... and sends the results
+// back over a pipe in that order.
+std::vector<MatchResult> play_all(const std::vector<MatchSpec> &specs,
+                                  int workers) {
+  std::vector<MatchResult> results(specs.size());
+#ifndef _WIN32
+  if (workers > 1) {
+    struct Child {
+      pid_t pid;
+      int fd;
+    };
+    std::vector<Child> children;
+    for (int w = 0; w < workers; w++) {
+      int fds[2];
+      if (pipe(fds) != 0) {
+        log_error("tournament: could not create a pipe for worker {}", w);
+        break;
+      }
+      const pid_t pid = fork();
+      if (pid < 0) {
+        log_error("tournament: could not start worker {}", w);
+        close(fds[0]);
+        close(fds[1]);
+        break;
+      }
+      if (pid == 0) {
+        close(fds[0]);
+        Headless headless;
+        for (size_t i = static_cast<size_t>(w); i < specs.size();
+             i += static_cast<size_t>(workers)) {
+          const MatchResult result = headless.play(specs[i]);
+          if (!write_all(fds[1], &result, sizeof(result)))
+            _exit(1);
+        }
+        close(fds[1]);
+        _exit(0);
+      }
+      close(fds[1]);
+      children.push_back(Child{pid, fds[0]});
+    }
+
+    for (size_t w = 0; w < children.size(); w++) {
+      for (size_t i = w; i < specs.size();
+           i += static_cast<size_t>(workers)) {
+        if (!read_all(children[w].fd, &results[i], sizeof(MatchResult))) {
+          log_error("tournament: worker {} stopped early", w);
+          break;
+        }
+      }
+      close(children[w].fd);
+      waitpid(children[w].pid, nullptr, 0);
+    }
+    // whatever a worker that never started would have played, in here
+    for (size_t w = children.size(); w < static_cast<size_t>(workers); w++) {
+      static Headless headless;
+      for (size_t i = w; i < specs.size();
+           i += static_cast<size_t>(workers)) {
+        results[i] = headless.play(specs[i]);
+      }
+    }
+    return results;
+  }
+#endif
+  static Headless headless;
+  for (size_t i = 0; i < specs.size(); i++) {
+    results[i] = headless.play(specs[i]);
+  }
+  return results;
+}
+
+AIParams table(RoundType mode, Difficulty difficulty) {
+  AIParams params;
+  AIUpdateAIParamsSystem::apply(params, mode, difficulty);
+  return params;
+}
+
+// `matches` matches of `tested` against a Medium field, with its seat and
+// the map rotating. Match i gets the same seed for every candidate, so they
+// all see the same spawns and differ only by their tables.
+void add_matches(std::vector<MatchSpec> &specs, RoundType mode,
+                 const AIParams &tested, Difficulty difficulty, int karts,
+                 int matches, uint64_t seed) {
+  const auto maps = MapManager::get().get_maps_for_round_type(mode);
+  for (int i = 0; i < matches; i++) {
+    MatchSpec &spec = specs.emplace_back();
+    spec.mode = mode;
+    spec.map = maps[static_cast<size_t>(i) % maps.size()].first;
+    spec.seed = seed + static_cast<uint64_t>(i);
+    spec.seats.resize(static_cast<size_t>(karts));
+    spec.seats[static_cast<size_t>(i % karts)] = Seat{difficulty, tested};
+  }
+}
+
+// Win rates of each block of `matches` results, for the kart in the rotating
+// seat add_matches put it in
+std::vector<float> win_rates(const std::vector<MatchResult> &results,
+                             int karts, int matches) {
+  std::vector<float> rates;
+  for (size_t start = 0; start < results.size();
+       start += static_cast<size_t>(matches)) {
+    int wins = 0;
+    for (int i = 0; i < matches; i++) {
+      if (results[start + static_cast<size_t>(i)].winner == i % karts)
+        wins++;
+    }
+    rates.push_back(static_cast<float>(wins) / static_cast<float>(matches));
+  }
+  return rates;
+}
+
+struct Tunable {
+  const char *name;
+  float AIParams::*field;
+  float lo;
+  float hi;
+};
+
+// The parameters that matter in each mode; decision rate matters in all of
+// them
+std::vector<Tunable> tunables_for(RoundType mode) {
+  std::vector<Tunable> tunables = {
+      {"decision_hz", &AIParams::decision_hz, 5.f, 60.f},
+      {"boost_cooldown_seconds", &AIParams::boost_cooldown_seconds, 1.f, 5.f},
+      {"boost_ahead_alignment_deg", &AIParams::boost_ahead_alignment_deg,
+       0.1f, 30.f},
+  };
+  switch (mode) {
+  case RoundType::Lives:
+  case RoundType::Kills:
+    tunables.push_back({"shooting_alignment_angle_deg",
+                        &AIParams::shooting_alignment_angle_deg, 2.f, 30.f});
+    break;
+  case RoundType::Hippo:
+    tunables.push_back(
+        {"hippo_target_jitter", &AIParams::hippo_target_jitter, 0.f, 300.f});
+    break;
+  case RoundType::TagAndGo:
+    tunables.push_back({"runner_evade_lookahead_distance",
+                        &AIParams::runner_evade_lookahead_distance, 25.f,
+                        300.f});
+    break;
+  }
+  return tunables;
+}
+
+AIParams mutate(const AIParams &from, const std::vector<Tunable> &tunables,
+                std::mt19937 &rng) {
+  AIParams params = from;
+  std::bernoulli_distribution pick(0.5);
+  std::normal_distribution<float> step(0.f, 0.15f);
+  std::uniform_int_distribution<size_t> any(0, tunables.size() - 1);
+  const size_t always = any(rng);
+  for (size_t i = 0; i < tunables.size(); i++) {
+    if (i != always && !pick(rng))
+      continue;
+    const Tunable &t = tunables[i];
+    params.*t.field = std::clamp(
+        params.*t.field + (step(rng) * (t.hi - t.lo)), t.lo, t.hi);
+  }
+  return params;
+}
+
+struct Options {
+  int matches = 64;
+  int generations = 6;
+  int population = 6;
+  int karts = 4;
+  // empty for every mode
+  std::optional<RoundType> mode;
+  int workers = 0;
+  uint32_t seed = 1;
+  std::string out = "ai_params_tuned.json";
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  argh::parser cmdl(argc, argv, argh::parser::PREFER_PARAM_FOR_UNREG_OPTION);
+  if (cmdl[{"-h", "--help"}]) {
+    std::cout
+        << "Usage: " << argv[0] << " [options]\n"
+        << "Options:\n"
+        << "  --matches N      Matches per parameter set (default: 64)\n"
+        << "  --generations N  Hill-climbing rounds, 0 to only measure the\n"
+        << "                   current tables (default: 6)\n"
+        << "  --population N   Candidates per round (default: 6)\n"
+        << "  --karts N        AI karts per match (default: 4)\n"
+        << "  --mode NAME      Only tune one mode (Lives, Kills, Hippo,\n"
+        << "                   TagAndGo)\n"
+        << "  --workers N      Worker processes (default: all cores)\n"
+        << "  --seed N         Seed for matches and mutations (default: 1)\n"
+        << "  --out FILE       Where to write the tuned tables\n"
+        << "                   (default: ai_params_tuned.json)\n";
+    return 0;
+  }
+  Options options;
+  cmdl("--matches", options.matches) >> options.matches;
+  cmdl("--generations", options.generations) >> options.generations;
+  cmdl("--population", options.population) >> options.population;
+  cmdl("--karts", options.karts) >> options.karts;
+  cmdl("--workers", options.workers) >> options.workers;
+  cmdl("--seed", options.seed) >> options.seed;
+  cmdl("--out", options.out) >> options.out;
+  if (std::string name; cmdl("--mode") >> name) {
+    options.mode = magic_enum::enum_cast<RoundType>(name);
+    if (!options.mode) {
+      log_error("Unknown mode {}", name);
+      return 1;
+    }
+  }
+#ifdef _WIN32
+  options.workers = 1;
+#endif
+  if (options.workers <= 0) {
+    options.workers =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  if (options.workers > 1) {
+    JobPool::worker_limit = 0;
+  }
+  options.karts = std::max(options.karts, 2);
+  options.matches = std::max(options.matches, options.karts);
+
+  // the same start as --headless
+  ::afterhours::files::init("Cart Chaos", "resources");
+  afterhours::settings::init<SettingsData>("Cart Chaos", "settings.json");
+  Settings::load_save_file(1280, 720);
+  Preload::get().init_headless().make_singleton();
+
+  std::mt19937 rng(options.seed);
+  size_t total_matches = 0;
+  float play_seconds = 0.f;
+  const auto run = [&](const std::vector<MatchSpec> &specs) {
+    const auto start = Clock::now();
+    std::vector<MatchResult> results = play_all(specs, options.workers);
+    play_seconds += elapsed_seconds(start);
+    total_matches += specs.size();
+    return win_rates(results, options.karts, options.matches);
+  };
+
+  nlohmann::json tables;
+  std::cout << fmt::format("{:<9} {:<7} {:>7} {:>7} {:>7}\n", "mode",
+                           "level", "target", "before", "after");
+  for (const RoundType mode : magic_enum::enum_values<RoundType>()) {
+    if (options.mode && mode != *options.mode)
+      continue;
+    const std::vector<Tunable> tunables = tunables_for(mode);
+    for (const Difficulty difficulty : magic_enum::enum_values<Difficulty>()) {
+      const float target = TARGET_SHARE[static_cast<size_t>(difficulty)] /
+                           static_cast<float>(options.karts);
+      const auto error = [target](float rate) {
+        return std::abs(rate - target);
+      };
+
+      AIParams best = table(mode, difficulty);
+      std::vector<MatchSpec> specs;
+      add_matches(specs, mode, best, difficulty, options.karts,
+                  options.matches, options.seed);
+      const float before = run(specs).front();
+      float best_rate = before;
+
+      for (int gen = 0; gen < options.generations; gen++) {
+        std::vector<AIParams> candidates;
+        specs.clear();
+        for (int c = 0; c < options.population; c++) {
+          candidates.push_back(mutate(best, tunables, rng));
+          add_matches(specs, mode, candidates.back(), difficulty,
+                      options.karts, options.matches, options.seed);
+        }
+        const std::vector<float> rates = run(specs);
+        for (size_t c = 0; c < candidates.size(); c++) {
+          if (error(rates[c]) < error(best_rate)) {
+            best = candidates[c];
+            best_rate = rates[c];
+          }
+        }
+      }
+
+      nlohmann::json params;
+      for (const Tunable &t : tunables) {
+        params[t.name] = best.*t.field;
+      }
+      tables[std::string(magic_enum::enum_name(mode))]
+            [std::string(magic_enum::enum_name(difficulty))] = {
+                {"target_win_rate", target},
+                {"win_rate_before", before},
+                {"win_rate_after", best_rate},
+                {"params", params},
+            };
+      std::cout << fmt::format("{:<9} {:<7} {:>6.0f}% {:>6.0f}% {:>6.0f}%\n",
+                               magic_enum::enum_name(mode),
+                               magic_enum::enum_name(difficulty),
+                               target * 100.f, before * 100.f,
+                               best_rate * 100.f);
+    }
+  }
+
+  const float per_second =
+      play_seconds > 0.f ? static_cast<float>(total_matches) / play_seconds
+                         : 0.f;
+  const float per_core = per_second / static_cast<float>(options.workers);
+  std::cout << fmt::format("{} matches on {} worker(s) in {:.1f}s: {:.1f} "
+                           "matches/s, {:.1f} matches/s per core\n",
+                           total_matches, options.workers, play_seconds,
+                           per_second, per_core);
+
+  const nlohmann::json out = {
+      {"karts_per_match", options.karts},
+      {"matches_per_candidate", options.matches},
+      {"generations", options.generations},
+      {"population", options.population},
+      {"seed", options.seed},
+      {"workers", options.workers},
+      {"matches", total_matches},
+      {"matches_per_second", per_second},
+      {"matches_per_second_per_core", per_core},
+      {"tables", tables},
+  };
+  std::ofstream file(options.out);
+  if (!file) {
+    log_error("Could not write {}", options.out);
+    return 1;
+  }
+  file << out.dump(2) << "\n";
+  std::cout << "wrote " << options.out << "\n";
+  return 0;
+}
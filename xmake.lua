@@ -63,6 +63,12 @@ option("mcp")
     set_description("Enable MCP server for AI automation")
 option_end()
 
+option("profiler")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Enable the per-system frame profiler (F3 overlay)")
+option_end()
+
 target("kart")
     --
     set_kind("binary")
@@ -79,6 +85,10 @@ target("kart")
         add_defines("AFTER_HOURS_ENABLE_MCP")
     end
 
+    if has_config("profiler") then
+        add_defines("AFTER_HOURS_ENABLE_PROFILER")
+    end
+
     add_ldflags("-L.", "-Lvendor/")
     if is_host("windows") then
         add_ldflags("F:/RayLib/lib/raylib.dll")
@@ -92,3 +102,25 @@ target("kart")
     after_build(function(target)
         os.exec("./output/kart.exe")
     end)
+
+-- Headless AI self-play tuning the AIParams tables (tools/tournament.cpp)
+target("tournament")
+    set_kind("binary")
+    set_targetdir("output")
+    set_default(false)
+    --
+    add_files("tools/tournament.cpp")
+    add_files("src/*.cpp|main.cpp")
+    add_files("src/ui/*.cpp")
+    add_files("vendor/afterhours/src/plugins/files.cpp")
+    add_files("vendor/afterhours/src/plugins/settings.cpp")
+    --
+    add_includedirs("vendor")
+    add_syslinks("pthread")
+
+    add_ldflags("-L.", "-Lvendor/")
+    if is_host("windows") then
+        add_ldflags("F:/RayLib/lib/raylib.dll")
+    else
+        add_ldflags("$(shell pkg-config --libs raylib)")
+    end